@@ -72,6 +72,7 @@ classdef Cost < Map
     % - applyGrad(this,x)
     % - applyProx(this,z,alpha)
     % - applyProxFench(this,z,alpha)
+    % - applyAndGrad(this,x)
     methods (Sealed)
         function g =applyGrad(this,x)
             % Computes the gradient of the cost function at  \\(\\mathrm{x} \\in \\mathrm{X}\\) (when applicable)
@@ -82,12 +83,20 @@ classdef Cost < Map
                 error('Input to applyGrad was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(x)), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyGrad
-                g = this.memoize('applyGrad', @this.applyGrad_, x);
-            else
-                g =this.applyGrad_(x);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyGrad',x); end
+            try
+                % memoize
+                if this.memoizeOpts.applyGrad
+                    g = this.memoize('applyGrad', @this.applyGrad_, x);
+                else
+                    g =this.applyGrad_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,g); end
             if ~checkSize(g, this.sizein) % check output size
                 error('Output of applyGrad was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(g)), num2str(this.sizein));
@@ -103,12 +112,20 @@ classdef Cost < Map
                 error('Input to applyProx was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(z)), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyProx
-                x = this.memoize('applyProx', @this.applyProx_,{z,alpha});
-            else
-                x =this.applyProx_(z,alpha);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyProx',{z,alpha}); end
+            try
+                % memoize
+                if this.memoizeOpts.applyProx
+                    x = this.memoize('applyProx', @this.applyProx_,{z,alpha});
+                else
+                    x =this.applyProx_(z,alpha);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             if ~checkSize(x, this.sizein) % check output size
                 error('Output of applyProx was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(x)), num2str(this.sizein));
@@ -123,23 +140,61 @@ classdef Cost < Map
                 error('Input to applyProxFench was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(z)), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyProxFench
-                y = this.memoize('applyProxFench', @this.applyProxFench_,{z,alpha});
-            else
-                y =this.applyProxFench_(z,alpha);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyProxFench',{z,alpha}); end
+            try
+                % memoize
+                if this.memoizeOpts.applyProxFench
+                    y = this.memoize('applyProxFench', @this.applyProxFench_,{z,alpha});
+                else
+                    y =this.applyProxFench_(z,alpha);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,y); end
             if ~checkSize(y, this.sizein) % check output size
                 error('Output of applyProxFench was size [%s], didn''t match stated sizein [%s].',...
                     num2str(size(y)), num2str(this.sizein));
             end
         end
+        function [f,g]=applyAndGrad(this,x)
+            % Computes both the value and the gradient of the cost function at \\(\\mathrm{x} \\in \\mathrm{X}\\)
+            % (when applicable), which is what quasi-Newton and line-search algorithms need at each evaluation.
+            %
+            % Calls the method :meth:`applyAndGrad_` (or :meth:`apply` and :meth:`applyGrad` when one of
+            % them is memoized, such that the memoize cache is used and kept up to date)
+            if ~checkSize(x, this.sizein) % check input size
+                error('Input to applyAndGrad was size [%s], didn''t match stated sizein [%s].',...
+                    num2str(size(x)), num2str(this.sizein));
+            end
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyAndGrad',x); end
+            try
+                if this.memoizeOpts.apply || this.memoizeOpts.applyGrad
+                    f=this.apply(x);
+                    g=this.applyGrad(x);
+                else
+                    [f,g]=this.applyAndGrad_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
+            end
+            if isProfiling, mapProfiler('exit',prof,g); end
+            if ~checkSize(g, this.sizein) % check output size
+                error('Output of applyAndGrad was size [%s], didn''t match stated sizein [%s].',...
+                    num2str(size(g)), num2str(this.sizein));
+            end
+        end
     end
     
     %% Core Methods containing implementations (Protected)
     % - applyGrad_(this,x)
     % - applyProx_(this,z,alpha)
     % - applyProxFench_(this,z,alpha)
+    % - applyAndGrad_(this,x)
     % - plus_(this,G)
     % - minus_(this,G)
     % - makeComposition_(this,G)
@@ -174,6 +229,12 @@ classdef Cost < Map
                 error('applyProx_ and applyProxFench_  methods not implemented');
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % By default, calls successively :meth:`apply_` and :meth:`applyGrad_`. To be reimplemented
+            % in derived classes which can share computations between the value and the gradient.
+            f=this.apply_(x);
+            g=this.applyGrad_(x);
+        end
         function M = plus_(this,G)
             % If \\(\\mathrm{G}\\) is a :class:`Cost`, constructs a :class:`CostSummation` object to sum the
             % current :class:`Cost` \\(C\\) with the given \\(G\\).
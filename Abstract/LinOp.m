@@ -63,12 +63,20 @@ classdef LinOp < Map
                 error('Input to applyAdjoint was size [%s], didn''t match stated sizeout: [%s].',...
                     num2str(size(y)), num2str(this.sizeout));
             end
-            % memoize
-            if this.memoizeOpts.applyAdjoint
-                x = this.memoize('applyAdjoint', @this.applyAdjoint_, y);
-            else
-                x= this.applyAdjoint_(y);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyAdjoint',y); end
+            try
+                % memoize
+                if this.memoizeOpts.applyAdjoint
+                    x = this.memoize('applyAdjoint', @this.applyAdjoint_, y);
+                else
+                    x= this.applyAdjoint_(y);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             % check output size
             if ~checkSize(x, this.sizein)
                 warning('Output of applyAdjoint was size [%s], didn''t match stated sizein: [%s].',...
@@ -83,12 +91,20 @@ classdef LinOp < Map
                 error('Input to applyHtH was size [%s], didn''t match stated sizein: [%s].',...
                     num2str(size(x)), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyHtH
-                y = this.memoize('applyHtH', @this.applyHtH_, x);
-            else
-                y= this.applyHtH_(x);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyHtH',x); end
+            try
+                % memoize
+                if this.memoizeOpts.applyHtH
+                    y = this.memoize('applyHtH', @this.applyHtH_, x);
+                else
+                    y= this.applyHtH_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,y); end
             % check output size
             if ~checkSize(y, this.sizein)
                 warning('Output of applyHtH was size [%s], didn''t match stated sizein: [%s].',...
@@ -103,12 +119,20 @@ classdef LinOp < Map
                 error('Input to applyHHt was size [%s], didn''t match stated sizeout: [%s].',...
                     num2str(size(y)), num2str(this.sizeout));
             end
-            % memoize
-            if this.memoizeOpts.applyHHt
-                x = this.memoize('applyHHt', @this.applyHHt_, y);
-            else
-                x =this.applyHHt_( y);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyHHt',y); end
+            try
+                % memoize
+                if this.memoizeOpts.applyHHt
+                    x = this.memoize('applyHHt', @this.applyHHt_, y);
+                else
+                    x =this.applyHHt_( y);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             % check output size
             if ~checkSize(x, this.sizeout)
                 warning('Output of applyHHt was size [%s], didn''t match stated sizeout: [%s].',...
@@ -140,12 +164,20 @@ classdef LinOp < Map
                 error('Input to applyAdjointInverse was size [%s], didn''t match stated sizein: [%s].',...
                     num2str(size(x)), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyAdjointInverse
-                y = this.memoize('applyAdjointInverse', @this.applyAdjointInverse_, x);
-            else
-                y =this.applyAdjointInverse_(x);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyAdjointInverse',x); end
+            try
+                % memoize
+                if this.memoizeOpts.applyAdjointInverse
+                    y = this.memoize('applyAdjointInverse', @this.applyAdjointInverse_, x);
+                else
+                    y =this.applyAdjointInverse_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,y); end
             % check output size
             if ~checkSize(y, this.sizeout)
                 warning('Output of applyAdjointInverse was size [%s], didn''t match stated sizeout: [%s].',...
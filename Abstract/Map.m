@@ -8,16 +8,30 @@ classdef (Abstract) Map < matlab.mixin.Copyable
     % :param name: name of the linear operator \\(\\mathbf{H}\\)
     % :param sizein:  dimension of the left hand side vector space \\(\\mathrm{X}\\)
     % :param sizeout:  dimension of the right hand side vector space \\(\\mathrm{Y}\\)
-    % :param norm: norm of the operator \\(\\|\\mathrm{H}\\|\\) (if known, otherwise -1)
+    % :param norm: norm of the operator \\(\\|\\mathrm{H}\\|\\) (if known, otherwise -1, see :meth:`getNorm`)
     % :param isInvertible:  true if the method :meth:`applyInverse_` is implemented
     % :param isDifferentiable:  true if the method :meth:`applyJacobianT_` is implemented
+    % :param isElementWise:  true if the Map acts element-wise and the method :meth:`applyElementWise_` is implemented
     % :param memoizeOpts: structure of boolean (one field per method, see details below).
     % :param doPrecomputation: boolean true to allow doing precomputations to save time (will generally require more memory).
+    % :param memoizeBudget: memory budget in bytes of the memoize cache of each method (default 0: only the last result is kept).
+    % :param memoizeCheck: 'hash' (default) or 'identity', see details below.
     %
     % **Note on the memoize option** This option allows to store the result
     % of a method such that if an identical call to this method is done,
     % calculations are avoided. Example: memoizeOpts.apply=true will store
-    % the result of H*x.
+    % the result of H*x. Several results per method are kept as long as
+    % they fit in memoizeBudget (least recently used ones are evicted first).
+    % A new input is first matched by buffer identity (same data buffer as
+    % a cached input, see dataPointer) which costs O(1). If memoizeCheck is
+    % 'hash', it is then compared to the cached inputs with a sampled
+    % content hash, confirmed by a full comparison only when the samples
+    % agree. Hits/misses statistics are given by :meth:`getMemoizeStats`.
+    %
+    % **Note on profiling** When the profiler is enabled (see
+    % :func:`mapProfiler`), the time, the number of calls, the sizes of
+    % the inputs and outputs and the memoize hits of the evaluation
+    % methods are recorded per class and per node of the composed Maps.
     
     %%    Copyright (C) 2017
     %     M. McCann michael.mccann@epfl.ch &
@@ -41,6 +55,7 @@ classdef (Abstract) Map < matlab.mixin.Copyable
         name = 'none'             % name of the linear operator
         isInvertible = false;     % true if H.applyInverse(  ) will work
         isDifferentiable = false; % true if H.applyJacobianT(   ) will work
+        isElementWise = false;    % true if H.applyElementWise(   ) will work
         sizein;                   % dimension of the right hand side vector space
         sizeout;                  % dimension of the left hand side vector space
         norm=-1;                  % norm of the operator
@@ -50,19 +65,29 @@ classdef (Abstract) Map < matlab.mixin.Copyable
             'applyJacobianT', false, ...
             'applyInverse', false);
         doPrecomputation = false;
+        memoizeBudget = 0;
+        memoizeCheck = 'hash';
     end
     %% Private properties
     properties (SetAccess = protected,GetAccess = protected)
+        normUpper = -1;           % cached upper bound of the norm (see getNormBound)
         memoCache = struct('apply', struct('in', [], 'out', []),...
             'applyJacobianT', struct('in', [], 'out', []), ...
             'applyInverse', struct('in', [], 'out', []));
         precomputeCache = struct();
     end
+    properties (Hidden, Transient)
+        profileId = 0;            % identifier of the Map in the profiler (see mapProfiler)
+    end
     
     %% Interface Methods (cannot be overloaded in derived classes: Sealed)
     % - apply(this,x)
     % - applyJacobianT(this, y, v)
     % - applyInverse(this,y)
+    % - applyElementWise(this,x)
+    % - getNorm(this,...)
+    % - getMemoizeStats(this)
+    % - clearMemoize(this)
     % - makeComposition(this, G)
     % - plus(this,G)
     % - minus(this,G)
@@ -81,12 +106,20 @@ classdef (Abstract) Map < matlab.mixin.Copyable
                 error('Input to apply was size [%s], didn''t match  %s sizein: [%s].',...
                     num2str(size(x)),class(this), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.apply
-                x = this.memoize('apply', @this.apply_, x);
-            else
-                x= this.apply_(x);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'apply',x); end
+            try
+                % memoize
+                if this.memoizeOpts.apply
+                    x = this.memoize('apply', @this.apply_, x);
+                else
+                    x= this.apply_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             % check output size
             if ~checkSize(x, this.sizeout)
                 warning('Output of apply was size [%s], didn''t match %s sizeout: [%s].',...
@@ -111,12 +144,20 @@ classdef (Abstract) Map < matlab.mixin.Copyable
                 error('Input to v applyJacobianT was size [%s], didn''t match %s sizein: [%s].',...
                     num2str(size(v)),class(this), num2str(this.sizein));
             end
-            % memoize
-            if this.memoizeOpts.applyJacobianT
-                x = this.memoize('applyJacobianT', @this.applyJacobianT_, {x, v});
-            else
-                x= this.applyJacobianT_(x,v);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyJacobianT',{x,v}); end
+            try
+                % memoize
+                if this.memoizeOpts.applyJacobianT
+                    x = this.memoize('applyJacobianT', @this.applyJacobianT_, {x, v});
+                else
+                    x= this.applyJacobianT_(x,v);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             % check output size
             if ~checkSize(x, this.sizein)
                 warning('Output of applyJacobianT was size [%s], didn''t match %s sizein: [%s].',...
@@ -132,18 +173,110 @@ classdef (Abstract) Map < matlab.mixin.Copyable
                 error('Input to applyInverse was size [%s], didn''t match %s sizeout: [%s].',...
                     num2str(size(x)),class(this), num2str(this.sizeout));
             end
-            % memoize
-            if this.memoizeOpts.applyInverse
-                x = this.memoize('applyInverse', @this.applyInverse_,x);
-            else
-                x= this.applyInverse_(x);
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyInverse',x); end
+            try
+                % memoize
+                if this.memoizeOpts.applyInverse
+                    x = this.memoize('applyInverse', @this.applyInverse_,x);
+                else
+                    x= this.applyInverse_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
             end
+            if isProfiling, mapProfiler('exit',prof,x); end
             % check output size
             if ~checkSize(x, this.sizein)
                 warning('Output of applyInverse was size [%s], didn''t match %s sizein: [%s].',...
                     num2str(size(x)),class(this), num2str(this.sizein));
             end
         end
+        function [x,d] = applyElementWise(this, x)
+            % For an element-wise Map, computes \\(\\mathrm{y}=\\mathrm{H}(\\mathrm{x})\\)
+            % and, if requested, the array \\(\\mathrm{d}\\) such that
+            % \\([\\mathrm{J}_{\\mathrm{H}}(\\mathrm{x})]^{\\star}\\mathrm{w} = \\mathrm{d} \\times \\mathrm{w}\\)
+            % (element-wise product) in the same pass.
+            %
+            % Calls the method :meth:`applyElementWise_`
+            if ~this.isElementWise
+                error('%s is not an element-wise Map.',class(this));
+            end
+            if ~checkSize(x, this.sizein) % check input size
+                error('Input to applyElementWise was size [%s], didn''t match  %s sizein: [%s].',...
+                    num2str(size(x)),class(this), num2str(this.sizein));
+            end
+            global isProfiling
+            if isProfiling, prof=mapProfiler('enter',this,'applyElementWise',x); end
+            try
+                if nargout>1
+                    [x,d]=this.applyElementWise_(x);
+                else
+                    x=this.applyElementWise_(x);
+                end
+            catch err
+                if isProfiling, mapProfiler('abort',prof); end
+                rethrow(err);
+            end
+            if isProfiling, mapProfiler('exit',prof,x); end
+        end
+        function nrm = getNorm(this,varargin)
+            % Returns the norm of the Map. When it is unknown (norm=-1),
+            % returns the upper bound computed from the parts of the Map
+            % (see :meth:`getNormBound`) if any, and otherwise the norm
+            % estimated with :func:`estimateNorm` (the optional arguments
+            % are given to it). The estimate being a lower bound, it is
+            % increased by 1% (above the accuracy of the default stopping
+            % criterion) before being cached in :attr:`norm`, such that it
+            % can be used in the step conditions of the algorithms. It is
+            % computed once per Map and reused by the Maps built from it.
+            
+            nrm=this.getNormBound();
+            if nrm==-1
+                assert(isa(this,'LinOp'),'The norm of a nonlinear Map cannot be estimated');
+                this.norm=1.01*estimateNorm(this,varargin{:});
+                nrm=this.norm;
+            end
+        end
+        function nrm = getNormBound(this)
+            % Returns the norm of the Map if known, otherwise an upper
+            % bound computed from the parts of the Map (see
+            % :meth:`normBound_`), -1 if none. The bound is cached apart
+            % from :attr:`norm`.
+            
+            if this.norm~=-1
+                nrm=this.norm;
+            else
+                if this.normUpper==-1
+                    this.normUpper=this.normBound_();
+                end
+                nrm=this.normUpper;
+            end
+        end
+        function st = getMemoizeStats(this)
+            % Returns a structure with one field per memoized method
+            % containing the number of hits and misses of the memoize
+            % cache, the number of stored entries and their size in bytes.
+            st = struct();
+            fn = fieldnames(this.memoCache);
+            for n=1:length(fn)
+                c = this.memoCache.(fn{n});
+                if isfield(c,'key')
+                    st.(fn{n}) = struct('hits',c.hits,'misses',c.misses,'entries',length(c.in),'bytes',sum(c.bytes));
+                else
+                    st.(fn{n}) = struct('hits',0,'misses',0,'entries',0,'bytes',0);
+                end
+            end
+        end
+        function clearMemoize(this)
+            % Empties the memoize cache of all the methods (statistics
+            % are reset).
+            fn = fieldnames(this.memoCache);
+            for n=1:length(fn)
+                this.memoCache.(fn{n}) = struct('in', [], 'out', []);
+            end
+        end
         function M = makeComposition(this, G)
             % Compose the Map \\(\\mathrm{H}\\) with the given Map
             % \\(\\mathrm{G}\\). Returns a new map \\(\\mathrm{M=HG}\\)
@@ -321,12 +454,14 @@ classdef (Abstract) Map < matlab.mixin.Copyable
     % - apply_(this,x)
     % - applyJacobianT_(this, y, v)
     % - applyInverse_(this,y)
+    % - applyElementWise_(this,x)
     % - plus_(this,G)
     % - minus_(this,G)
     % - mpower_(this,p)
     % - times_(this,G)
     % - makeInversion_(this)
     % - makeComposition_(this, H)
+    % - normBound_(this)
     methods (Access = protected)
         function y = apply_(this, x)
             % Not implemented in this Abstract class
@@ -340,6 +475,10 @@ classdef (Abstract) Map < matlab.mixin.Copyable
             % Not implemented in this Abstract class
             error('applyInverse_ method not implemented');
         end
+        function [y,d] = applyElementWise_(this, x)
+            % Not implemented in this Abstract class
+            error('applyElementWise_ method not implemented');
+        end
         function M = plus_(this,G)
             % Constructs a :class:`MapSummation` object to sum the
             % current :class:`Map` \\(\\mathrm{H}\\) with the given \\(\\mathrm{G}\\).
@@ -404,22 +543,65 @@ classdef (Abstract) Map < matlab.mixin.Copyable
                 M = MapComposition(this,G);
             end
         end
+        function nrm = normBound_(this)
+            % Returns an upper bound of the norm computed from the norms
+            % (or bounds) of the parts of the Map (-1 if unknown). Called by
+            % :meth:`getNormBound` when the norm is unknown, such that norms
+            % cached in the parts since the construction of the Map are
+            % propagated. Default: :attr:`norm`.
+            
+            nrm=this.norm;
+        end
     end
     
     %% Utility methods
     % - memoize(this, fieldName, fcn, xs)
+    % - memoKey(x)
+    % - memoMatch(key, in, keyc, x, useHash)
     methods (Access = protected)
         function x = memoize(this, fieldName, fcn, x)
+            global isProfiling
             if ~iscell(x) % handle single input case
                 x = {x};
             end
-            if   ~isequal(this.memoCache.(fieldName).in, x)
-                this.memoCache.(fieldName).in = x;
-                x = fcn(x{:});
-                this.memoCache.(fieldName).out = x;
+            c = this.memoCache.(fieldName);
+            if ~isfield(c,'key') % empty cache
+                c = struct('in',{{}},'out',{{}},'key',{{}},'bytes',[],'last',[],'tick',0,'hits',0,'misses',0);
+            end
+            c.tick = c.tick+1;
+            key = Map.memoKey(x);
+            useHash = ~strcmp(this.memoizeCheck,'identity') || ~all([key.hasPtr]);
+            % Search the cached inputs, most recently used first
+            [~,order] = sort(c.last,'descend');
+            j = 0;
+            for k = order
+                if Map.memoMatch(key, c.in{k}, c.key{k}, x, useHash)
+                    j = k;
+                    break;
+                end
+            end
+            if j>0
+                if isProfiling, mapProfiler('memoHit'); end
+                c.hits = c.hits+1;
+                c.last(j) = c.tick;
+                x = c.out{j};
             else
-                x = this.memoCache.(fieldName).out;
+                c.misses = c.misses+1;
+                in = x;
+                x = fcn(in{:});
+                w = whos('in','x');
+                c.in{end+1} = in;
+                c.out{end+1} = x;
+                c.key{end+1} = key;
+                c.bytes(end+1) = sum([w.bytes]);
+                c.last(end+1) = c.tick;
+                % Evict the least recently used entries (the last one is always kept)
+                while length(c.in)>1 && sum(c.bytes)>this.memoizeBudget
+                    [~,k] = min(c.last);
+                    c.in(k)=[]; c.out(k)=[]; c.key(k)=[]; c.bytes(k)=[]; c.last(k)=[];
+                end
             end
+            this.memoCache.(fieldName) = c;
         end
         %% Deep Copy
         function this = copyElement(obj)
@@ -431,6 +613,53 @@ classdef (Abstract) Map < matlab.mixin.Copyable
                 'applyJacobianT', struct('in', [], 'out', []), ...
                 'applyInverse', struct('in', [], 'out', []));
             this.precomputeCache = struct();
+            this.profileId = 0;
+        end
+    end
+    methods (Static, Access = protected)
+        function key = memoKey(x)
+            % Computes the lookup key of the inputs x (cell): size, class,
+            % address of the data buffer (0 if not available) and a
+            % sample of at most 64 evenly spaced elements.
+            persistent hasDataPointer
+            if isempty(hasDataPointer)
+                hasDataPointer = (exist('dataPointer')==3);
+            end
+            key = struct('sz',cell(size(x)),'cls',[],'isreal',[],'ptr',[],'sample',[],'hasPtr',[]);
+            for n = 1:numel(x)
+                v = x{n};
+                key(n).sz = size(v);
+                key(n).cls = class(v);
+                key(n).ptr = uint64(0);
+                if isnumeric(v) || islogical(v)
+                    key(n).isreal = isreal(v);
+                    if hasDataPointer && ~isa(v,'gpuArray')
+                        key(n).ptr = dataPointer(v);
+                    end
+                    if ~isempty(v)
+                        key(n).sample = v(round(linspace(1,numel(v),min(numel(v),64))));
+                        if isa(v,'gpuArray'), key(n).sample = gather(key(n).sample); end
+                    end
+                end
+                key(n).hasPtr = key(n).ptr~=0;
+            end
+        end
+        function b = memoMatch(key, in, keyc, x, useHash)
+            % True if the inputs x (with lookup key key) are identical to
+            % the cached inputs in (with lookup key keyc). Each input is
+            % matched either by buffer identity (the cache holds a
+            % reference to the cached buffer so that it cannot be modified
+            % or freed without a copy) or, if useHash, by sampled content
+            % hash confirmed by a full comparison.
+            b = numel(key)==numel(keyc);
+            for n = 1:numel(key)
+                if ~b, return; end
+                b = isequal(key(n).sz,keyc(n).sz) && strcmp(key(n).cls,keyc(n).cls) ...
+                    && isequal(key(n).isreal,keyc(n).isreal);
+                if b && ~(key(n).hasPtr && key(n).ptr==keyc(n).ptr)
+                    b = useHash && isequal(key(n).sample,keyc(n).sample) && isequal(x{n},in{n});
+                end
+            end
         end
     end
 end
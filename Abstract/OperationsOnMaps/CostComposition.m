@@ -63,6 +63,7 @@ classdef CostComposition < MapComposition & Cost
     % - applyGrad_(this,x)
     % - applyProx_(this,z,alpha)
     % - makeComposition_(this,G)
+    % - normBound_(this)
     methods (Access = protected)
         function g=applyGrad_(this,x)
             % Reimplemented from :class:`Cost`
@@ -71,6 +72,16 @@ classdef CostComposition < MapComposition & Cost
                 g = real(g);
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % Reimplemented from :class:`Cost`: \\(\\mathrm{H_2 x}\\) is
+            % computed once for both the value and the gradient
+            H2x = this.H2.apply(x);
+            [f,gy] = this.H1.applyAndGrad(H2x);
+            g = this.H2.applyJacobianT(gy,x);
+            if this.isInputReal
+                g = real(g);
+            end
+        end
         function x=applyProx_(this,z,alpha)
             % Reimplemented from :class:`Cost`
             %
@@ -97,6 +108,10 @@ classdef CostComposition < MapComposition & Cost
                 M=CostComposition(this.H1,this.H2*G);
             end
         end
+        function nrm = normBound_(this)
+            % Reimplemented from :class:`MapComposition` (multiple inheritance)
+            nrm=normBound_@MapComposition(this);
+        end
     end
     
     %% Utility methods
@@ -87,6 +87,16 @@ classdef CostMultiplication < Cost
                 g=applyGrad_@Cost(this,x);
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % Reimplemented from :class:`Cost`
+            if this.isnum && this.isDifferentiable
+                [f,g]=this.cost2.applyAndGrad(x);
+                f=this.cost1*f;
+                g=this.cost1*g;
+            else
+                [f,g]=applyAndGrad_@Cost(this,x);
+            end
+        end
         function y=applyProx_(this,x,alpha)
             % Reimplemented from :class:`Cost`
             if this.isnum
@@ -116,5 +116,15 @@ classdef CostPartialSummation <  CostSummation
                 g = applyGrad_@CostSummation(this,x);
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % Reimplemented from :class:`CostSummation`: the value and
+            % the gradient are evaluated on the current subset
+            if this.partialGrad > 0
+                f = this.apply_(x);
+                g = this.applyGrad_(x);
+            else
+                [f,g] = applyAndGrad_@CostSummation(this,x);
+            end
+        end
     end
 end
@@ -69,6 +69,17 @@ classdef CostSummation <  MapSummation & Cost
                 g=g+this.alpha(n)*this.mapsCell{n}.applyGrad(x);
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % Reimplemented from :class:`Cost`: value and gradient of each
+            % term with :meth:`applyAndGrad`
+            [f,g]=this.mapsCell{1}.applyAndGrad(x);
+            f=this.alpha(1)*f; g=this.alpha(1)*g;
+            for n=2:this.numMaps
+                [fn,gn]=this.mapsCell{n}.applyAndGrad(x);
+                f=f+this.alpha(n)*fn;
+                g=g+this.alpha(n)*gn;
+            end
+        end
         function x=applyProx_(this,z,alpha)
             % Reimplemented from :class:`Cost` in the case of the sum
             % between a :class:`CostRectangle` \\(i_C \\) and a
@@ -97,6 +108,9 @@ classdef CostSummation <  MapSummation & Cost
         function M = makeComposition_(this,G)
             M=makeComposition_@MapSummation(this,G);
         end
+        function nrm = normBound_(this)
+            nrm=normBound_@MapSummation(this);
+        end
     end
     methods (Access = protected)
          %% Copy
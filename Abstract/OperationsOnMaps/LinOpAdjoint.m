@@ -53,6 +53,7 @@ classdef LinOpAdjoint < LinOp
     % - makeAdjoint_(this)
     % - makeHHt_(this)
     % - makeHtH_(this)
+    % - normBound_(this)
 	methods (Access = protected)
         function y = apply_(this,x) 
             % Reimplemented from :class:`LinOp`
@@ -90,6 +91,11 @@ classdef LinOpAdjoint < LinOp
             % Reimplemented from parent class :class:`LinOp`.
             M=this.TLinOp.makeHHt();
         end
+        function nrm = normBound_(this)
+            % Reimplemented from parent class :class:`Map`: norm (or bound)
+            % of TLinOp.
+            nrm=this.TLinOp.getNormBound();
+        end
     end
     
     methods (Access = protected)
@@ -52,6 +52,7 @@ classdef LinOpComposition < MapComposition & LinOp
     % - applyHtH_(this,x)
     % - applyHHt_(this,x)
     % - applyAdjointInverse_(this,x)
+    % - normBound_(this)
     methods (Access = protected)
         function y = apply_(this,x)
             % Reimplemented from :class:`LinOp`
@@ -122,6 +123,10 @@ classdef LinOpComposition < MapComposition & LinOp
                 M=makeComposition_@MapComposition(this,G);
             end
         end
+        function nrm = normBound_(this)
+            % Reimplemented from :class:`MapComposition` (multiple inheritance)
+            nrm=normBound_@MapComposition(this);
+        end
     end
     
     methods (Access = protected)
@@ -60,6 +60,9 @@ classdef LinOpSummation < MapSummation &  LinOp
         function M = makeComposition_(this,G)
             M=makeComposition_@MapSummation(this,G);
         end
+        function nrm = normBound_(this)
+            nrm=normBound_@MapSummation(this);
+        end
         function M = plus_(this,G)
             % Reimplemented from :class:`LinOp` 
             
@@ -5,6 +5,17 @@ classdef MapComposition < Map
     % :param H1:  left hand side :class:`Map` 
     % :param H2:  right hand side :class:`Map`
     %
+    % **Note** When both \\(\\mathrm{H}_1\\) and \\(\\mathrm{H}_2\\) are element-wise
+    % Maps (e.g. :class:`OpEWAbs`, :class:`OpEWSqrt`, :class:`OpEWInverse`,
+    % :class:`OpEWSquaredMagnitude`, :class:`OpEWfunc`, :class:`LinOpDiag`
+    % or sums/products of those), the whole chain is flattened and evaluated
+    % stage after stage without the intermediate calls, and the
+    % Jacobian-transpose product is obtained from the same forward pass
+    % (instead of re-applying \\(\\mathrm{H}_2\\) at each level). Runs of
+    % :class:`OpEWAbs`, :class:`OpEWSqrt`, :class:`OpEWInverse`,
+    % :class:`OpEWSquaredMagnitude` and :class:`LinOpDiag` are fused into a
+    % single mex kernel (ewChain) when it is compiled (see buildElementWise).
+    %
     % **Example** H=MapComposition(H1,H2)
     %
     % See also :class:`Map`
@@ -29,6 +40,12 @@ classdef MapComposition < Map
     properties(SetAccess = protected,GetAccess = public)
         H1;           % Left hand side Map
         H2;           % Right hand side Map
+        ewMaps;       % Flattened element-wise chain (in order of application)
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+        ewCodes;      % Kernel code of each stage of ewMaps (0 if not supported)
+        ewCoefs;      % Coefficients of the LinOpDiag stages of ewMaps
+        useMex;       % true if the fused mex kernel ewChain is available
     end
     %% Constructor
     methods
@@ -51,6 +68,25 @@ classdef MapComposition < Map
             this.sizein=H2.sizein;
             this.sizeout=H1.sizeout;
             this.name=sprintf('MapComposition( %s ; %s )',H1.name,H2.name);      
+            % isElementWise
+            if this.H1.isElementWise && this.H2.isElementWise
+                this.isElementWise=true;
+                this.ewMaps=[MapComposition.elementWiseStages(H2), MapComposition.elementWiseStages(H1)];
+                this.ewCodes=zeros(1,length(this.ewMaps));
+                this.ewCoefs=cell(1,length(this.ewMaps));
+                for k=1:length(this.ewMaps)
+                    M=this.ewMaps{k};
+                    if isa(M,'OpEWAbs'), this.ewCodes(k)=1;
+                    elseif isa(M,'OpEWSqrt'), this.ewCodes(k)=2;
+                    elseif isa(M,'OpEWInverse'), this.ewCodes(k)=3;
+                    elseif isa(M,'OpEWSquaredMagnitude'), this.ewCodes(k)=4;
+                    elseif isa(M,'LinOpDiag') && (isscalar(M.diag) || numel(M.diag)==prod(M.sizein))
+                        this.ewCodes(k)=5;
+                        this.ewCoefs{k}=M.diag;
+                    end
+                end
+                this.useMex=(exist('ewChain')==3);
+            end
         end
     end
     
@@ -58,14 +94,22 @@ classdef MapComposition < Map
     % - apply_(this,x)
     % - applyJacobianT_(this, y, v)
     % - applyInverse_(this,y)
+    % - normBound_(this)
 	methods (Access = protected)
         function y = apply_(this, x)
             % Reimplemented from :class:`Map`
-            y = this.H1.apply(this.H2.apply(x));
+            if this.isElementWise
+                y = this.applyElementWise_(x);
+            else
+                y = this.H1.apply(this.H2.apply(x));
+            end
         end
         function x = applyJacobianT_(this, y, v)
             % Reimplemented from :class:`Map`
-            if this.isDifferentiable
+            if this.isDifferentiable && this.isElementWise
+                [~,d]=this.applyElementWise_(v);
+                x=d.*y;
+            elseif this.isDifferentiable
                 x=this.H2.applyJacobianT(this.H1.applyJacobianT(y,this.H2.apply(v)),v);
             else
                 x = applyJacobianT_@Map(this,y,v);
@@ -79,6 +123,40 @@ classdef MapComposition < Map
                 x = applyInverse_@Map(this,y);
             end
         end
+        function [y,d] = applyElementWise_(this, x)
+            % Reimplemented from :class:`Map`
+            % Goes through the flattened chain ewMaps, runs of stages
+            % supported by the mex kernel being evaluated in a single pass.
+            y=x; d=1;
+            n=length(this.ewMaps);
+            k=1;
+            while k<=n
+                if this.ewCodes(k)>0 && this.useMex && isMexCompatible(y,'complex')
+                    l=k;
+                    while l<n && this.ewCodes(l+1)>0, l=l+1; end
+                    coefs=this.ewCoefs(k:l);
+                    if isa(y,'single')
+                        coefs=cellfun(@single,coefs,'UniformOutput',false);
+                    end
+                    if nargout>1
+                        [y,dk]=ewChain(y,this.ewCodes(k:l),coefs);
+                    else
+                        y=ewChain(y,this.ewCodes(k:l),coefs);
+                    end
+                else
+                    l=k;
+                    if nargout>1
+                        [y,dk]=this.ewMaps{k}.applyElementWise(y);
+                    else
+                        y=this.ewMaps{k}.applyElementWise(y);
+                    end
+                end
+                if nargout>1
+                    d=d.*dk;
+                end
+                k=l+1;
+            end
+        end
         function M = makeComposition_(this,G)
              % Reimplemented from :class:`Map`
 			 H2G = this.H2*G; % Since H1*H2 is not simplified, first try to compose H2 with G
@@ -88,6 +166,17 @@ classdef MapComposition < Map
 				 M = MapComposition(this, G);
 			 end
         end
+        function nrm = normBound_(this)
+            % Reimplemented from :class:`Map`: product of the norms (or
+            % bounds) of H1 and H2
+            nrm1 = this.H1.getNormBound();
+            nrm2 = this.H2.getNormBound();
+            if nrm1 ~= -1 && nrm2 ~= -1
+                nrm = nrm1 * nrm2;
+            else
+                nrm = -1;
+            end
+        end
     end	
     
     methods (Access = protected)
@@ -96,6 +185,22 @@ classdef MapComposition < Map
           this = copyElement@Map(obj);
           this.H1 = copyElement@Map(obj.H1);
           this.H2 = copyElement@Map(obj.H2);
+          if this.isElementWise
+              this.ewMaps=[MapComposition.elementWiseStages(this.H2), MapComposition.elementWiseStages(this.H1)];
+          end
       end
     end
+    
+    %% Utility methods
+    % - elementWiseStages(H)
+    methods (Static, Access = protected)
+        function c = elementWiseStages(H)
+            % Returns the list of the element-wise stages of H (in order of application)
+            if isa(H,'MapComposition') && H.isElementWise
+                c=H.ewMaps;
+            else
+                c={H};
+            end
+        end
+    end
 end
\ No newline at end of file
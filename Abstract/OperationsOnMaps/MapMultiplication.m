@@ -42,12 +42,14 @@ classdef MapMultiplication < Map
             this.sizeout = this.M2.sizeout;
             assert(cmpSize(this.sizein,this.M2.sizein),'Given Maps do not have consistent  sizein') ;
             assert(cmpSize(this.sizeout,this.M2.sizeout),'Given Maps do not have the consistent sizeout ');
+            this.isElementWise= Map1.isElementWise && Map2.isElementWise;
         end
     end
     
     %% Core Methods containing implementations (Protected)
     % - apply_(this,x)
     % - applyJacobianT_(this, y, v)
+    % - applyElementWise_(this,x)
     % - makeComposition_(this,G)
     methods (Access = protected)
         function y = apply_(this,x) 
@@ -57,8 +59,25 @@ classdef MapMultiplication < Map
         function x = applyJacobianT_(this, y, v)
             % Reimplemented from :class:`Map`   
             
-            x=(this.M1*v).*this.M2.applyJacobianT(y,v) + (this.M2*v).*this.M1.applyJacobianT(y,v);
+            if this.isElementWise
+                [~,d]=this.applyElementWise_(v);
+                x=d.*y;
+            else
+                x=(this.M1*v).*this.M2.applyJacobianT(y,v) + (this.M2*v).*this.M1.applyJacobianT(y,v);
+            end
         end     
+        function [y,d] = applyElementWise_(this,x)
+            % Reimplemented from :class:`Map`   
+            if nargout>1
+                [y1,d1]=this.M1.applyElementWise(x);
+                [y2,d2]=this.M2.applyElementWise(x);
+                d=y1.*d2 + y2.*d1;
+            else
+                y1=this.M1.applyElementWise(x);
+                y2=this.M2.applyElementWise(x);
+            end
+            y=y1.*y2;
+        end
         function M = makeComposition_(this,G)
             % Reimplemented from :class:`Map`  
             M=MapMultiplication(this.M1*G,this.M2*G);
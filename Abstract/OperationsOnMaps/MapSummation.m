@@ -83,13 +83,16 @@ classdef MapSummation < Map
                 assert(cmpSize(this.sizeout,this.mapsCell{n}.sizeout),'%d-th input does not have the consistent sizeout ', n);
                 this.isDifferentiable= this.mapsCell{n}.isDifferentiable && this.isDifferentiable;
             end      
+            this.isElementWise=all(cellfun(@(M) M.isElementWise, this.mapsCell));
         end
     end
     
     %% Core Methods containing implementations (Protected)
     % - apply_(this,x)
     % - applyJacobianT_(this, y, v)
+    % - applyElementWise_(this,x)
     % - makeComposition_(this,G)
+    % - normBound_(this)
     methods (Access = protected)
         function y = apply_(this,x) 
             % Reimplemented from :class:`Map`   
@@ -100,11 +103,30 @@ classdef MapSummation < Map
         end  
         function x = applyJacobianT_(this, y, v)
             % Reimplemented from :class:`Map`   
-            x = zeros_(this.sizein);
-            for n = 1:this.numMaps
-                x = x + this.alpha(n) .* this.mapsCell{n}.applyJacobianT(y,v);
+            if this.isElementWise
+                [~,d]=this.applyElementWise_(v);
+                x = d.*y;
+            else
+                x = zeros_(this.sizein);
+                for n = 1:this.numMaps
+                    x = x + this.alpha(n) .* this.mapsCell{n}.applyJacobianT(y,v);
+                end
             end
         end     
+        function [y,d] = applyElementWise_(this, x)
+            % Reimplemented from :class:`Map`   
+            y = zeros_(this.sizeout);
+            d = 0;
+            for n = 1:this.numMaps
+                if nargout>1
+                    [yn,dn] = this.mapsCell{n}.applyElementWise(x);
+                    d = d + this.alpha(n) .* dn;
+                else
+                    yn = this.mapsCell{n}.applyElementWise(x);
+                end
+                y = y + this.alpha(n) .* yn;
+            end
+        end
         function M = makeComposition_(this,G)
             % Reimplemented from :class:`Map`  
             M=this.alpha(1)*this.mapsCell{1}*G;
@@ -112,6 +134,20 @@ classdef MapSummation < Map
                 M=M+ this.alpha(i)*this.mapsCell{i}*G;
             end
         end
+        function nrm = normBound_(this)
+            % Reimplemented from :class:`Map`: sum of the norms (or
+            % bounds) of the Maps weighted by abs(alpha)
+            nrm=0;
+            for n=1:this.numMaps
+                nrmn=this.mapsCell{n}.getNormBound();
+                if nrmn~=-1
+                    nrm=nrm+abs(this.alpha(n))*nrmn;
+                else
+                    nrm=-1;
+                    break
+                end
+            end
+        end
     end
     
     methods (Access = protected)
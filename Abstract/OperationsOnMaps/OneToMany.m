@@ -16,6 +16,11 @@ classdef OneToMany < LinOp
     % WARNING
     % Obj.HtH(x) = alpha{n} * Obj.ALinOp{n}.HtH(x)
     %
+    % As for StackLinOp, setting the property numWorkers to a positive
+    % value evaluates the LinOps on the workers of the current parallel pool
+    % when it is thread-based (the sums of the adjoints are parfor
+    % reductions).
+    %
     % Please refer to the LINOP superclass for general documentation about
     % linear operators class
     % See also LinOp
@@ -40,6 +45,9 @@ classdef OneToMany < LinOp
         numLinOp   % number of linop
         alpha      % scalar factor
     end
+    properties (SetAccess = public,GetAccess = public)
+        numWorkers=0; % maximum number of workers evaluating the LinOps in parallel (thread-based pool only, 0: sequential)
+    end
     
     methods
         function this = OneToMany(ALinOp,alpha)
@@ -71,33 +79,39 @@ classdef OneToMany < LinOp
         end
         
         function y = apply(this,x) % apply the operator
+            A = this.ALinOp; alpha = this.alpha;
             y = cell(1,this.numLinOp);
-            for n =1:this.numLinOp
-                y{n} = this.alpha(n) .* this.ALinOp{n}(1).apply(x);
+            parfor (n =1:this.numLinOp,threadWorkers(this.numWorkers))
+                y{n} = alpha(n) .* A{n}(1).apply(x);
             end
         end
         function y = adjoint(this,x) % apply the adjoint
             assert( iscell(x), 'adjoint of a OneToMany must be applied to a cell array',this.sizeout);
             assert( numel(x)==this.numLinOp, 'OneToMany LinOp: input does not have the right number of cell: %d',this.numLinOp);
-            y =  this.alpha(1) .* this.ALinOp{1}(1).applyAdjoint(x{1});
             for n =2:this.numLinOp
                 assert( checkSize(x{n},this.ALinOp{n}.sizeout),  'x does not have the right size: [%d, %d %d %d %d ]',this.sizeout);
-                y = y + this.alpha(n) .* this.ALinOp{n}(1).applyAdjoint(x{n});
+            end
+            A = this.ALinOp; alpha = this.alpha;
+            y = this.alpha(1) .* this.ALinOp{1}(1).applyAdjoint(x{1});
+            parfor (n =2:this.numLinOp,threadWorkers(this.numWorkers))
+                y = y + alpha(n) .* A{n}(1).applyAdjoint(x{n});
             end
         end
         function y = HtH(this,x) % apply the operator
+            A = this.ALinOp; alpha = this.alpha;
             y = this.alpha(1) .* this.ALinOp{1}(1).HtH(x);
-            for n =2:this.numLinOp
-                y = y + this.alpha(n) .* this.ALinOp{n}(1).HtH(x);
+            parfor (n =2:this.numLinOp,threadWorkers(this.numWorkers))
+                y = y + alpha(n) .* A{n}(1).HtH(x);
             end
         end
         function y = HtWH(this,x,W) % apply the operator
             
             assert( iscell(W), 'W in OneToMany.HtWH must be a cell array',this.sizeout);
             assert( numel(W)==this.numLinOp, 'OneToMany W does not have the right number of cell: %d',this.numLinOp);
+            A = this.ALinOp; alpha = this.alpha;
             y = this.alpha(1) .* this.ALinOp{1}(1).HtWH(x,W{1});
-            for n =2:this.numLinOp
-                y = y + this.alpha(n) .* this.ALinOp{n}(1).HtWH(x,W{n});
+            parfor (n =2:this.numLinOp,threadWorkers(this.numWorkers))
+                y = y + alpha(n) .* A{n}(1).HtWH(x,W{n});
             end
         end
     end
@@ -11,6 +11,13 @@ classdef StackLinOp < LinOp
     % such that
     % y(..,i) = alpha(i) * ALinOp{i}
     %
+    % The LinOps are independent: setting the property numWorkers to a
+    % positive value evaluates them on the workers of the current parallel
+    % pool when it is thread-based (parfor, see threadWorkers), each one
+    % writing its slice of the output, and the
+    % adjoint is accumulated as a parfor reduction. The output is laid out
+    % directly in its final order (no permute, even with 'DontUseComplex').
+    % With numWorkers=0 (default) the LinOps are applied sequentially.
     %
     % Please refer to the LINOP superclass for general documentation about
     % linear operators class
@@ -38,6 +45,9 @@ classdef StackLinOp < LinOp
         usecomplex = true; % if false complex are represented as an extra dimension of size 2 containning Real and imagenary parts of x
         prmtIndex;
     end
+    properties (SetAccess = public,GetAccess = public)
+        numWorkers=0; % maximum number of workers evaluating the LinOps in parallel (thread-based pool only, 0: sequential)
+    end
     
     methods
         function this = StackLinOp(ALinOp,alpha, varargin)
@@ -90,31 +100,28 @@ classdef StackLinOp < LinOp
         function y = apply_(this,x) % apply the operator
             assert(checkSize(x, this.sizein));
             
-            y = zeros_(prod(this.ALinOp{1}.sizeout),this.numLinOp);
-            for n = 1:this.numLinOp
-                tmp =this.ALinOp{n}(1).apply(x);
-                y(:,n) =  this.alpha(n) .* tmp(:);
-            end
-            
-            if ~this.usecomplex
-                y = reshape(y, [this.ALinOp{1}.sizeout this.numLinOp]);
-                y = permute(y,this.prmtIndex);
-            else
-                y = reshape(y, this.sizeout);
+            % Output laid out as [slice, LinOp, last] with last the last
+            % dimension of the outputs of the LinOps with 'DontUseComplex'
+            % (1 otherwise), such that each LinOp writes its own slices
+            A = this.ALinOp; alpha = this.alpha; szA = this.ALinOp{1}.sizeout;
+            nl = 1;
+            if ~this.usecomplex, nl = szA(end); end
+            y = zeros_(prod(szA)/nl,this.numLinOp,nl);
+            parfor (n = 1:this.numLinOp,threadWorkers(this.numWorkers))
+                y(:,n,:) = reshape(alpha(n) .* A{n}(1).apply(x),[],1,nl);
             end
+            y = reshape(y, this.sizeout);
         end
         function y = applyAdjoint_(this,x) % apply the adjoint
             assert(checkSize(x, this.sizeout));
-            y =  zeros_(this.sizein);
             
-            if ~this.usecomplex
-                x = permute(x,this.prmtIndex);
-            end
-            x = reshape(x, prod(this.ALinOp{1}.sizeout),this.numLinOp);
-            for n = 1:this.numLinOp
-                xtmp = zeros_(this.ALinOp{1}.sizeout);
-                xtmp(:) = x(:,n);
-                y = y + this.alpha(n) .* this.ALinOp{n}(1).applyAdjoint(xtmp);
+            A = this.ALinOp; alpha = this.alpha; szA = this.ALinOp{1}.sizeout;
+            nl = 1;
+            if ~this.usecomplex, nl = szA(end); end
+            x = reshape(x, [],this.numLinOp,nl);
+            y = zeros_(this.sizein);
+            parfor (n = 1:this.numLinOp,threadWorkers(this.numWorkers))
+                y = y + alpha(n) .* A{n}(1).applyAdjoint(reshape(x(:,n,:),szA));
             end
         end
     end
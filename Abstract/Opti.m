@@ -11,6 +11,32 @@ classdef Opti < matlab.mixin.SetGet
     % :param time: execution time of the algorithm
     % :param niter: iteration counter
     % :param xopt: optimization variable
+    % :param batchDim: dimension of :attr:`xopt` along which independent problems are stacked (batched mode, default empty)
+    % :param checkpointFile: base name of the checkpoint files (default empty: no checkpoint)
+    % :param checkpointInterval: number of iterations between two checkpoints (default 0: no checkpoint)
+    %
+    % **Note** In batched mode, K independent problems sharing the same operators are solved as one
+    % stacked computation: the data are stacked along the dimension batchDim and the operators act
+    % on each problem independently (e.g. :class:`LinOpConv` or :class:`LinOpGrad` with the parameter
+    % index excluding batchDim, separable costs). The convergence is then tested for each problem
+    % through the method :meth:`testConvergenceBatch` of :attr:`CvOp`: converged problems are retired,
+    % i.e. their slice of :attr:`xopt` is frozen, and the algorithm stops when all of them are retired.
+    % Each problem then follows the iterates it would follow alone only if the scalar parameters of the
+    % algorithm (steps, momentum, line searches) do not depend on the iterates: the batched mode is
+    % restricted to the algorithms whose method :meth:`batchSupported` returns true. The retired
+    % problems are still computed (the operators act on the full stack) but do not influence the others.
+    %
+    % **Note** When checkpointFile and checkpointInterval are set, the state of the algorithm (see
+    % :meth:`getState`) is written every checkpointInterval iterations to memory-mapped files
+    % (checkpointFile_0.bin / checkpointFile_1.bin, alternately, each with its layout and its non-numeric
+    % state in checkpointFile_0.mat / checkpointFile_1.mat). The arrays are copied into the mappings, the
+    % writing to the disk being done in the background by the operating system, and the mapping of a
+    % slot is reused while the sizes and classes of the arrays do not change (otherwise only the slot
+    % being written is recreated, the other one keeping the last complete checkpoint).
+    % After a crash or a preemption, the method :meth:`resume` maps the last complete checkpoint back
+    % into the algorithm, which is then restarted with run() (without x0): the iteration counter is
+    % kept, and only the parameters of the algorithm are set up (see :meth:`initialize`). The checkpoints
+    % are available only for the algorithms which reimplement :meth:`getState` and :meth:`setState`.
     %
     % See also :class:`OutputOpti` :class:`Cost`
     
@@ -45,6 +71,10 @@ classdef Opti < matlab.mixin.SetGet
         xopt=[];             % optimization variable
         xold=[];
         needxold=false;
+        batchActive=[];      % problems of the batch which are not retired (batched mode)
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+        xbatch=[];           % values of the retired problems (batched mode)
     end
     % Full public properties
     properties
@@ -54,6 +84,15 @@ classdef Opti < matlab.mixin.SetGet
         CvOp=TestCvg();      % OutputOpti object
         maxiter=50;     % maximal number of iterates
         ItUpOut=0;      % period (in number of iterations) of calling the OutputOpti object
+        batchDim=[];    % dimension along which independent problems are stacked (batched mode)
+        checkpointFile='';      % base name of the checkpoint files (empty: no checkpoint)
+        checkpointInterval=0;   % number of iterations between two checkpoints (0: no checkpoint)
+    end
+    properties (SetAccess = protected,GetAccess = protected,Transient)
+        checkpointMaps={[],[]};       % writable memory maps of the two checkpoint files
+        checkpointLayout={[],[]};     % layout of the state in each map
+        checkpointSlot=1;             % map to be written next
+        resumed=false;                % true if the state was restored by resume
     end
     
     %% Methods
@@ -64,14 +103,31 @@ classdef Opti < matlab.mixin.SetGet
             % :param x0: initial point in \\(\\in X\\), if no argument restarts from the current value :attr:`xopt`.
             %
             % **note**: this method does not return anything, the result being stored in public attribute :attr:`xopt`.
+            if ~isempty(this.batchDim) && ~this.batchSupported()
+                error('%s does not support the batched mode (its steps depend on the iterates of all the problems)',class(this));
+            end
             if(nargin==1)
                 assert(~isempty(this.xopt),'Missing starting point x0');
+                if this.resumed, this.initialize([]); end
             else
+                this.resumed=false;
                 this.initialize(x0);
+                if this.checkpointInterval>0 && ~isempty(this.checkpointFile)
+                    % New run: the checkpoints of a previous one are discarded
+                    this.checkpointMaps={[],[]};
+                    this.checkpointLayout={[],[]};
+                    this.checkpointSlot=1;
+                    for s=0:1
+                        if exist(sprintf('%s_%d.mat',this.checkpointFile,s),'file')==2
+                            delete(sprintf('%s_%d.mat',this.checkpointFile,s));
+                        end
+                    end
+                end
             end            
             tstart=tic;
             this.OutOp.init();
-            this.niter=0;
+            if ~this.resumed, this.niter=0; end
+            this.resumed=false;
             this.starting_verb();
             this.endingMessage= ['Maximum number of iterations reached: ', num2str(this.maxiter)];           
             while (this.niter<this.maxiter)
@@ -84,7 +140,9 @@ classdef Opti < matlab.mixin.SetGet
                     this.niter=this.niter+1;
                     
                     % - Convergence test
-                    if this.niter>1 && this.CvOp.testConvergence(this), break; end
+                    if ~isempty(this.batchDim)
+                        if this.niter>1 && this.retireBatch(), break; end
+                    elseif this.niter>1 && this.CvOp.testConvergence(this), break; end
                     
                     % - Call OutputOpti object
                     if this.ItUpOut>0 && (((mod(this.niter,this.ItUpOut)==0)|| (this.niter==1)))
@@ -93,28 +151,82 @@ classdef Opti < matlab.mixin.SetGet
                     if this.needxold
                         this.xold=this.xopt;
                     end
+                    
+                    % - Checkpoint
+                    if this.checkpointInterval>0 && ~isempty(this.checkpointFile) && mod(this.niter,this.checkpointInterval)==0
+                        this.writeCheckpoint();
+                    end
                 elseif  flag==this.OPTI_STOP,
                     break;
                 end
             end
+            if ~isempty(this.batchDim)
+                this.restoreBatch();
+            end
+            this.OutOp.flush();
             this.time=toc(tstart);
             this.ending_verb();
         end
         function initialize(this,x0)
             % Implements initialization of the algorithm
             %
-            % :param x0: initial point
+            % :param x0: initial point (if empty, only the parameters of the
+            %            algorithm are set up, the state being kept, e.g.
+            %            after :meth:`resume`)
             
+            if this.CvOp.needxold
+                this.needxold=true;
+            end
             if ~isempty(x0) % To restart from current state if wanted
                 this.xopt=x0;
-                if this.CvOp.needxold
-                    this.needxold=true;
-                end
                 if this.needxold
                     this.xold=x0;
                 end
+                if ~isempty(this.batchDim)
+                    this.batchActive=true(1,size(x0,this.batchDim));
+                    this.xbatch=[];
+                end
+            end
+        end
+        function allDone=retireBatch(this)
+            % Batched mode: restores the retired problems in :attr:`xopt`, tests the
+            % convergence of the others and retires the converged ones
+            %
+            % :return: true if all the problems of the batch are retired
+            
+            this.restoreBatch();
+            sel=repmat({':'},1,max(ndims(this.xopt),this.batchDim));
+            stop=this.CvOp.testConvergenceBatch(this,this.batchDim);
+            retired=reshape(stop,1,[]) & this.batchActive;
+            if any(retired)
+                if isempty(this.xbatch), this.xbatch=this.xopt; end
+                sel{this.batchDim}=retired;
+                this.xbatch(sel{:})=this.xopt(sel{:});
+                this.batchActive(retired)=false;
+            end
+            allDone=~any(this.batchActive);
+            if allDone
+                this.endingMessage=['All the ',num2str(length(this.batchActive)),' problems of the batch have converged'];
+            end
+        end
+        function restoreBatch(this)
+            % Batched mode: sets the slices of the retired problems in
+            % :attr:`xopt` back to their values at retirement
+            
+            if ~isempty(this.xbatch) && ~all(this.batchActive)
+                sel=repmat({':'},1,max(ndims(this.xopt),this.batchDim));
+                sel{this.batchDim}=~this.batchActive;
+                this.xopt(sel{:})=this.xbatch(sel{:});
             end
         end
+        function tf=batchSupported(this)
+            % Returns true if the algorithm treats the problems stacked in
+            % batched mode independently, i.e. its scalar parameters do not
+            % depend on the iterates (default false). Reimplemented by the
+            % algorithms with fixed steps.
+            
+            tf=false;
+        end
         function flag=doIteration(this)
             % Implements algorithm iteration
             %
@@ -126,6 +238,124 @@ classdef Opti < matlab.mixin.SetGet
             
             error(['In ',this.name,': doIteration method is not implemented']);
         end
+        function st=getState(this)
+            % Returns the state of the algorithm as a structure (saved by
+            % the checkpoints). Algorithms with internal variables have to
+            % reimplement this method and :meth:`setState`; the checkpoints
+            % are refused for the algorithms which do not reimplement it.
+            
+            st.xopt=this.xopt;
+            st.xold=this.xold;
+            st.batchActive=this.batchActive;
+            st.xbatch=this.xbatch;
+        end
+        function setState(this,st)
+            % Sets the state of the algorithm from a structure returned by
+            % :meth:`getState`
+            
+            this.xopt=st.xopt;
+            this.xold=st.xold;
+            this.batchActive=st.batchActive;
+            this.xbatch=st.xbatch;
+        end
+        function writeCheckpoint(this)
+            % Writes the state of the algorithm in the memory-mapped
+            % checkpoint files (see the note above)
+            
+            this.checkCheckpointSupport();
+            [layout.skel,leaves]=Opti.flattenState(this.getState(),{});
+            layout.fmt=cell(0,3);
+            layout.info=cell(length(leaves),2);      % class and complexity of each array
+            for k=1:length(leaves)
+                v=leaves{k};
+                layout.info(k,:)={class(v),~isreal(v)};
+                cl=class(v); if islogical(v), cl='uint8'; end
+                layout.fmt(end+1,:)={cl,size(v),sprintf('r%d',k)};
+                if ~isreal(v), layout.fmt(end+1,:)={cl,size(v),sprintf('i%d',k)}; end
+            end
+            s=this.checkpointSlot;
+            name=sprintf('%s_%d',this.checkpointFile,s-1);
+            old=this.checkpointLayout{s};
+            % The iteration number is set last, a negative value marking
+            % an incomplete checkpoint
+            if isempty(old) || ~isequal(layout.fmt,old.fmt) || ~isequal(layout.info,old.info)
+                % New sizes or classes: recreate this slot only
+                this.checkpointMaps{s}=[];
+                fmt=[{'double',[1 1],'iter'};layout.fmt];
+                nbytes=8;
+                for k=1:size(layout.fmt,1)
+                    nbytes=nbytes+prod(layout.fmt{k,2})*numel(typecast(cast(0,layout.fmt{k,1}),'uint8'));
+                end
+                fid=fopen([name,'.bin'],'w');
+                assert(fid>0,['Cannot create the checkpoint file ',name,'.bin']);
+                fwrite(fid,-1,'double');
+                fseek(fid,nbytes-1,'bof'); fwrite(fid,0,'uint8');
+                fclose(fid);
+                this.checkpointMaps{s}=memmapfile([name,'.bin'],'Format',fmt,'Writable',true);
+            else
+                this.checkpointMaps{s}.Data(1).iter=-1;
+            end
+            if ~isequal(layout,old)
+                % Non-numeric state (e.g. the task of a line search)
+                save([name,'.mat'],'-struct','layout');
+            end
+            this.checkpointLayout{s}=layout;
+            m=this.checkpointMaps{s};
+            for k=1:length(leaves)
+                v=leaves{k};
+                if islogical(v), v=uint8(v); end
+                m.Data(1).(sprintf('r%d',k))=real(v);
+                if ~isreal(v), m.Data(1).(sprintf('i%d',k))=imag(v); end
+            end
+            m.Data(1).iter=this.niter;
+            this.checkpointSlot=3-s;
+        end
+        function resume(this,file)
+            % Restores the state of the algorithm from the last complete
+            % checkpoint written in the files with base name file (default
+            % :attr:`checkpointFile`). The algorithm can then be restarted
+            % with run(), which continues the iteration count.
+            
+            this.checkCheckpointSupport();
+            if nargin>1, this.checkpointFile=file; end
+            this.checkpointMaps={[],[]};
+            this.checkpointLayout={[],[]};
+            best=0; iter=-1;
+            for s=1:2
+                name=sprintf('%s_%d',this.checkpointFile,s-1);
+                if exist([name,'.mat'],'file')~=2 || exist([name,'.bin'],'file')~=2, continue; end
+                layout=load([name,'.mat']);
+                fmt=[{'double',[1 1],'iter'};layout.fmt];
+                this.checkpointMaps{s}=memmapfile([name,'.bin'],'Format',fmt,'Writable',true);
+                this.checkpointLayout{s}=layout;
+                if this.checkpointMaps{s}.Data(1).iter>iter, best=s; iter=this.checkpointMaps{s}.Data(1).iter; end
+            end
+            assert(best>0,'No complete checkpoint found');
+            layout=this.checkpointLayout{best};
+            m=this.checkpointMaps{best};
+            leaves=cell(1,size(layout.info,1));
+            for k=1:length(leaves)
+                v=m.Data(1).(sprintf('r%d',k));
+                if layout.info{k,2}, v=complex(v,m.Data(1).(sprintf('i%d',k))); end
+                leaves{k}=cast(v,layout.info{k,1});
+            end
+            this.setState(Opti.unflattenState(layout.skel,leaves));
+            this.niter=iter;
+            this.resumed=true;
+            % The next checkpoint is written in the other slot
+            this.checkpointSlot=3-best;
+        end
+        function [f,args]=costEvaluator(this)
+            % Returns a function handle f and its arguments args such that
+            % f(args{:}) is the cost at the current iterate :attr:`xopt`. The
+            % arguments are snapshots (copy-on-write) such that f can be
+            % evaluated later, e.g. on a worker (see :class:`OutputOpti`).
+            % This method can be overloaded to reuse quantities computed by
+            % the algorithm instead of applying again the operators.
+            
+            f=@(C,x) C.apply(x);
+            args={this.cost,this.xopt};
+        end
         function updateParams(this)
             % Updates the parameters of the algorithm at each iteration
             % (default: no update). This method can be overloaded to makes
@@ -149,4 +379,57 @@ classdef Opti < matlab.mixin.SetGet
             end
         end
     end
+    methods (Access = protected)
+        function checkCheckpointSupport(this)
+            % Errors if the class does not reimplement :meth:`getState`
+            % (its internal variables would not be saved)
+            mc=metaclass(this);
+            m=mc.MethodList(strcmp({mc.MethodList.Name},'getState'));
+            if strcmp(m(1).DefiningClass.Name,'Opti')
+                error('%s does not save its state (getState/setState not reimplemented): checkpoints are not supported',class(this));
+            end
+        end
+    end
+    methods (Static, Access = protected)
+        function [skel,leaves]=flattenState(v,leaves)
+            % Replaces the non-empty numeric and logical arrays of v (possibly
+            % nested in cells and structures) by their index in leaves
+            if (isnumeric(v) || islogical(v)) && ~isempty(v) && ~issparse(v)
+                leaves{end+1}=gather(v);
+                skel=struct('checkpointLeaf',length(leaves));
+            elseif iscell(v)
+                skel=v;
+                for k=1:numel(v)
+                    [skel{k},leaves]=Opti.flattenState(v{k},leaves);
+                end
+            elseif isstruct(v) && isscalar(v)
+                skel=v;
+                f=fieldnames(v);
+                for k=1:length(f)
+                    [skel.(f{k}),leaves]=Opti.flattenState(v.(f{k}),leaves);
+                end
+            else
+                skel=v;
+            end
+        end
+        function v=unflattenState(skel,leaves)
+            % Inverse of :meth:`flattenState`
+            if isstruct(skel) && isscalar(skel) && isequal(fieldnames(skel),{'checkpointLeaf'})
+                v=leaves{skel.checkpointLeaf};
+            elseif iscell(skel)
+                v=skel;
+                for k=1:numel(skel)
+                    v{k}=Opti.unflattenState(skel{k},leaves);
+                end
+            elseif isstruct(skel) && isscalar(skel)
+                v=skel;
+                f=fieldnames(skel);
+                for k=1:length(f)
+                    v.(f{k})=Opti.unflattenState(skel.(f{k}),leaves);
+                end
+            else
+                v=skel;
+            end
+        end
+    end
 end
@@ -9,6 +9,11 @@ classdef CostKullLeib < Cost
     %
     % All attributes of parent class :class:`Cost` are inherited. 
     %
+    % When the mex file klFused is compiled (see buildKullLeib), the value, the gradient
+    % and the proximity operator are evaluated in a single pass over the data (including
+    % the domain check), and :meth:`applyAndGrad` returns both the value and the gradient
+    % from the same pass.
+    %
     % :param bet: smoothing parameter \\(\\beta\\) (default 0) 
     %
     % **Example** C=CostKullLeib(sz,y,bet)
@@ -42,6 +47,9 @@ classdef CostKullLeib < Cost
     properties (SetAccess = protected,GetAccess = public)
         bet= 0;     % smoothing parameter, if bet=0 then the unsmoothed version is used
     end
+    properties (SetAccess = protected,GetAccess = protected)
+        useMex;     % true if the mex file klFused is available
+    end
     
     %% Constructor
     methods       
@@ -52,6 +60,7 @@ classdef CostKullLeib < Cost
             if nargin==3, this.bet=bet;end
             this.isConvex=true;  
             this.isSeparable=true;
+            this.useMex=(exist('klFused')==3);
             % -- Compute Lipschitz constant of the gradient
             if (this.bet>0)
                 this.lip=max(this.y(:))./this.bet^2;
@@ -64,11 +73,14 @@ classdef CostKullLeib < Cost
     % - apply_(this,x)
     % - applyGrad_(this,x)
     % - applyProx_(this,x,alpha)
+    % - applyAndGrad_(this,x)
 	methods (Access = protected)
         function f=apply_(this,x)
         	% Reimplemented from parent class :class:`Cost`.
         	
-            if any(x(:)<-this.bet)
+            if this.useMex && isMexCompatible(x,this.y)
+                f=klFused('apply',x,this.y,this.bet);
+            elseif any(x(:)<-this.bet)
                 f=Inf;
             else
                 if (this.bet~=0)
@@ -84,12 +96,18 @@ classdef CostKullLeib < Cost
         function g=applyGrad_(this,x)
         	% Reimplemented from parent class :class:`Cost`.
             
-            g= 1 - this.y./(x+this.bet);
+            if this.useMex && isMexCompatible(x,this.y)
+                g=klFused('grad',x,this.y,this.bet);
+            else
+                g= 1 - this.y./(x+this.bet);
+            end
         end  
         function z=applyProx_(this,x,alpha)
             % Reimplemented from parent class :class:`Cost`.
             
-            if (this.bet~=0)
+            if (this.bet~=0) && this.useMex && isscalar(alpha) && isMexCompatible(x,this.y)
+                z=klFused('prox',x,this.y,this.bet,alpha);
+            elseif (this.bet~=0)
                 delta=(x-alpha-this.bet).^2+4*(x*this.bet + alpha*(this.y-this.bet));
                 z=zeros_(size(x));
                 mask=delta>=0;
@@ -98,5 +116,16 @@ classdef CostKullLeib < Cost
                 z=applyProx_@Cost(this,x,alpha);
             end
         end
+        function [f,g]=applyAndGrad_(this,x)
+            % Reimplemented from parent class :class:`Cost`.
+            % Value and gradient in a single pass with the mex file klFused.
+            
+            if this.useMex && isMexCompatible(x,this.y)
+                [f,g]=klFused('applygrad',x,this.y,this.bet);
+            else
+                f=this.apply_(x);
+                g=this.applyGrad_(x);
+            end
+        end
     end
 end
@@ -5,6 +5,8 @@ classdef CostL2Composition <  CostComposition
     %
     % :param H1: :class:`CostL2` object
     % :param H2:  :class:`Map` object
+    % :param proxCacheSize: number of values of alpha for which the operators of the prox are kept when
+    %                       :attr:`doPrecomputation` is true (default 4, least recently used ones are evicted first)
     %
     % All attributes of parent class :class:`CostL2` and :class:`CostComposition` are inherited. 
     %
@@ -38,6 +40,12 @@ classdef CostL2Composition <  CostComposition
         doSumConv=0;  % to correctly switch in the prox
         doDownConv=0; % to correctly switch in the prox
     end
+    properties (SetAccess = public,GetAccess = public)
+        proxCacheSize=4; % number of values of alpha kept in the prox cache
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+        useMex;       % true if the mex file l2ConvProx is available
+    end
     
     %% Constructor
     methods
@@ -48,11 +56,15 @@ classdef CostL2Composition <  CostComposition
                 this.lip=this.H1.lip*this.H2.norm^2;
             end
             this.name=sprintf('CostL2Composition ( %s )',H2.name);
+            this.useMex=(exist('l2ConvProx')==3);
             % If H2 is a composition between a LinOpDownsample and a LinOpConv    
             if isa(this.H2,'LinOpComposition') && isa(this.H2.H1,'LinOpDownsample') && unique(this.H2.H1.first)==1 &&  isa(this.H2.H2,'LinOpConv') && isnumeric(this.H1.W) && this.H1.W==1
                 this.OpSumP=LinOpSumPatches(this.H2.H1.sizein,this.H2.H1.sizein./this.H2.H1.df);
                 this.H2H2t=this.OpSumP*(abs(this.H2.H2.mtf).^2);      
                 this.doDownConv=1;
+            % If H2 is a fused downsampled convolution (the prox inverse is cached by H2)
+            elseif isa(this.H2,'LinOpDownsampledConv') && isnumeric(this.H1.W) && this.H1.W==1
+                this.doDownConv=1;
             % If H2 is a composition between a LinOpSum and a LinOpConv
             % applied in the other dimensions than the Sum
             elseif isa(this.H2,'LinOpComposition') && isa(this.H2.H1,'LinOpSum') &&  isa(this.H2.H2,'LinOpConv') && isnumeric(this.H1.W) && this.H1.W==1
@@ -74,6 +86,7 @@ classdef CostL2Composition <  CostComposition
     % - apply_(this, x)
     % - applyGrad_(this,x)
     % - applyProx_(this,z,alpha)
+    % - applyAndGrad_(this,x)
     % - makeComposition_(this,G)
     methods (Access = protected)
 		function y = apply_(this, x)
@@ -117,6 +130,26 @@ classdef CostL2Composition <  CostComposition
                 g=applyGrad_@CostComposition(this,x);
             end
         end
+		function [f,g]=applyAndGrad_(this,x)
+			% Reimplemented from parent class :class:`CostComposition`.
+			%
+			% With the precomputations of :meth:`apply_` and :meth:`applyGrad_`, \\(\\mathrm{W H^{\\star}Hx}\\)
+			% is computed once and shared by the value and the gradient.
+			if this.isH2LinOp && (isnumeric(this.H1.W) || isa(this.H1.W,'LinOpScaledIdentity')) && this.doPrecomputation
+				if ~isfield(this.precomputeCache,'WHty')
+					this.precomputeCache.WHty=this.H1.W*this.H2.applyAdjoint(this.H1.y);
+				end
+				if ~isfield(this.precomputeCache,'ytWy')
+					this.precomputeCache.ytWy= this.H1.y(:)' * reshape(this.H1.W * this.H1.y,numel(this.H1.y), 1);
+				end
+				WHtHx=this.H1.W*this.H2.applyHtH(x);
+				f=0.5 * x(:)' * WHtHx(:) - x(:)' * this.precomputeCache.WHty(:) + 0.5 * this.precomputeCache.ytWy;
+				f=real(f); % due to numerical error
+				g=WHtHx - this.precomputeCache.WHty;
+			else
+				[f,g]=applyAndGrad_@CostComposition(this,x);
+			end
+		end
         function y=applyProx_(this,x,alpha)
             % Reimplemented from parent class :class:`CostComposition`.
 	    %
@@ -128,11 +161,18 @@ classdef CostL2Composition <  CostComposition
             %  - if \\(\\mathrm{H}\\) is a :class:`LinOpComposition`
             %    composing a :class:`LinOpDownsample` with a
             %    :class:`LinOpConv`. The implementation follows [1,2].
+            %  - if \\(\\mathrm{H}\\) is a :class:`LinOpDownsampledConv`. The
+            %    implementation follows [1,2] (see :meth:`applyHtHShiftedInverse`).
             %  - if \\(\\mathrm{H}\\) is a :class:`LinOpComposition`
             %    composing a :class:`LinOpSum` with a
             %    :class:`LinOpConv`. The implementation follows [2]
             %
-            % **Note** If :attr:`doPrecomputation` is true, then \\(\\mathrm{H^TWy}\\) is stored.
+            % **Note** If :attr:`doPrecomputation` is true, then \\(\\mathrm{H^TWy}\\) is stored, as well as the
+            % operators depending on \\(\\alpha\\) (inverse denominators for a :class:`LinOpConv`, \\(\\alpha\\mathrm{H^{\\star}WH + I}\\)
+            % otherwise) for the last :attr:`proxCacheSize` values of \\(\\alpha\\), such that algorithms changing
+            % \\(\\alpha\\) (e.g. :class:`OptiADMM` with adaptive \\(\\rho\\)) do not rebuild them at each change.
+            % For a :class:`LinOpConv`, the spectral step is fused in the mex file l2ConvProx when it is
+            % compiled (see buildL2Prox).
             %
             % **References**     
             %
@@ -144,16 +184,47 @@ classdef CostL2Composition <  CostComposition
             
             if isa(this.H2,'LinOpConv') && (isnumeric(this.H1.W) || (isa(this.H1.W,'LinOpDiag') && this.H1.W.isScaledIdentity))
             % If the composed operator is a LinOpConv
+                % (I + alpha*w*H'H)^-1 (x + alpha*w*H'y) computed in the
+                % Fourier domain of H (half spectrum if H.useRFT)
+                if isnumeric(this.H1.W), w=this.H1.W; else, w=this.H1.W.diag(1); end
+                if this.H2.useRFT
+                    fwd=@(z) Srft(z,this.H2.Notindex); bwd=@(z) iSrft(z,this.H2.Notindex);
+                else
+                    fwd=@(z) Sfft(z,this.H2.Notindex); bwd=@(z) iSfft(z,this.H2.Notindex);
+                end
                 if this.doPrecomputation
                     if ~isfield(this.precomputeCache,'fftHstardata')
-                        this.precomputeCache.fftHstardata=conj(this.H2.mtf).*Sfft(this.H1.y*this.H1.W,this.H2.Notindex);
+                        this.precomputeCache.fftHstardata=conj(this.H2.mtf).*fwd(this.H1.y);
                     end
-                    y=iSfft((Sfft(x,this.H2.Notindex) + this.H1.W*alpha*this.precomputeCache.fftHstardata)./(1+this.H1.W*alpha*(abs(this.H2.mtf).^2)), this.H2.Notindex);
+                    fftHstardata=this.precomputeCache.fftHstardata;
+                    invDen=this.proxCacheGet('invDen',alpha);
+                    if isempty(invDen)
+                        invDen=1./(1+w*alpha*(real(this.H2.mtf).^2+imag(this.H2.mtf).^2));
+                        this.proxCachePut('invDen',alpha,invDen);
+                    end
+                else
+                    fftHstardata=conj(this.H2.mtf).*fwd(this.H1.y);
+                    invDen=1./(1+w*alpha*(real(this.H2.mtf).^2+imag(this.H2.mtf).^2));
+                end
+                fx=fwd(x);
+                if this.useMex && isMexCompatible(fx,fftHstardata,invDen,'complex') && numel(fftHstardata)==numel(fx) ...
+                        && (isscalar(invDen) || numel(invDen)==numel(fx))
+                    y=bwd(l2ConvProx(fx,fftHstardata,invDen,w*alpha));
                 else
-                    fftHstardata=conj(this.H2.mtf).*Sfft(this.H1.W*this.H1.y,this.H2.Notindex);
-                    y=iSfft((Sfft(x,this.H2.Notindex) + this.H1.W*alpha*fftHstardata)./(1+this.H1.W*alpha*(abs(this.H2.mtf).^2)), this.H2.Notindex);
+                    y=bwd((fx + w*alpha*fftHstardata).*invDen);
                 end
                 if this.H2.isReal, y=real(y);end
+            % If the composed operator is a LinOpDownsampledConv
+            elseif this.doDownConv && isa(this.H2,'LinOpDownsampledConv')
+                 % (alpha H'H + I)^-1 (alpha H'y + x) = (H'H + I/alpha)^-1 (H'y + x/alpha)
+                 if this.doPrecomputation
+                     if ~isfield(this.precomputeCache,'HtWy')
+                         this.precomputeCache.HtWy=this.H2.applyAdjoint(this.H1.y);
+                     end
+                     y=this.H2.applyHtHShiftedInverse(this.precomputeCache.HtWy+x/alpha,1/alpha);
+                 else
+                     y=this.H2.applyHtHShiftedInverse(this.H2.applyAdjoint(this.H1.y)+x/alpha,1/alpha);
+                 end
             % If the composed operator is a composition between a LinOpDownsample and a LinOpConv    
             elseif this.doDownConv
                  % this.H1 -> CostL2
@@ -197,18 +268,19 @@ classdef CostL2Composition <  CostComposition
             elseif this.isH2LinOp && ~this.isH2SemiOrtho
                 % TODO : reimplement similarly to the above Woodbury
                 % Formula case
-                if ~this.doPrecomputation || (this.doPrecomputation && (~isfield(this.precomputeCache,'HtHplusId')  || (alpha~=this.precomputeCache.alpha)))
+                HtHplusId=[];
+                if this.doPrecomputation
+                    HtHplusId=this.proxCacheGet('HtHplusId',alpha);
+                end
+                if isempty(HtHplusId)
                     if isnumeric(this.H1.W) || (isa(this.H1.W,'LinOpDiag') && this.H1.W.isScaledIdentity)
                         HtHplusId=alpha*this.H1.W*(this.H2'*this.H2) + LinOpDiag(this.H2.sizein,1);
                     else
                         HtHplusId=alpha*this.H2'*this.H1.W*this.H2 + LinOpDiag(this.H2.sizein,1);
                     end
                     if this.doPrecomputation
-                        this.precomputeCache.HtHplusId=HtHplusId;
-                        this.precomputeCache.alpha=alpha;
+                        this.proxCachePut('HtHplusId',alpha,HtHplusId);
                     end
-                else
-                    HtHplusId=this.precomputeCache.HtHplusId;
                 end
                 if HtHplusId.isInvertible
                     if this.doPrecomputation
@@ -245,6 +317,45 @@ classdef CostL2Composition <  CostComposition
         end
     end
     
+    %% Utility methods
+    % - proxCacheGet(this,field,alpha)
+    % - proxCachePut(this,field,alpha,val)
+    methods (Access = protected)
+        function val = proxCacheGet(this,field,alpha)
+            % Returns the value stored for alpha in the prox cache field
+            % (empty if none)
+            val=[];
+            if isfield(this.precomputeCache,field)
+                c=this.precomputeCache.(field);
+                k=find(c.alpha==alpha,1);
+                if ~isempty(k)
+                    c.tick=c.tick+1;
+                    c.last(k)=c.tick;
+                    val=c.val{k};
+                    this.precomputeCache.(field)=c;
+                end
+            end
+        end
+        function proxCachePut(this,field,alpha,val)
+            % Stores val for alpha in the prox cache field, evicting the
+            % least recently used value when proxCacheSize is reached
+            if isfield(this.precomputeCache,field)
+                c=this.precomputeCache.(field);
+            else
+                c=struct('alpha',[],'val',{{}},'last',[],'tick',0);
+            end
+            while ~isempty(c.alpha) && length(c.alpha)>=max(this.proxCacheSize,1)
+                [~,k]=min(c.last);
+                c.alpha(k)=[]; c.val(k)=[]; c.last(k)=[];
+            end
+            c.tick=c.tick+1;
+            c.alpha(end+1)=alpha;
+            c.val{end+1}=val;
+            c.last(end+1)=c.tick;
+            this.precomputeCache.(field)=c;
+        end
+    end
+    
     methods (Access = protected)
          %% Copy
          function this = copyElement(obj)
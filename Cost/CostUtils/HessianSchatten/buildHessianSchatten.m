@@ -35,7 +35,7 @@ end
 [mpath,~,~] = fileparts(which('buildHessianSchatten'));
 pth = cd;
 cd(mpath);
-MexOpt= ['-DUSE_BLAS_LIB ' '-DNEW_MATLAB_BLAS ' '-DINT_64BITS '  '-largeArrayDims ' ,options,  ' CXXFLAGS=''$CXXFLAGS -fPIC -Wall -mtune=native  -fomit-frame-pointer -O2  '''  ' LDFLAGS=''$LDFLAGS '''];
+MexOpt= ['-I',fileparts(which('mapProfiler')),' ' '-I',fileparts(which('cpuInfo')),' ' '-DUSE_BLAS_LIB ' '-DNEW_MATLAB_BLAS ' '-DINT_64BITS '  '-largeArrayDims ' ,options,  ' CXXFLAGS=''$CXXFLAGS -fPIC -Wall -fomit-frame-pointer -O3 -fno-math-errno  '''  ' LDFLAGS=''$LDFLAGS '''];
 eval(['mex ',' svd2D_recomp.cpp ',MexOpt]);
 eval(['mex ',' svd2D_decomp.cpp ',MexOpt]);
 eval(['mex ',' svd3D_recomp.cpp ',MexOpt]);
@@ -1,9 +1,12 @@
+#ifndef CPU_VARIANT
 #include <mex.h>
 #include <math.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "matrix.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
 
 /***************************************************************************
   Let X be a NxMx3 matrix such that:
@@ -17,7 +20,7 @@
   and V of size NxMx2.
   
   Compilation:
-     -linux: mex -v svd2D_decomp.cpp CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
+     -linux: mex -v svd2D_decomp.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
      -mac  : mex svd2D_decomp.cpp -DUSE_BLAS_LIB -DNEW_MATLAB_BLAS -DINT_64BITS -largeArrayDims CXX=/usr/local/Cellar/gcc/6.3.0_1/bin/g++-6 CXXOPTIMFLAGS="-O3
                    -mtune=native -fomit-frame-pointer -fopenmp" LDOPTIMFLAGS=" -O " LINKLIBS="$LINKLIBS -lmwblas -lmwlapack -L"/usr/local/Cellar/gcc/6.3.0_1/lib/gcc/6" -L/ -fopenmp"
      -mac (another option): "brew install llvm" on terminal, then use the command
@@ -29,8 +32,19 @@
 
 ****************************************************************************/
 
+// Variants of svd2DDecomp for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "svd2D_decomp.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "svd2D_decomp.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "svd2D_decomp.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "svd2D_decomp.cpp"
+
 void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
 
+	KernelTimer timer("svd2D_decomp");
 	double* X=(double *)mxGetPr(prhs[0]);                  // matrix input
 	int  number_of_dims=mxGetNumberOfDimensions(prhs[0]);  // number of dimensions of the input matrix
     const mwSize *dims=mxGetDimensions(prhs[0]);           // dimension vector
@@ -53,6 +67,12 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
     double *Ye=(double *)mxGetPr(plhs[0]);    // eigenvalues
 	double *Yv=(double *)mxGetPr(plhs[1]);    // eigenvectors
 	
+	CPU_CALL(cpuIsa(),svd2DDecomp,(X,Ye,Yv,num_of_mat));
+}
+
+#else
+// Eigen-decomposition of the num_of_mat symmetric 2x2 matrices stored in X
+CPU_TARGET static void CPU_NAME(svd2DDecomp)(const double* X, double* Ye, double* Yv, int num_of_mat) {
 	int k,i;
 	double n;
 	double tmp[3];
@@ -87,7 +107,6 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
   			Yv[i+num_of_mat*k]=U[k];
   		}
     }
-    	
-}   	
-    	
-
+}
+#undef CPU_VARIANT
+#endif
@@ -1,16 +1,19 @@
+#ifndef CPU_VARIANT
 #include <mex.h>
 #include <math.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "matrix.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
 
 /***************************************************************************
 
   Reconstruct X from E and V obtained by svd2D_decomp
   
   Compilation:
-     -linux: mex svd2D_recomp.cpp CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
+     -linux: mex svd2D_recomp.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
      -mac  : mex svd2D_recomp.cpp -DUSE_BLAS_LIB -DNEW_MATLAB_BLAS -DINT_64BITS -largeArrayDims CXX=/usr/local/Cellar/gcc/6.3.0_1/bin/g++-6 CXXOPTIMFLAGS="-O3
                    -mtune=native -fomit-frame-pointer -fopenmp" LDOPTIMFLAGS=" -O " LINKLIBS="$LINKLIBS -lmwblas -lmwlapack -L"/usr/local/Cellar/gcc/6.3.0_1/lib/gcc/6" -L/ -fopenmp"
   
@@ -18,8 +21,19 @@
 
 ****************************************************************************/
 
+// Variants of svd2DRecomp for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "svd2D_recomp.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "svd2D_recomp.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "svd2D_recomp.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "svd2D_recomp.cpp"
+
 void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
 
+	KernelTimer timer("svd2D_recomp");
 	double* E=(double *)mxGetPr(prhs[0]);                       // input eigenvalues
 	double* V=(double *)mxGetPr(prhs[1]);                       // input eigenvectors
 	int  number_of_dimsE=mxGetNumberOfDimensions(prhs[0]);      // number of dimensions of E
@@ -45,6 +59,12 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
     	mexErrMsgTxt("Could not create mxArray.\n"); 		
     double *Y=(double *)mxGetPr(plhs[0]);    // reconstructed matrix
 	
+	CPU_CALL(cpuIsa(),svd2DRecomp,(E,V,Y,num_of_mat));
+}
+
+#else
+// Recomposition of the num_of_mat symmetric 2x2 matrices from their eigenvalues E and first eigenvectors V
+CPU_TARGET static void CPU_NAME(svd2DRecomp)(const double* E, const double* V, double* Y, int num_of_mat) {
 	int k,i;
 	double ee[2];
 	double vv[2];
@@ -63,5 +83,6 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
         	Y[i+num_of_mat*k]=tmp[k];
   		}
     }
-    	
-}   	
+}
+#undef CPU_VARIANT
+#endif
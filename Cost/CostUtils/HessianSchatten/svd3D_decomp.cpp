@@ -1,10 +1,12 @@
+#ifndef CPU_VARIANT
 #include <mex.h>
 #include <math.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "matrix.h"
-#include "matLib3D.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
 
 /***************************************************************************
   Let X be a NxMxKx6 matrix such that:
@@ -21,7 +23,7 @@
   Hence the function outputs two matrices E of size NxMxKx3 and V of size NxMxKx9.
   
   Compilation:
-     -linux: mex svd2D_decomp.cpp CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
+     -linux: mex svd2D_decomp.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
      -mac  : mex svd3D_decomp.cpp -DUSE_BLAS_LIB -DNEW_MATLAB_BLAS -DINT_64BITS -largeArrayDims CXX=/usr/local/Cellar/gcc/6.3.0_1/bin/g++-6 CXXOPTIMFLAGS="-O3
                    -mtune=native -fomit-frame-pointer -fopenmp" LDOPTIMFLAGS=" -O " LINKLIBS="$LINKLIBS -lmwblas -lmwlapack -L"/usr/local/Cellar/gcc/6.3.0_1/lib/gcc/6" -L/ -fopenmp"
   
@@ -29,8 +31,18 @@
 
 ****************************************************************************/
 
+// Variants of svd3DDecomp for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "svd3D_decomp.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "svd3D_decomp.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "svd3D_decomp.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "svd3D_decomp.cpp"
 
 void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+	KernelTimer timer("svd3D_decomp");
 	double* X=(double *)mxGetPr(prhs[0]);                  // matrix input
 	int  number_of_dims=mxGetNumberOfDimensions(prhs[0]);  // number of dimensions of the input matrix
     const mwSize *dims=mxGetDimensions(prhs[0]);           // dimension vector
@@ -54,6 +66,14 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
     double *Ye=(double *)mxGetPr(plhs[0]);    // eigenvalues
 	double *Yv=(double *)mxGetPr(plhs[1]);    // eigenvectors 
     
+	CPU_CALL(cpuIsa(),svd3DDecomp,(X,Ye,Yv,num_of_mat));
+}
+
+#else
+#include "eig3x3.h"   // helpers compiled for CPU_VARIANT
+
+// Eigen-decomposition of the num_of_mat symmetric 3x3 matrices stored in X
+CPU_TARGET static void CPU_NAME(svd3DDecomp)(const double* X, double* Ye, double* Yv, int num_of_mat) {
 	int k,i;	
 	double E[3];
 	double D[3];   
@@ -70,8 +90,8 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
         V[3]=X[i+num_of_mat];
         V[6]=X[i+num_of_mat*2];
         
-        tred2(V, D, E);
-        tql2(V, D, E);
+        CPU_NAME(tred2)(V, D, E);
+        CPU_NAME(tql2)(V, D, E);
         
   		for (k=0;k<3;k++)  // set result
         	Ye[i+num_of_mat*k]=D[k];
@@ -79,7 +99,7 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
         for (k=0;k<9;k++){
             Yv[i+num_of_mat*k]=V[k];
         }       
-    }   	
-}   	
-    	
-
+    }
+}
+#undef CPU_VARIANT
+#endif
@@ -1,17 +1,19 @@
+#ifndef CPU_VARIANT
 #include <mex.h>
 #include <math.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "matrix.h"
-#include "matLib3D.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
 
 /***************************************************************************
 
   Reconstruct X from E and V obtained by svd3D_decomp
   
   Compilation:
-     -linux: mex svd3D_recomp.cpp CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
+     -linux: mex svd3D_recomp.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CFLAGS="\$CFLAGS -openmp" LDFLAGS="\$LDFLAGS -openmp" -largeArrayDims
      -mac  : mex svd3D_recomp.cpp -DUSE_BLAS_LIB -DNEW_MATLAB_BLAS -DINT_64BITS -largeArrayDims CXX=/usr/local/Cellar/gcc/6.3.0_1/bin/g++-6 CXXOPTIMFLAGS="-O3
                    -mtune=native -fomit-frame-pointer -fopenmp" LDOPTIMFLAGS=" -O " LINKLIBS="$LINKLIBS -lmwblas -lmwlapack -L"/usr/local/Cellar/gcc/6.3.0_1/lib/gcc/6" -L/ -fopenmp"
  
@@ -19,8 +21,19 @@
 
 ****************************************************************************/
 
+// Variants of svd3DRecomp for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "svd3D_recomp.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "svd3D_recomp.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "svd3D_recomp.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "svd3D_recomp.cpp"
+
 void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
 
+	KernelTimer timer("svd3D_recomp");
 	double* E=(double *)mxGetPr(prhs[0]);                       // input eigenvalues
 	double* V=(double *)mxGetPr(prhs[1]);                       // input eigenvectors
 	int  number_of_dimsE=mxGetNumberOfDimensions(prhs[0]);      // number of dimensions of E
@@ -49,22 +62,27 @@ void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
     	mexErrMsgTxt("Could not create mxArray.\n"); 		
     double *Y=(double *)mxGetPr(plhs[0]);    // reconstructed matrix
 	
-	int k,i;
-	double ee[3];
-	double vv[9];
-	double tmp[6];  
-	
-    #pragma omp parallel for shared(E,V,Y) private(i, k,ee,vv,tmp)
-    for(i=0; i < num_of_mat; i++){
-    	for (k=0;k<3;k++)   // get the eigenvalues 
-        	ee[k]=E[i+num_of_mat*k];
-        for (k=0;k<9;k++)   // get the eigenvectors
-        	vv[k]=V[i+num_of_mat*k];
+	CPU_CALL(cpuIsa(),svd3DRecomp,(E,V,Y,num_of_mat));
+}
 
-        eigen3x3SymRec(tmp,vv,ee);
-  		for (k=0;k<6;k++){  // set result
-        	Y[i+num_of_mat*k]=tmp[k];
-  		}
+#else
+// Recomposition of the num_of_mat symmetric 3x3 matrices from their eigenvalues E and eigenvectors V
+// (same formula as eigen3x3SymRec in matLib3D.h, written on the planes of E and V such that the
+// loop over the matrices is vectorized)
+CPU_TARGET static void CPU_NAME(svd3DRecomp)(const double* E, const double* V, double* Y, int num_of_mat) {
+	const size_t n=num_of_mat;
+	const double *E0=E, *E1=E+n, *E2=E+2*n;
+	const double *V0=V, *V1=V+n, *V2=V+2*n, *V3=V+3*n, *V4=V+4*n, *V5=V+5*n, *V6=V+6*n, *V7=V+7*n, *V8=V+8*n;
+	
+    #pragma omp parallel for simd
+    for(int i=0; i < num_of_mat; i++){
+        Y[i]      =V0[i]*V0[i]*E0[i]+V3[i]*V3[i]*E1[i]+V6[i]*V6[i]*E2[i];
+        Y[i+n]    =V0[i]*V1[i]*E0[i]+V3[i]*V4[i]*E1[i]+V6[i]*V7[i]*E2[i];
+        Y[i+2*n]  =V0[i]*V2[i]*E0[i]+V3[i]*V5[i]*E1[i]+V6[i]*V8[i]*E2[i];
+        Y[i+3*n]  =V1[i]*V1[i]*E0[i]+V4[i]*V4[i]*E1[i]+V7[i]*V7[i]*E2[i];
+        Y[i+4*n]  =V1[i]*V2[i]*E0[i]+V4[i]*V5[i]*E1[i]+V7[i]*V8[i]*E2[i];
+        Y[i+5*n]  =V2[i]*V2[i]*E0[i]+V5[i]*V5[i]*E1[i]+V8[i]*V8[i]*E2[i];
     }
-    	
-}   	
+}
+#undef CPU_VARIANT
+#endif
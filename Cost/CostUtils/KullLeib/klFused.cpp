@@ -0,0 +1,153 @@
+#include <mex.h>
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  Fused element-wise evaluations of the Kullback-Leibler divergence
+       C(x) = sum_n x_n - y_n log(x_n + bet)     (+Inf if some x_n < -bet)
+  used by CostKullLeib:
+
+     f = klFused('apply',x,y,bet)
+           value of the cost; the domain check (x_n < -bet) is done within
+           the same pass (f=Inf if it fails)
+     g = klFused('grad',x,y,bet)
+           g = 1 - y./(x+bet)
+     [f,g] = klFused('applygrad',x,y,bet)
+           value and gradient in a single pass
+     z = klFused('prox',x,y,bet,alpha)
+           proximity operator (closed form, positive root of the quadratic)
+           z = 0.5*(x-alpha-bet+sqrt(delta)) if delta>=0, 0 otherwise, with
+           delta = (x-alpha-bet)^2 + 4*(x*bet + alpha*(y-bet))
+
+  When bet==0, the terms with x_n==0 are not counted in the value (as in
+  CostKullLeib.apply_). This is done without branch, with log(x+(x==0)),
+  so that the loops can be vectorized by the compiler (a vector log, e.g.
+  from glibc's libmvec, is only used without errno handling, hence the
+  -fno-math-errno flag in buildKullLeib.m).
+
+  x is a full real array (double or single), y is either a scalar or an
+  array with the same number of elements and class as x. The value is
+  accumulated in double precision.
+
+  Compilation:
+     -linux: mex klFused.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp -fno-math-errno" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildKullLeib.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+// Value (and gradient if g is not NULL); returns +Inf if x is out of the domain
+template <typename T>
+static double klApplyGrad(const T* x, const T* y, bool fullY, T bet, T* g, long n) {
+    double f=0;
+    long nout=0;
+    const bool zeroBet=(bet==0);
+    if (g) {
+        #pragma omp parallel for simd reduction(+:f,nout)
+        for (long i=0;i<n;i++) {
+            T xb=x[i]+bet, yi=fullY ? y[i] : y[0];
+            nout+=(xb<0);
+            T z=(T)(zeroBet & (x[i]==0));
+            f+=(double)(x[i]-yi*log(xb+z));
+            g[i]=1-yi/xb;
+        }
+    } else {
+        #pragma omp parallel for simd reduction(+:f,nout)
+        for (long i=0;i<n;i++) {
+            T xb=x[i]+bet, yi=fullY ? y[i] : y[0];
+            nout+=(xb<0);
+            T z=(T)(zeroBet & (x[i]==0));
+            f+=(double)(x[i]-yi*log(xb+z));
+        }
+    }
+    return nout>0 ? INFINITY : f;
+}
+
+template <typename T>
+static void klGrad(const T* x, const T* y, bool fullY, T bet, T* g, long n) {
+    #pragma omp parallel for simd
+    for (long i=0;i<n;i++)
+        g[i]=1-(fullY ? y[i] : y[0])/(x[i]+bet);
+}
+
+template <typename T>
+static void klProx(const T* x, const T* y, bool fullY, T bet, T alpha, T* z, long n) {
+    #pragma omp parallel for simd
+    for (long i=0;i<n;i++) {
+        T yi=fullY ? y[i] : y[0];
+        T b=x[i]-alpha-bet;
+        T delta=b*b+4*(x[i]*bet+alpha*(yi-bet));
+        T d=(delta>=0) ? delta : 0;          // no NaN in the masked lanes
+        z[i]=(delta>=0) ? (T)0.5*(b+sqrt(d)) : 0;
+    }
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs<4 || !mxIsChar(prhs[0]))
+        mexErrMsgTxt("Usage: klFused(command,x,y,bet,...).\n");
+    char cmd[16];
+    mxGetString(prhs[0],cmd,sizeof(cmd));
+    KernelTimer timer("klFused",cmd);
+    const mxArray *x=prhs[1], *y=prhs[2];
+    if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsComplex(x) || mxIsSparse(x))
+        mexErrMsgTxt("x should be a full real double or single array.\n");
+    if (mxGetClassID(y)!=mxGetClassID(x) || mxIsComplex(y) || mxIsSparse(y) ||
+        (mxGetNumberOfElements(y)!=1 && mxGetNumberOfElements(y)!=mxGetNumberOfElements(x)))
+        mexErrMsgTxt("y should be a real scalar or an array of the same size and class as x.\n");
+    double bet=mxGetScalar(prhs[3]);
+    long n=(long)mxGetNumberOfElements(x);
+    bool fullY=(mxGetNumberOfElements(y)==mxGetNumberOfElements(x)) && n>1;
+    bool isDouble=mxIsDouble(x);
+
+    if (!strcmp(cmd,"apply") || !strcmp(cmd,"applygrad")) {
+        if (nrhs!=4)
+            mexErrMsgTxt("Usage: f = klFused('apply',x,y,bet) or [f,g] = klFused('applygrad',x,y,bet).\n");
+        bool doGrad=!strcmp(cmd,"applygrad");
+        mxArray* g=NULL;
+        if (doGrad) {
+            g=mxCreateNumericArray(mxGetNumberOfDimensions(x),mxGetDimensions(x),mxGetClassID(x),mxREAL);
+            if (g == NULL)
+                mexErrMsgTxt("Could not create mxArray.\n");
+        }
+        double f;
+        if (isDouble)
+            f=klApplyGrad<double>((const double*)mxGetData(x),(const double*)mxGetData(y),fullY,bet,
+                                  doGrad ? (double*)mxGetData(g) : NULL,n);
+        else
+            f=klApplyGrad<float>((const float*)mxGetData(x),(const float*)mxGetData(y),fullY,(float)bet,
+                                 doGrad ? (float*)mxGetData(g) : NULL,n);
+        plhs[0]=mxCreateDoubleScalar(f);
+        if (doGrad) plhs[1]=g;
+    } else if (!strcmp(cmd,"grad")) {
+        if (nrhs!=4)
+            mexErrMsgTxt("Usage: g = klFused('grad',x,y,bet).\n");
+        plhs[0]=mxCreateNumericArray(mxGetNumberOfDimensions(x),mxGetDimensions(x),mxGetClassID(x),mxREAL);
+        if (plhs[0] == NULL)
+            mexErrMsgTxt("Could not create mxArray.\n");
+        if (isDouble)
+            klGrad<double>((const double*)mxGetData(x),(const double*)mxGetData(y),fullY,bet,(double*)mxGetData(plhs[0]),n);
+        else
+            klGrad<float>((const float*)mxGetData(x),(const float*)mxGetData(y),fullY,(float)bet,(float*)mxGetData(plhs[0]),n);
+    } else if (!strcmp(cmd,"prox")) {
+        if (nrhs!=5)
+            mexErrMsgTxt("Usage: z = klFused('prox',x,y,bet,alpha).\n");
+        double alpha=mxGetScalar(prhs[4]);
+        plhs[0]=mxCreateNumericArray(mxGetNumberOfDimensions(x),mxGetDimensions(x),mxGetClassID(x),mxREAL);
+        if (plhs[0] == NULL)
+            mexErrMsgTxt("Could not create mxArray.\n");
+        if (isDouble)
+            klProx<double>((const double*)mxGetData(x),(const double*)mxGetData(y),fullY,bet,alpha,(double*)mxGetData(plhs[0]),n);
+        else
+            klProx<float>((const float*)mxGetData(x),(const float*)mxGetData(y),fullY,(float)bet,(float)alpha,
+                          (float*)mxGetData(plhs[0]),n);
+    } else {
+        mexErrMsgTxt("Unknown command.\n");
+    }
+}
@@ -0,0 +1,25 @@
+% function varargout=klFused(cmd,x,y,bet,alpha)
+%
+%  Fused element-wise evaluations of the Kullback-Leibler divergence
+%  C(x) = sum(x - y.*log(x+bet)) (Inf if any(x<-bet)):
+%     f = klFused('apply',x,y,bet)          value (domain check in the same pass)
+%     g = klFused('grad',x,y,bet)           gradient 1-y./(x+bet)
+%     [f,g] = klFused('applygrad',x,y,bet)  value and gradient in one pass
+%     z = klFused('prox',x,y,bet,alpha)     proximity operator
+%  x is a real double or single array, y a scalar or an array of the same
+%  size and class. Mex implementation used by CostKullLeib.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
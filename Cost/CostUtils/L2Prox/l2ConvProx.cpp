@@ -0,0 +1,85 @@
+#include <mex.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  Y = l2ConvProx(X,F,D,a)
+
+  Spectral step of the prox of the CostL2Composition with a LinOpConv (see
+  CostL2Composition.applyProx_)
+       Y = (X + a*F) .* D
+  where X is the (half or full) spectrum of the input of the prox, F the
+  spectrum of H'Wy, D = 1./(1+a*w*|mtf|^2) the inverse denominator (real,
+  cached per value of a by CostL2Composition) and a a real scalar. The
+  result is written in a single pass without intermediate array.
+
+  X, F and Y have the same number of elements. D has either this number of
+  elements or is a scalar.
+
+  Supported types: double and single. X and F can be real or complex (the
+  real and imaginary parts are stored separately), D is real.
+
+  Compilation:
+     -linux: mex l2ConvProx.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildL2Prox.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+// The imaginary parts xi, fi, yi are NULL for real arrays
+template <typename T>
+static void l2ConvProx(const T* xr, const T* xi, const T* fr, const T* fi, const T* d, bool fullD, T a,
+                       T* yr, T* yi, long n) {
+    if (!yi) {
+        #pragma omp parallel for simd
+        for (long k=0;k<n;k++)
+            yr[k]=(xr[k]+a*fr[k])*(fullD ? d[k] : d[0]);
+    } else {
+        #pragma omp parallel for simd
+        for (long k=0;k<n;k++) {
+            T dk=fullD ? d[k] : d[0];
+            yr[k]=(xr[k]+a*fr[k])*dk;
+            yi[k]=((xi ? xi[k] : 0)+a*(fi ? fi[k] : 0))*dk;
+        }
+    }
+}
+
+template <typename T>
+static void run(const mxArray* X, const mxArray* F, const mxArray* D, double a, mxArray* Y, long n) {
+    l2ConvProx<T>((const T*)mxGetData(X),mxIsComplex(X) ? (const T*)mxGetImagData(X) : NULL,
+                  (const T*)mxGetData(F),mxIsComplex(F) ? (const T*)mxGetImagData(F) : NULL,
+                  (const T*)mxGetData(D),(mxGetNumberOfElements(D)==(mwSize)n) && n>1,(T)a,
+                  (T*)mxGetData(Y),mxIsComplex(Y) ? (T*)mxGetImagData(Y) : NULL,n);
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("l2ConvProx");
+    if (nrhs!=4)
+        mexErrMsgTxt("Usage: Y = l2ConvProx(X,F,D,a).\n");
+    const mxArray *X=prhs[0], *F=prhs[1], *D=prhs[2];
+    if (!(mxIsDouble(X) || mxIsSingle(X)) || mxIsSparse(X))
+        mexErrMsgTxt("X should be a full double or single array.\n");
+    if (mxGetClassID(F)!=mxGetClassID(X) || mxIsSparse(F) || mxGetNumberOfElements(F)!=mxGetNumberOfElements(X))
+        mexErrMsgTxt("F should be an array of the same class and number of elements as X.\n");
+    if (mxGetClassID(D)!=mxGetClassID(X) || mxIsSparse(D) || mxIsComplex(D) ||
+        (mxGetNumberOfElements(D)!=1 && mxGetNumberOfElements(D)!=mxGetNumberOfElements(X)))
+        mexErrMsgTxt("D should be a real scalar or an array of the same class and number of elements as X.\n");
+    double a=mxGetScalar(prhs[3]);
+
+    long n=(long)mxGetNumberOfElements(X);
+    bool cplx=mxIsComplex(X) || mxIsComplex(F);
+    plhs[0]=mxCreateNumericArray(mxGetNumberOfDimensions(X),mxGetDimensions(X),mxGetClassID(X),cplx ? mxCOMPLEX : mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    if (n==0) return;
+    if (mxIsDouble(X))
+        run<double>(X,F,D,a,plhs[0],n);
+    else
+        run<float>(X,F,D,a,plhs[0],n);
+}
@@ -0,0 +1,22 @@
+% function Y=l2ConvProx(X,F,D,a)
+%
+%  Spectral step of the prox of CostL2Composition with a LinOpConv
+%       Y = (X + a*F).*D
+%  computed in a single pass, where D=1./(1+a*w*abs(mtf).^2) is the cached
+%  inverse denominator (real scalar or array of the size of X). Mex
+%  implementation used by CostL2Composition.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
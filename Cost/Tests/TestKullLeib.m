@@ -0,0 +1,65 @@
+%--------------------------------------------------------------------------
+% This script checks the value, gradient and proximity operator of the
+% Kullback-Leibler divergence (CostKullLeib, evaluated in a single pass by
+% the mex file klFused when it is compiled) against their closed forms,
+% and the combined evaluation applyAndGrad on compositions and sums of
+% costs (as used by OptiVMLMB and OptiFBS).
+%--------------------------------------------------------------------------
+close all;
+help TestKullLeib
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Data
+sz=[64 48];
+y=10*rand(sz);
+x=rand(sz)+0.1;
+bet=0.5; alpha=0.7;
+disp(['klFused mex available : ',num2str(exist('klFused')==3)]);
+
+%% Value, gradient and prox (smoothed)
+KL=CostKullLeib(sz,y,bet);
+fref=sum(x(:)-y(:).*log(x(:)+bet));
+gref=1-y./(x+bet);
+b=x-alpha-bet; zref=0.5*(b+sqrt(b.^2+4*(x*bet+alpha*(y-bet))));
+disp(['Value relative error : ',num2str(abs(KL*x-fref)/abs(fref))]);
+disp(['Gradient max error   : ',num2str(max(abs(reshape(KL.applyGrad(x)-gref,[],1))))]);
+disp(['Prox max error       : ',num2str(max(abs(reshape(KL.applyProx(x,alpha)-zref,[],1))))]);
+[f,g]=KL.applyAndGrad(x);
+assert(abs(f-fref)<=1e-10*abs(fref) && max(abs(g(:)-gref(:)))<1e-10,'applyAndGrad does not match apply and applyGrad');
+
+%% Unsmoothed version: the zero entries are not counted, domain check
+KL0=CostKullLeib(sz,y);
+x0=x; x0(1:7:end)=0;
+nz=x0~=0;
+fref0=sum(x0(nz)-y(nz).*log(x0(nz)));
+disp(['Value (bet=0) relative error : ',num2str(abs(KL0*x0-fref0)/abs(fref0))]);
+xm=x; xm(5)=-bet-0.1;
+assert(isinf(KL*xm) && isinf(KL.applyAndGrad(xm)),'Domain check failed');
+
+%% Single precision and scalar data
+KLs=CostKullLeib(sz,single(3),bet);
+fs=KLs*single(x);
+frefs=sum(x(:)-3*log(x(:)+bet));
+disp(['Single value relative error : ',num2str(abs(double(fs)-frefs)/abs(frefs))]);
+
+%% applyAndGrad on a composition and a sum of costs
+H=LinOpConv(fft2(rand(sz)));
+F=KL*LinOpDiag(sz,2)+0.3*CostL2(sz,y)*H;
+[f,g]=F.applyAndGrad(x);
+disp(['Sum/composition value error    : ',num2str(abs(f-F*x)/abs(F*x))]);
+disp(['Sum/composition gradient error : ',num2str(max(abs(reshape(g-F.applyGrad(x),[],1))))]);
@@ -0,0 +1,53 @@
+%--------------------------------------------------------------------------
+% This script checks the direct computation of the proximal operator of
+% f(x)= 0.5||Hx - y||_W^2 where H is a convolution (LinOpConv) and W a
+% scalar weight, against its closed form
+%      (I + alpha*W*H'H)^-1 (x + alpha*W*H'y),
+% for several values of alpha (as with the adaptive rho of ADMM), with and
+% without precomputation (cache of the denominators per alpha).
+%--------------------------------------------------------------------------
+close all;
+help TestProxL2Conv
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Operators and data
+[im,psf,y]=GenerateData('Gaussian',20);
+H=LinOpConv(fft2(psf));
+w=2.5;
+F=CostL2(H.sizeout,y,w)*H;
+x=rand(size(im));
+alphas=[0.1 1 10 1 0.1 3];
+
+%% Closed form
+ref=cell(size(alphas));
+for k=1:length(alphas)
+    a=alphas(k);
+    ref{k}=real(ifft2((fft2(x)+a*w*conj(H.mtf).*fft2(y))./(1+a*w*abs(H.mtf).^2)));
+end
+
+%% Without / with precomputation
+for prec=[false true]
+    F.doPrecomputation=prec;
+    err=0;
+    for k=1:length(alphas)
+        p=F.applyProx(x,alphas(k));
+        err=max(err,max(abs(p(:)-ref{k}(:)))/max(abs(ref{k}(:))));
+    end
+    disp(['doPrecomputation=',num2str(prec),' max relative error : ',num2str(err)]);
+    assert(err<1e-10,'Prox of CostL2Composition with LinOpConv is inaccurate');
+end
@@ -42,6 +42,7 @@ classdef LinOpBroadcast <  LinOp
         ndms   % number of dimensions of the input
         kerdims % ker dimensions
         imdims % im dimensions
+        useMex % true if the mex file sumDims is available
     end
     
     %% Constructor
@@ -86,6 +87,7 @@ classdef LinOpBroadcast <  LinOp
             this.imdims = this.sizeout;
             this.imdims(~T)=1;
             this.norm = prod(this.kerdims); % To be checked
+            this.useMex = (exist('sumDims')==3);
         end
     end
     
@@ -100,15 +102,23 @@ classdef LinOpBroadcast <  LinOp
         function y = applyAdjoint_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
             % $$\\mathrm{H} : \\mathrm{x} \\mapsto \\mathrm{y_k} = \\sum_l \\mathrm{x}_{k,l} $$
-            for n=this.index
-                x = sum(x,n);
+            %
+            % When the mex file sumDims is compiled (see buildReduction), all the
+            % broadcasted dimensions are summed in a single multithreaded pass.
+            if this.useMex && isMexCompatible(x,'complex')
+                x = sumDims(x,this.index);
+            else
+                for n=this.index
+                    x = sum(x,n);
+                end
             end
             y = reshape(x, this.sizein);
         end
         function y = applyHtH_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            a = prod(this.kerdims);
-            y = x.*a;
+            % $$\\mathrm{H}^*\\mathrm{H} = \\prod_l n_l \\, \\mathrm{I}$$
+            % (the broadcasted array is never formed)
+            y = x.*prod(this.kerdims);
         end
         
         function M = makeAdjoint_(this)
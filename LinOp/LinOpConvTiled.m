@@ -0,0 +1,188 @@
+classdef LinOpConvTiled <  LinOp
+    % LinOpConvTiled: Convolution operator evaluated tile by tile (overlap-save)
+    %
+    % :param psf: centered Point Spread Function with a compact support (the center is at floor(size(psf)/2)+1)
+    % :param sz: input size
+    % :param tileSize: size of the output tiles (default min(sz,128))
+    % :param isReal: if true (default) the result of the convolution should be real
+    %
+    % All attributes of parent class :class:`LinOp` are inherited.
+    %
+    % **Note** The output is partitioned into tiles of size tileSize.
+    % Each tile is computed from the corresponding block of the input
+    % extended by a PSF-sized halo, with FFTs of size tileSize+size(psf)-1,
+    % and only the part of the block result which is not affected by
+    % the circular wrap-around is kept (overlap-save). The halos are
+    % taken periodically at the borders of the volume, such that the
+    % operator is the same as the (circular) :class:`LinOpConv` with the
+    % PSF padded to sz. Neither the volume nor its MTF is transformed as
+    % a whole: the memory needed beyond the input and output is a few
+    % tile-sized arrays per worker, and the tiles are independent:
+    % setting the property numWorkers to a positive value distributes
+    % them among the workers of the current parallel pool when it is
+    % thread-based (parfor, see threadWorkers), which share the input.
+    %
+    % **Example** H=LinOpConvTiled(psf,sz,tileSize,isReal)
+    %
+    % See also :class:`LinOp`, :class:`LinOpConv`, :func:`deconvTiled`
+
+    %%    Copyright (C) 2026 GlobalBioIm developers
+    %
+    %     This program is free software: you can redistribute it and/or modify
+    %     it under the terms of the GNU General Public License as published by
+    %     the Free Software Foundation, either version 3 of the License, or
+    %     (at your option) any later version.
+    %
+    %     This program is distributed in the hope that it will be useful,
+    %     but WITHOUT ANY WARRANTY; without even the implied warranty of
+    %     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    %     GNU General Public License for more details.
+    %
+    %     You should have received a copy of the GNU General Public License
+    %     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    properties (SetAccess = protected,GetAccess = public)
+        psf;       % centered PSF
+        tileSize;  % size of the output tiles
+        isReal;    % true (default) if the result of the convolution should be real
+        mtfTile;   % Fourier transform of the PSF on the grid of a tile and its halo (size tileSize+size(psf)-1)
+        tileStart; % cell containing the first index of the tiles along each dimension
+    end
+    properties
+        numWorkers=0; % maximum number of workers processing the tiles in parallel (thread-based pool only, 0: sequential)
+    end
+
+    %% Constructor
+    methods
+        function this = LinOpConvTiled(psf,sz,tileSize,isReal)
+            if nargin<3 || isempty(tileSize), tileSize=min(sz,128); end
+            if nargin<4 || isempty(isReal), isReal=true; end
+            nd=length(sz);
+            psz=size(psf); psz(end+1:nd)=1;
+            assert(length(psz)==nd,'The PSF must not have more dimensions than the input size');
+            assert(all(psz<=sz),['The input size [',num2str(sz),'] must be larger than the size of the PSF [',num2str(psz),']']);
+            if isscalar(tileSize), tileSize=tileSize*ones(1,nd); end
+            assert(length(tileSize)==nd,'Parameters tileSize and sz must have the same length');
+            this.name ='LinOpConvTiled';
+            this.isInvertible=false;
+            this.isDifferentiable=true;
+            this.psf=psf;
+            this.isReal=isReal;
+            this.sizein=sz;
+            this.sizeout=sz;
+            this.tileSize=min(tileSize,sz);
+
+            % Tiles (the last one along each dimension ends at the border of
+            % the volume and overlaps the previous one)
+            this.tileStart=cell(1,nd);
+            for d=1:nd
+                this.tileStart{d}=unique([1:this.tileSize(d):sz(d)-this.tileSize(d)+1,sz(d)-this.tileSize(d)+1]);
+            end
+
+            % MTF on the grid of a tile with its halo
+            k=zeros(this.tileSize+psz-1,'like',psf);
+            idx=arrayfun(@(n) 1:n,psz,'UniformOutput',false);
+            k(idx{:})=psf;
+            this.mtfTile=fftn(circshift(k,-floor(psz/2)));
+        end
+    end
+
+    %% Core Methods containing implementations (Protected)
+    methods (Access = protected)
+        function y = apply_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            psz=size(this.psf); psz(end+1:length(this.sizein))=1;
+            y = this.convTiles(x,this.mtfTile,psz-floor(psz/2)-1);
+        end
+        function y = applyAdjoint_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            psz=size(this.psf); psz(end+1:length(this.sizein))=1;
+            y = this.convTiles(x,conj(this.mtfTile),floor(psz/2));
+        end
+        function M = makeAdjoint_(this)
+            % Reimplemented from parent class :class:`LinOp`.
+            nd=length(this.sizein);
+            psfAdj=conj(this.psf);
+            for d=1:nd
+                psfAdj=flip(psfAdj,d);
+            end
+            % Flipping moves the center by one sample along the dimensions of even size
+            psz=size(psfAdj); psz(end+1:nd)=1;
+            psfAdj=padarray(psfAdj,double(mod(psz,2)==0),0,'pre');
+            M=LinOpConvTiled(psfAdj,this.sizein,this.tileSize,this.isReal);
+            M.numWorkers=this.numWorkers;
+        end
+        function nrm = normBound_(this)
+            % Reimplemented from parent class :class:`Map`: \\(\\|\\mathrm{h}\\|_1\\),
+            % which is the norm when the PSF is nonnegative.
+            nrm=sum(abs(this.psf(:)));
+        end
+    end
+
+    %% Utility methods
+    % - convTiles(this,x,mtf,haloBefore)
+    % - convBlock(xb,mtf,crop,keepReal)
+    methods (Access = protected)
+        function y = convTiles(this,x,mtf,haloBefore)
+            % Convolution of x with the kernel of Fourier transform mtf
+            % (tile grid), the input blocks starting haloBefore samples
+            % before their tile. The blocks are extracted and their
+            % cropped results written into y tile by tile (by batches of
+            % tiles on a thread-based pool), such that only a few
+            % tile-sized arrays exist at once.
+            sz=this.sizein; T=this.tileSize; L=size(mtf); L(end+1:length(sz))=1;
+            nd=length(sz);
+            nTiles=cellfun(@numel,this.tileStart);
+            nt=prod(nTiles);
+            % Input (halos taken periodically) and output indices
+            inIdx=cell(nt,1); outIdx=cell(nt,1);
+            sub=cell(1,nd);
+            for t=1:nt
+                [sub{:}]=ind2sub([nTiles 1],t);
+                inIdx{t}=cell(1,nd); outIdx{t}=cell(1,nd);
+                for d=1:nd
+                    a=this.tileStart{d}(sub{d});
+                    inIdx{t}{d}=mod((a-haloBefore(d)-1):(a-haloBefore(d)+L(d)-2),sz(d))+1;
+                    outIdx{t}{d}=a:a+T(d)-1;
+                end
+            end
+            keepReal=this.isReal && isreal(x);
+            crop=arrayfun(@(h,n) h+(1:n),haloBefore,T,'UniformOutput',false);
+            if keepReal
+                y=zeros(sz,'like',x);
+            else
+                y=complex(zeros(sz,'like',x));
+            end
+            nw=threadWorkers(this.numWorkers);
+            if nw==0
+                for t=1:nt
+                    y(outIdx{t}{:})=LinOpConvTiled.convBlock(x(inIdx{t}{:}),mtf,crop,keepReal);
+                end
+            else
+                % x is a broadcast variable (shared by the threads)
+                nb=4*nw;
+                for t0=1:nb:nt
+                    tb=t0:min(t0+nb-1,nt);
+                    idx=inIdx(tb);
+                    yb=cell(1,length(tb));
+                    parfor (k=1:length(tb),nw)
+                        yb{k}=LinOpConvTiled.convBlock(x(idx{k}{:}),mtf,crop,keepReal);
+                    end
+                    for k=1:length(tb)
+                        y(outIdx{tb(k)}{:})=yb{k};
+                    end
+                end
+            end
+        end
+    end
+    methods (Static, Access = protected)
+        function yb = convBlock(xb,mtf,crop,keepReal)
+            % Cropped circular convolution of the block xb (overlap-save)
+            yb=ifftn(mtf.*fftn(xb));
+            if keepReal
+                yb=real(yb);
+            end
+            yb=yb(crop{:});
+        end
+    end
+end
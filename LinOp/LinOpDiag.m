@@ -56,6 +56,7 @@ classdef LinOpDiag <  LinOp
             this.sizeout=sz;
             this.sizein=sz;
             this.isDifferentiable=true;
+            this.isElementWise=true;
             if sum(diag(:)==0)==0
                 this.isInvertible=true;
             else
@@ -90,6 +91,13 @@ classdef LinOpDiag <  LinOp
                  x=conj(this.diag).*x;
              end
         end
+        function [x,d] = applyElementWise_(this,x)
+            % Reimplemented from parent class :class:`Map`.
+            x=this.apply_(x);
+            if nargout>1
+                d=conj(this.diag);
+            end
+        end
         function x = applyHtH_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
             if verLessThan('matlab', '9.1')
@@ -6,11 +6,20 @@ classdef LinOpDico <  LinOp
     % used to index the different atoms).
     %
     % :param D: dictionary.
+    % :param nbVec: number of coefficient vectors processed at once (default 1). The
+    %               input is then of size [1,...,1,nbA,nbVec] and the output of size [szA,nbVec].
     %
     % All attributes of parent class :class:`LinOp` are inherited. 
     %
+    % The dictionary is seen as a dense numelAtom x nbA matrix such that the synthesis and the
+    % analysis are matrix products (BLAS GEMV, or GEMM for nbVec>1) which never form the
+    % broadcast product of D with the coefficients. When nbA<=numelAtom, :meth:`applyHtH`
+    % uses the Gram matrix \\(\\mathrm{D^TD}\\) (nbA x nbA), computed at the first call.
+    %
     % **Example** Dico=LinOpDico(D) 
     %
+    % **Example** Dico=LinOpDico(D,nbVec) 
+    %
     % See also :class:`LinOp`, :class:`Map`
     
     %%    Copyright (C) 
@@ -33,20 +42,35 @@ classdef LinOpDico <  LinOp
        D;         % Dictionnary
        ndms;      % number of dimensions of the dico
        numelAtom; % number of elements in one atom
+       nbVec=1;   % number of coefficient vectors processed at once
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+       Dm;        % dictionary as a numelAtom x nbA matrix (shares the data of D)
+       DtD=[];    % Gram matrix, computed at the first call to applyHtH
     end
     
     %% Constructor
     methods
-        function this = LinOpDico(D) 
+        function this = LinOpDico(D,nbVec) 
             this.name ='LinOpDico';   
+            if nargin==2 && ~isempty(nbVec)
+                assert(isscalar(nbVec) && nbVec>=1,'nbVec must be a positive integer');
+                this.nbVec=nbVec;
+            end
             sz=size(D);
             this.ndms=length(sz);
-            this.sizein=[ones(1,this.ndms-1),sz(end)]; 
-            this.sizeout = sz(1:end-1);   
-            this.numelAtom=prod(this.sizeout);
+            this.numelAtom=prod(sz(1:end-1));
+            if this.nbVec==1
+                this.sizein=[ones(1,this.ndms-1),sz(end)]; 
+                this.sizeout = sz(1:end-1);   
+            else
+                this.sizein=[ones(1,this.ndms-1),sz(end),this.nbVec]; 
+                this.sizeout = [sz(1:end-1),this.nbVec];   
+            end
             % Note: actually this operator can be invertible for some given
             % dictionnary D, but the inverse is not implemented 
             this.D=D;
+            this.Dm=reshape(D,[this.numelAtom,sz(end)]);
             this.isDifferentiable=true;
             if this.numelAtom<1000 && sz(end)<1000  % the norm is computed if the dictionary is of reasonable size
                 this.norm=norm(reshape(this.D,[this.numelAtom,sz(end)]));
@@ -56,20 +80,27 @@ classdef LinOpDico <  LinOp
 	
     %% Core Methods containing implementations (Protected)
 	methods (Access = protected)
-        %todo: size problem here?
         function y = apply_(this,x)   
             % Reimplemented from parent class :class:`LinOp`.
-            if cmpSize(size(x),this.sizein)
-                y=sum(bsxfun(@times,this.D,x),3);
-            else
-                assert(isvector(x) && this.sizein(end)==length(x),'x must be a vector of size the number of dictionnary atoms');
-                y=sum(bsxfun(@times,this.D,reshape(x,this.sizein)),3);
-            end
+            assert(numel(x)==size(this.Dm,2)*this.nbVec,'x must be a vector of size the number of dictionnary atoms');
+            y=reshape(this.Dm*reshape(x,[size(this.Dm,2),this.nbVec]),this.sizeout);
         end		
         function y = applyAdjoint_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            y=sum(reshape(bsxfun(@times,this.D,x),[this.numelAtom,ones_(this.ndms-2),this.sizein(end)]),1);
-            y=y(:);
+            y=reshape(this.Dm'*reshape(x,[this.numelAtom,this.nbVec]),this.sizein);
+        end
+        function y = applyHtH_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            % Uses the Gram matrix when it is smaller than the dictionary.
+            nbA=size(this.Dm,2);
+            if nbA<=this.numelAtom
+                if isempty(this.DtD)
+                    this.DtD=this.Dm'*this.Dm;
+                end
+                y=reshape(this.DtD*reshape(x,[nbA,this.nbVec]),this.sizein);
+            else
+                y=reshape(this.Dm'*(this.Dm*reshape(x,[nbA,this.nbVec])),this.sizein);
+            end
         end
     end
 end
\ No newline at end of file
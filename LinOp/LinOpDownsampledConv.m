@@ -0,0 +1,161 @@
+classdef LinOpDownsampledConv <  LinOp
+    % LinOpDownsampledConv: Convolution followed by a downsampling
+    % $$\\mathrm{H} = \\mathrm{SC} $$
+    % where \\(\\mathrm{C}\\) is a convolution (see :class:`LinOpConv`) and
+    % \\(\\mathrm{S}\\) a downsampling (see :class:`LinOpDownsample`).
+    %
+    % :param mtf: Fourier transform of Point Spread Function (size of the high resolution grid)
+    % :param df: array containing the downsampling factor in each direction
+    % :param first: array containing the index of the first retained element in each direction (default 1)
+    % :param isReal: if true (default) the result of the convolution should be real
+    %
+    % All attributes of parent class :class:`LinOp` are inherited.
+    %
+    % **Note** Only the retained samples are evaluated, using the
+    % polyphase decomposition of the composition in the Fourier domain:
+    % the spectrum of the downsampled output is the sum of the
+    % \\(\\prod_k d_k\\) aliased bands of \\(\\hat{\\mathrm{h}}\\hat{\\mathrm{x}}\\)
+    % $$ \\widehat{\\mathrm{Hx}}_m = \\frac{1}{\\prod_k d_k} \\sum_p \\hat{\\mathrm{h}}_{m+pM}\\, e^{2i\\pi (m+pM) f/N}\\, \\hat{\\mathrm{x}}_{m+pM},$$
+    % (see :class:`LinOpSumPatches`), so that the inverse transform of
+    % apply and the forward transform of the adjoint are performed on the
+    % low resolution grid. The operator is also instantiated
+    % automatically when a :class:`LinOpDownsample` is composed with a
+    % :class:`LinOpConv` acting on all dimensions.
+    %
+    % **Example** H=LinOpDownsampledConv(mtf,df,first,isReal)
+    %
+    % See also :class:`LinOp`, :class:`LinOpConv`, :class:`LinOpDownsample`,
+    % :class:`LinOpSumPatches`
+
+    %%    Copyright (C) 2026 GlobalBioIm developers
+    %
+    %     This program is free software: you can redistribute it and/or modify
+    %     it under the terms of the GNU General Public License as published by
+    %     the Free Software Foundation, either version 3 of the License, or
+    %     (at your option) any later version.
+    %
+    %     This program is distributed in the hope that it will be useful,
+    %     but WITHOUT ANY WARRANTY; without even the implied warranty of
+    %     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    %     GNU General Public License for more details.
+    %
+    %     You should have received a copy of the GNU General Public License
+    %     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    properties (SetAccess = protected,GetAccess = public)
+        mtf;       % Fourier transform of the PSF (high resolution grid)
+        df;        % downsampling factors in each direction
+        first;     % first retained element in each direction
+        isReal;    % true (default) if the result of the convolution should be real
+        mtfShift;  % mtf multiplied by the phase ramp corresponding to first
+        aliasMtf2; % sum of the aliased bands of abs(mtf).^2 (low resolution grid)
+        OpSumP;    % LinOpSumPatches summing the aliased bands
+    end
+
+    %% Constructor
+    methods
+        function this = LinOpDownsampledConv(mtf,df,first,isReal)
+            if nargin<3 || isempty(first), first=ones(size(df)); end
+            if nargin<4 || isempty(isReal), isReal=true; end
+            sz=size(mtf);
+            assert(cmpSize(size(sz),size(df)),'Parameters size(mtf) and df must have the same size');
+            assert(cmpSize(size(first),size(df)),'Parameters first and df must have the same size');
+            assert(~any(mod(sz,df)),'Sizes of mtf must be multiples of downsampling factors in df');
+            this.name ='LinOpDownsampledConv';
+            this.isInvertible=false;
+            this.isDifferentiable=true;
+            this.mtf=mtf;
+            this.df=df;
+            this.first=first;
+            this.isReal=isReal;
+            this.sizein=sz;
+            this.sizeout=sz./df;
+            this.OpSumP=LinOpSumPatches(this.sizein,this.sizeout);
+
+            % Phase ramp accounting for the first retained sample
+            this.mtfShift=this.mtf;
+            for n=1:length(sz)
+                if this.first(n)~=1
+                    shp=ones(1,max(length(sz),2));shp(n)=sz(n);
+                    ph=reshape(exp(2i*pi*(0:sz(n)-1)*(this.first(n)-1)/sz(n)),shp);
+                    this.mtfShift=bsxfun(@times,this.mtfShift,ph);
+                end
+            end
+            this.aliasMtf2=this.OpSumP*(abs(this.mtf).^2);
+
+            % -- Norm of the operator
+            this.norm=sqrt(max(this.aliasMtf2(:))/prod(this.df));
+        end
+    end
+
+    %% Core Methods containing implementations (Protected)
+    methods (Access = protected)
+        function y = apply_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            y = ifftn(this.OpSumP*(this.mtfShift.*fftn(x)))/prod(this.df);
+            if this.isReal && isreal(x)
+                y = real(y);
+            end
+        end
+        function y = applyAdjoint_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            y = ifftn(conj(this.mtfShift).*this.OpSumP.applyAdjoint(fftn(x)));
+            if this.isReal && isreal(x)
+                y = real(y);
+            end
+        end
+        function y = applyHtH_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            y = ifftn(conj(this.mtfShift).*this.OpSumP.applyAdjoint(this.OpSumP*(this.mtfShift.*fftn(x))))/prod(this.df);
+            if this.isReal && isreal(x)
+                y = real(y);
+            end
+        end
+        function y = applyHHt_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            y = ifftn(this.aliasMtf2.*fftn(x))/prod(this.df);
+            if this.isReal && isreal(x)
+                y = real(y);
+            end
+        end
+        function M = makeHHt_(this)
+            % Reimplemented from parent class :class:`LinOp`.
+            M=LinOpConv(this.aliasMtf2/prod(this.df),this.isReal);
+        end
+    end
+
+    %% Utility methods
+    % - applyHtHShiftedInverse(this,x,gamma)
+    methods
+        function y = applyHtHShiftedInverse(this,x,gamma)
+            % Computes \\(\\mathrm{y} = (\\mathrm{H}^{\\star}\\mathrm{H} + \\gamma \\mathrm{I})^{-1} \\mathrm{x}\\)
+            % using the Woodbury formula [1,2]. The low resolution denominator
+            % \\(\\gamma\\prod_k d_k + \\sum_p |\\hat{\\mathrm{h}}_{m+pM}|^2\\) is
+            % cached for the last value of \\(\\gamma\\).
+            %
+            % [1] Zhao Ningning et al. "Fast Single Image Super-Resolution Using a New Analytical Solution for l2-l2 Problems".
+            % IEEE Transactions on Image Processing, 25(8), 3683-3697 (2016).
+            %
+            % [2] Emmanuel Soubies and Michael Unser. "Computational Super-Sectioning for Single-Slice
+            % Structured-Illumination Microscopy" (2018)
+            assert(isPositiveScalar(gamma),'gamma must be a positive scalar');
+            if ~isfield(this.precomputeCache,'shiftGamma') || this.precomputeCache.shiftGamma~=gamma
+                this.precomputeCache.shiftDenom=gamma*prod(this.df)+this.aliasMtf2;
+                this.precomputeCache.shiftGamma=gamma;
+            end
+            fx=fftn(x);
+            y=ifftn(fx - conj(this.mtfShift).*this.OpSumP.applyAdjoint((this.OpSumP*(this.mtfShift.*fx))./this.precomputeCache.shiftDenom))/gamma;
+            if this.isReal && isreal(x)
+                y = real(y);
+            end
+        end
+    end
+
+    methods (Access = protected)
+        %% Copy
+        function this = copyElement(obj)
+            this = copyElement@LinOp(obj);
+            this.OpSumP = copy(obj.OpSumP);
+        end
+    end
+end
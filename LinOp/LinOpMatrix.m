@@ -5,11 +5,24 @@ classdef LinOpMatrix <  LinOp
     %
     % :param M: matrix
     % :param index: 
+    % :param valClass: class of the values of a sparse M in the mex row storage, 'double' (default)
+    %                  or 'single' (see below, forward product only)
     %
     % All attributes of parent class :class:`LinOp` are inherited. 
     %
+    % When M is a real sparse double matrix and the mex file sparseMV is compiled (see buildSparse), the
+    % compressed row storage of M (int32 indices when possible) is built once in the constructor,
+    % and :meth:`apply`, :meth:`applyAdjoint` and :meth:`applyHtH` are computed by multithreaded
+    % sparse products, the adjoint ones reading the column storage of M itself. The adjoint is then
+    % as fast as the direct product and \\(\\mathrm{M}^T\\) is never formed; the row storage adds
+    % 8 (single values) or 12 bytes per nonzero to the 16 bytes of M. valClass='single' thus applies
+    % only to the products with the row storage (:meth:`apply` and the first product of
+    % :meth:`applyHtH`), the adjoint products using the double values of M.
+    %
     % **Example** H=LinOpMatrix(M,index)
     %
+    % **Example** H=LinOpMatrix(M,index,'single')
+    %
     % See also :class:`LinOp`, :class:`Map`
      
     %%    Copyright (C) 2015 
@@ -36,10 +49,14 @@ classdef LinOpMatrix <  LinOp
         rightsz
         leftsz
     end
+    properties (SetAccess = protected,GetAccess = protected)
+        Sp=[];    % CSR storage of a sparse M (see sparseMV)
+        useMex=false;
+    end
     
     %% Constructor
     methods
-        function this = LinOpMatrix(M,index)
+        function this = LinOpMatrix(M,index,valClass)
             this.name='LinOpMatrix';
             this.M = M;
             this.sz = size(M);
@@ -52,6 +69,10 @@ classdef LinOpMatrix <  LinOp
             if nargin == 1
                 index = [];
             end
+            if nargin < 3
+                valClass = 'double';
+            end
+            assert(any(strcmp(valClass,{'double','single'})),'The third argument should be ''double'' or ''single''');
             if (~isempty(index))
                 assert(isvector(index) && length(index)<= this.ndms && max(index)<= this.ndms,'The index should be a conformable  to the size of M');
                 this.index = index;
@@ -82,18 +103,62 @@ classdef LinOpMatrix <  LinOp
             this.leftsz = prod(this.sizeout);
             this.M= reshape(M,this.leftsz,this.rightsz);  
             this.isDifferentiable=true;
+            % -- Native sparse storages, built once
+            if issparse(this.M) && isa(this.M,'double') && isreal(this.M) && exist('sparseMV')==3
+                this.Sp=sparseMV('build',this.M,valClass);
+                this.useMex=true;
+            end
         end
     end
     
     %% Core Methods containing implementations (Protected)
+    % - apply_(this,x)
+    % - applyAdjoint_(this,x)
+    % - applyHtH_(this,x)
     methods (Access = protected)
         function y = apply_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            y = reshape(this.M * reshape(x,[this.rightsz,1]),this.sizeout);
+            if this.useMex && isMexCompatible(x,'complex')
+                y = reshape(this.sparseProduct('apply',x),this.sizeout);
+            else
+                y = reshape(this.M * reshape(x,[this.rightsz,1]),this.sizeout);
+            end
         end       
         function y = applyAdjoint_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            y = reshape(this.M' * reshape(x,[this.leftsz,1]),this.sizein);
+            if this.useMex && isMexCompatible(x,'complex')
+                y = reshape(this.sparseProduct('adjoint',x),this.sizein);
+            else
+                y = reshape(this.M' * reshape(x,[this.leftsz,1]),this.sizein);
+            end
+        end
+        function y = applyHtH_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            % With the mex file sparseMV, \\(\\mathrm{M}^T\\mathrm{Mx}\\) is computed in a single call.
+            if this.useMex && isMexCompatible(x,'complex')
+                y = reshape(this.sparseProduct('hth',x),this.sizein);
+            else
+                y = reshape(this.M' * (this.M * reshape(x,[this.rightsz,1])),this.sizein);
+            end
+        end
+    end
+    
+    %% Utility methods
+    % - sparseProduct(this,cmd,x)
+    methods (Access = protected)
+        function y = sparseProduct(this,cmd,x)
+            % Product cmd ('apply', 'adjoint' or 'hth') with the mex file sparseMV
+            % (real and imaginary parts of a complex x are processed separately)
+            switch cmd
+                case 'apply', f = @(v) sparseMV(cmd,this.Sp,v);
+                case 'adjoint', f = @(v) sparseMV(cmd,this.M,v);
+                otherwise, f = @(v) sparseMV(cmd,this.Sp,v,this.M);
+            end
+            if isreal(x)
+                y = f(x);
+            else
+                y = complex(f(real(x)),f(imag(x)));
+            end
         end
     end
 end
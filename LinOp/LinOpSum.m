@@ -39,6 +39,7 @@ classdef LinOpSum <  LinOp
         ndms   % number of dimensions of the input
         kerdims % ker dimensions
         imdims % im dimensions
+        useMex % true if the mex file sumDims is available
     end
     
     %% Constructor
@@ -85,6 +86,7 @@ classdef LinOpSum <  LinOp
             this.imdims(~T)=1;
             
             this.norm=sqrt(prod(this.sizein(this.index)));
+            this.useMex = (exist('sumDims')==3);
             
         end
     end
@@ -93,8 +95,15 @@ classdef LinOpSum <  LinOp
     methods (Access = protected)
         function y = apply_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            for n=this.index
-                x = sum(x,n);
+            %
+            % When the mex file sumDims is compiled (see buildReduction), all the
+            % summed dimensions are reduced in a single multithreaded pass.
+            if this.useMex && isMexCompatible(x,'complex')
+                x = sumDims(x,this.index);
+            else
+                for n=this.index
+                    x = sum(x,n);
+                end
             end
             y = reshape(squeeze(x),this.sizeout);
         end
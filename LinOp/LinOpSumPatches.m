@@ -7,6 +7,11 @@ classdef LinOpSumPatches <  LinOp
     % 
     % All attributes of parent class :class:`LinOp` are inherited. 
     %
+    % **Note** When the mex files sumPatches and broadcastPatches are
+    % compiled (see buildPatches), the apply and adjoint are computed in place
+    % by multithreaded kernels (double/single inputs on CPU). Otherwise a
+    % Matlab implementation based on reshape/sum is used.
+    %
     % **Example** S=LinOpSumPatches(sz,szPatches)
     %
     % See also :class:`LinOp`, :class:`Map`
@@ -29,7 +34,8 @@ classdef LinOpSumPatches <  LinOp
     
     properties (SetAccess = protected,GetAccess = public)
         szPatch    % array containing the patch size in each direction
-        sel;
+        nPatch;    % number of patches in each direction
+        useMex;    % true if the mex files sumPatches/broadcastPatches are available
     end
     
     %% Constructor
@@ -41,9 +47,8 @@ classdef LinOpSumPatches <  LinOp
             this.sizein=sz;
             this.szPatch=szPatch;
             this.sizeout=this.szPatch;           
-            for n=1:length(this.sizein)
-                this.sel{n}=this.szPatch(n)*ones(1,this.sizein(n)/this.szPatch(n));
-            end
+            this.nPatch=this.sizein./this.szPatch;
+            this.useMex=(exist('sumPatches')==3) && (exist('broadcastPatches')==3);
 		end
     end
 	
@@ -51,15 +56,40 @@ classdef LinOpSumPatches <  LinOp
 	methods (Access = protected)
         function y = apply_(this,x)
             % Reimplemented from parent class :class:`LinOp`.  
-            y=zeros_(this.szPatch);
-            tmp=mat2cell(x,this.sel{:});
-            for n=1:numel(tmp)
-                y=y+tmp{n};
+            if this.canUseMex(x)
+                y=sumPatches(x,this.szPatch);
+            else
+                % View x as [p1 n1 p2 n2 ...] and sum over the patch indices
+                nd=length(this.szPatch);
+                y=reshape(x,reshape([this.szPatch;this.nPatch],1,[]));
+                for n=2:2:2*nd
+                    if this.nPatch(n/2)>1
+                        y=sum(y,n);
+                    end
+                end
+                y=reshape(y,this.szPatch);
             end
         end		
         function y = applyAdjoint_(this,x)
             % Reimplemented from parent class :class:`LinOp`.
-            y=repmat(x,this.sizein./this.szPatch);
+            if this.canUseMex(x)
+                y=broadcastPatches(x,this.sizein);
+            else
+                y=repmat(x,this.nPatch);
+            end
         end		
+        function y = applyHHt_(this,x)
+            % Reimplemented from parent class :class:`LinOp`.
+            y=prod(this.nPatch)*x;
+        end
+    end
+    
+    %% Utility methods
+    methods (Access = protected)
+        function b = canUseMex(this,x)
+            % True if the mex kernels can process x (double/single on CPU,
+            % complex inputs are handled by the kernels)
+            b=this.useMex && isMexCompatible(x,'complex');
+        end
     end
 end
\ No newline at end of file
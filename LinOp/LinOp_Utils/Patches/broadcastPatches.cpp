@@ -0,0 +1,121 @@
+#include <mex.h>
+#include <string.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  x = broadcastPatches(y,sz)
+
+  Adjoint of sumPatches. Let y be an N-D array such that sz is a multiple of
+  size(y) along each dimension. The present function returns the array x of
+  size sz obtained by tiling prod(sz./size(y)) copies of y, without forming
+  any intermediate array (this is repmat(y,sz./size(y))).
+
+  The output is written as contiguous runs of size(y,1) elements; patches
+  are distributed among threads so that each thread writes a disjoint part
+  of x.
+
+  Supported types: double and single, real or complex (the real and
+  imaginary parts are processed separately).
+
+  Compilation:
+     -linux: mex broadcastPatches.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildPatches.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define MAXDIM 32
+
+template <typename T>
+static void broadcastPatches(const T* y, T* x, int nd, const mwSize* sz, const mwSize* szp) {
+    mwSize stride[MAXDIM], npatch[MAXDIM];
+    mwSize nTiles=1, nRows=1, lenRow=szp[0];
+    stride[0]=1;
+    for (int d=0;d<nd;d++) {
+        if (d>0) stride[d]=stride[d-1]*sz[d-1];
+        npatch[d]=sz[d]/szp[d];
+        nTiles*=npatch[d];
+        if (d>0) nRows*=szp[d];
+    }
+
+    // Offsets in x of the first element of each patch and of each row within a patch
+    std::vector<mwSize> tileOff(nTiles), rowOff(nRows);
+    mwSize idx[MAXDIM];
+    memset(idx,0,sizeof(idx));
+    for (mwSize t=0;t<nTiles;t++) {
+        mwSize off=0;
+        for (int d=0;d<nd;d++) off+=idx[d]*szp[d]*stride[d];
+        tileOff[t]=off;
+        for (int d=0;d<nd && ++idx[d]==npatch[d];d++) idx[d]=0;
+    }
+    memset(idx,0,sizeof(idx));
+    for (mwSize r=0;r<nRows;r++) {
+        mwSize off=0;
+        for (int d=1;d<nd;d++) off+=idx[d]*stride[d];
+        rowOff[r]=off;
+        for (int d=1;d<nd && ++idx[d]==szp[d];d++) idx[d]=0;
+    }
+
+    // Parallelize over patches when there are enough of them, over rows otherwise
+    long t, r;
+    if (nTiles>=nRows) {
+        #pragma omp parallel for schedule(static) private(r)
+        for (t=0;t<(long)nTiles;t++)
+            for (r=0;r<(long)nRows;r++)
+                memcpy(x+tileOff[t]+rowOff[r],y+r*lenRow,lenRow*sizeof(T));
+    } else {
+        #pragma omp parallel for schedule(static) private(t)
+        for (r=0;r<(long)nRows;r++)
+            for (t=0;t<(long)nTiles;t++)
+                memcpy(x+tileOff[t]+rowOff[r],y+r*lenRow,lenRow*sizeof(T));
+    }
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("broadcastPatches");
+    if (nrhs!=2)
+        mexErrMsgTxt("Usage: x = broadcastPatches(y,sz).\n");
+    if (!(mxIsDouble(prhs[0]) || mxIsSingle(prhs[0])) || mxIsSparse(prhs[0]))
+        mexErrMsgTxt("The input should be a full double or single array.\n");
+
+    int ndy=mxGetNumberOfDimensions(prhs[0]);              // number of dimensions of the input (patch)
+    const mwSize *dimsy=mxGetDimensions(prhs[0]);          // dimension vector of the input
+    int nsz=mxGetNumberOfElements(prhs[1]);
+    double *s=mxGetPr(prhs[1]);
+    int nd=(nsz<ndy) ? ndy : nsz;
+    if (nd>MAXDIM)
+        mexErrMsgTxt("Too many dimensions.\n");
+
+    // Pad both sizes with singleton dimensions
+    mwSize sz[MAXDIM], szp[MAXDIM];
+    for (int d=0;d<nd;d++) {
+        szp[d]=(d<ndy) ? dimsy[d] : 1;
+        sz[d]=(d<nsz) ? (mwSize)s[d] : 1;
+        if (szp[d]==0 || sz[d]%szp[d]!=0)
+            mexErrMsgTxt("The output size should be a multiple of the size of the input.\n");
+    }
+
+    //Create output argument
+    plhs[0]=mxCreateNumericArray(nd, sz, mxGetClassID(prhs[0]), mxIsComplex(prhs[0]) ? mxCOMPLEX : mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    if (mxGetNumberOfElements(plhs[0])==0)
+        return;
+
+    if (mxIsDouble(prhs[0])) {
+        broadcastPatches<double>((const double*)mxGetData(prhs[0]),(double*)mxGetData(plhs[0]),nd,sz,szp);
+        if (mxIsComplex(prhs[0]))
+            broadcastPatches<double>((const double*)mxGetImagData(prhs[0]),(double*)mxGetImagData(plhs[0]),nd,sz,szp);
+    } else {
+        broadcastPatches<float>((const float*)mxGetData(prhs[0]),(float*)mxGetData(plhs[0]),nd,sz,szp);
+        if (mxIsComplex(prhs[0]))
+            broadcastPatches<float>((const float*)mxGetImagData(prhs[0]),(float*)mxGetImagData(plhs[0]),nd,sz,szp);
+    }
+}
@@ -0,0 +1,20 @@
+% function x=broadcastPatches(y,sz)
+%
+%  Tiles the patch y to build an array x of size sz (sz must be a multiple
+%  of size(y) along each dimension), i.e. x=repmat(y,sz./size(y)). Mex
+%  implementation of the applyAdjoint method of LinOpSumPatches.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
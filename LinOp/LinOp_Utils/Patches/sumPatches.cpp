@@ -0,0 +1,159 @@
+#include <mex.h>
+#include <string.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  y = sumPatches(x,szPatch)
+
+  Let x be an N-D array whose size sz is a multiple of szPatch along each
+  dimension. The present function splits x into the prod(sz./szPatch)
+  non-overlapping patches of size szPatch and returns their sum y (of size
+  szPatch). The input is read in place: no patch is ever copied.
+
+  The output is cut into "rows", i.e. the contiguous runs of szPatch(1)
+  elements along the first dimension. When there are enough rows, each
+  thread owns a disjoint set of rows of y and accumulates all the patches
+  into them. Otherwise (e.g. vectors or patches with very few rows), each
+  thread accumulates a subset of the patches into a private buffer and the
+  buffers are reduced in a second parallel pass.
+
+  Supported types: double and single, real or complex (the real and
+  imaginary parts are processed separately).
+
+  Compilation:
+     -linux: mex sumPatches.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildPatches.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define MAXDIM 32
+
+template <typename T>
+static void sumPatches(const T* x, T* y, int nd, const mwSize* sz, const mwSize* szp) {
+    mwSize stride[MAXDIM], npatch[MAXDIM];
+    mwSize nTiles=1, nRows=1, lenRow=szp[0], numel_y;
+    stride[0]=1;
+    for (int d=0;d<nd;d++) {
+        if (d>0) stride[d]=stride[d-1]*sz[d-1];
+        npatch[d]=sz[d]/szp[d];
+        nTiles*=npatch[d];
+        if (d>0) nRows*=szp[d];
+    }
+    numel_y=nRows*lenRow;
+
+    // Offsets in x of the first element of each patch and of each row within a patch
+    std::vector<mwSize> tileOff(nTiles), rowOff(nRows);
+    mwSize idx[MAXDIM];
+    memset(idx,0,sizeof(idx));
+    for (mwSize t=0;t<nTiles;t++) {
+        mwSize off=0;
+        for (int d=0;d<nd;d++) off+=idx[d]*szp[d]*stride[d];
+        tileOff[t]=off;
+        for (int d=0;d<nd && ++idx[d]==npatch[d];d++) idx[d]=0;
+    }
+    memset(idx,0,sizeof(idx));
+    for (mwSize r=0;r<nRows;r++) {
+        mwSize off=0;
+        for (int d=1;d<nd;d++) off+=idx[d]*stride[d];
+        rowOff[r]=off;
+        for (int d=1;d<nd && ++idx[d]==szp[d];d++) idx[d]=0;
+    }
+
+    int nthreads=1;
+    #ifdef _OPENMP
+    nthreads=omp_get_max_threads();
+    #endif
+
+    if (nRows>=(mwSize)(4*nthreads) || nthreads==1) {
+        // Each thread owns a disjoint set of output rows
+        long r;
+        #pragma omp parallel for schedule(static)
+        for (r=0;r<(long)nRows;r++) {
+            T* yr=y+r*lenRow;
+            for (mwSize t=0;t<nTiles;t++) {
+                const T* xr=x+tileOff[t]+rowOff[r];
+                for (mwSize i=0;i<lenRow;i++)
+                    yr[i]+=xr[i];
+            }
+        }
+    } else {
+        // Few rows: private accumulators over disjoint sets of patches, then reduction
+        std::vector<T> buf((mwSize)nthreads*numel_y,(T)0);
+        #pragma omp parallel
+        {
+            int tid=0;
+            #ifdef _OPENMP
+            tid=omp_get_thread_num();
+            #endif
+            T* acc=&buf[(mwSize)tid*numel_y];
+            long t;
+            #pragma omp for schedule(static)
+            for (t=0;t<(long)nTiles;t++) {
+                for (mwSize r=0;r<nRows;r++) {
+                    const T* xr=x+tileOff[t]+rowOff[r];
+                    T* ar=acc+r*lenRow;
+                    for (mwSize i=0;i<lenRow;i++)
+                        ar[i]+=xr[i];
+                }
+            }
+            long k;
+            #pragma omp for schedule(static)
+            for (k=0;k<(long)numel_y;k++) {
+                T s=0;
+                for (int n=0;n<nthreads;n++)
+                    s+=buf[(mwSize)n*numel_y+k];
+                y[k]=s;
+            }
+        }
+    }
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("sumPatches");
+    if (nrhs!=2)
+        mexErrMsgTxt("Usage: y = sumPatches(x,szPatch).\n");
+    if (!(mxIsDouble(prhs[0]) || mxIsSingle(prhs[0])) || mxIsSparse(prhs[0]))
+        mexErrMsgTxt("The input should be a full double or single array.\n");
+
+    int ndx=mxGetNumberOfDimensions(prhs[0]);              // number of dimensions of the input
+    const mwSize *dimsx=mxGetDimensions(prhs[0]);          // dimension vector of the input
+    int nd=mxGetNumberOfElements(prhs[1]);                 // number of dimensions of the patches
+    double *p=mxGetPr(prhs[1]);
+    if (nd<ndx) nd=ndx;
+    if (nd>MAXDIM)
+        mexErrMsgTxt("Too many dimensions.\n");
+
+    // Pad both sizes with singleton dimensions
+    mwSize sz[MAXDIM], szp[MAXDIM];
+    for (int d=0;d<nd;d++) {
+        sz[d]=(d<ndx) ? dimsx[d] : 1;
+        szp[d]=(d<(int)mxGetNumberOfElements(prhs[1])) ? (mwSize)p[d] : 1;
+        if (szp[d]==0 || sz[d]%szp[d]!=0)
+            mexErrMsgTxt("The size of the input should be a multiple of the patch size.\n");
+    }
+
+    //Create output argument (initialized to zero)
+    plhs[0]=mxCreateNumericArray(nd, szp, mxGetClassID(prhs[0]), mxIsComplex(prhs[0]) ? mxCOMPLEX : mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    if (mxGetNumberOfElements(prhs[0])==0)
+        return;
+
+    if (mxIsDouble(prhs[0])) {
+        sumPatches<double>((const double*)mxGetData(prhs[0]),(double*)mxGetData(plhs[0]),nd,sz,szp);
+        if (mxIsComplex(prhs[0]))
+            sumPatches<double>((const double*)mxGetImagData(prhs[0]),(double*)mxGetImagData(plhs[0]),nd,sz,szp);
+    } else {
+        sumPatches<float>((const float*)mxGetData(prhs[0]),(float*)mxGetData(plhs[0]),nd,sz,szp);
+        if (mxIsComplex(prhs[0]))
+            sumPatches<float>((const float*)mxGetImagData(prhs[0]),(float*)mxGetImagData(plhs[0]),nd,sz,szp);
+    }
+}
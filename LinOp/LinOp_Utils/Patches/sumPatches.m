@@ -0,0 +1,21 @@
+% function y=sumPatches(x,szPatch)
+%
+%  Let x be an N-D array whose size is a multiple of szPatch along each
+%  dimension. The present function returns the sum y (of size szPatch) of
+%  the non-overlapping patches of x. Mex implementation of the apply method
+%  of LinOpSumPatches: x is read in place, no patch is copied.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
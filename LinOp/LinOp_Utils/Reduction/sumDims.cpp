@@ -0,0 +1,230 @@
+#include <mex.h>
+#include <string.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  y = sumDims(x,dims)
+
+  Sums the N-D array x over all the dimensions listed in dims in a single
+  pass (the summed dimensions are kept as singletons, as with sum(x,n)). It
+  is equivalent to
+       for n=dims, x=sum(x,n); end
+  without the intermediate arrays created by successive calls to sum.
+
+  Adjacent dimensions which are both summed (or both kept) are first merged
+  so that the array is seen as an alternation of kept and summed blocks.
+    - If the first block is kept (contiguous output runs of length L), the
+      output runs are distributed among threads and each run accumulates
+      all the summed positions.
+    - If the first block is summed (contiguous input runs of length R), each
+      output element is the sum of contiguous runs, accumulated in double
+      precision.
+  When there are too few outputs to feed all the threads, the summed
+  positions are split among threads with private accumulators that are
+  reduced in a second pass.
+
+  Supported types: double and single, real or complex (the real and
+  imaginary parts are processed separately).
+
+  Compilation:
+     -linux: mex sumDims.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildReduction.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define MAXDIM 32
+
+// Offsets of all the tuples of a set of (size,stride) blocks, first block fastest
+static void tupleOffsets(const std::vector<mwSize>& n, const std::vector<mwSize>& s, std::vector<mwSize>& off) {
+    mwSize tot=1;
+    for (size_t k=0;k<n.size();k++) tot*=n[k];
+    off.resize(tot);
+    std::vector<mwSize> idx(n.size(),0);
+    for (mwSize t=0;t<tot;t++) {
+        mwSize o=0;
+        for (size_t k=0;k<n.size();k++) o+=idx[k]*s[k];
+        off[t]=o;
+        for (size_t k=0;k<n.size() && ++idx[k]==n[k];k++) idx[k]=0;
+    }
+}
+
+template <typename T>
+static void sumDims(const T* x, T* y, int nb, const mwSize* bsz, const bool* bred) {
+    // Strides of the blocks
+    mwSize stride[MAXDIM];
+    stride[0]=1;
+    for (int b=1;b<nb;b++) stride[b]=stride[b-1]*bsz[b-1];
+
+    int nthreads=1;
+    #ifdef _OPENMP
+    nthreads=omp_get_max_threads();
+    #endif
+
+    // Outer kept / summed blocks (the first block is handled as a contiguous run)
+    std::vector<mwSize> kn, ks, rn, rs, koff, roff;
+    for (int b=1;b<nb;b++) {
+        if (bred[b]) {rn.push_back(bsz[b]); rs.push_back(stride[b]);}
+        else         {kn.push_back(bsz[b]); ks.push_back(stride[b]);}
+    }
+    tupleOffsets(kn,ks,koff);
+    tupleOffsets(rn,rs,roff);
+    mwSize nK=koff.size(), nR=roff.size(), len=bsz[0];
+
+    if (!bred[0]) {
+        // Output made of nK contiguous runs of length len
+        mwSize numel_y=nK*len;
+        if (nK>=(mwSize)(4*nthreads) || nthreads==1) {
+            long k;
+            #pragma omp parallel for schedule(static)
+            for (k=0;k<(long)nK;k++) {
+                T* yk=y+k*len;
+                for (mwSize r=0;r<nR;r++) {
+                    const T* xk=x+koff[k]+roff[r];
+                    for (mwSize i=0;i<len;i++)
+                        yk[i]+=xk[i];
+                }
+            }
+        } else {
+            std::vector<T> buf((mwSize)nthreads*numel_y,(T)0);
+            #pragma omp parallel
+            {
+                int tid=0;
+                #ifdef _OPENMP
+                tid=omp_get_thread_num();
+                #endif
+                T* acc=&buf[(mwSize)tid*numel_y];
+                long r;
+                #pragma omp for schedule(static)
+                for (r=0;r<(long)nR;r++) {
+                    for (mwSize k=0;k<nK;k++) {
+                        const T* xk=x+koff[k]+roff[r];
+                        T* ak=acc+k*len;
+                        for (mwSize i=0;i<len;i++)
+                            ak[i]+=xk[i];
+                    }
+                }
+                long j;
+                #pragma omp for schedule(static)
+                for (j=0;j<(long)numel_y;j++) {
+                    T s=0;
+                    for (int n=0;n<nthreads;n++)
+                        s+=buf[(mwSize)n*numel_y+j];
+                    y[j]=s;
+                }
+            }
+        }
+    } else {
+        // Each output element is the sum of nR contiguous runs of length len
+        if (nK>=(mwSize)(4*nthreads) || nthreads==1) {
+            long k;
+            #pragma omp parallel for schedule(static)
+            for (k=0;k<(long)nK;k++) {
+                double s=0;
+                for (mwSize r=0;r<nR;r++) {
+                    const T* xk=x+koff[k]+roff[r];
+                    for (mwSize i=0;i<len;i++)
+                        s+=xk[i];
+                }
+                y[k]=(T)s;
+            }
+        } else {
+            // Split the runs into chunks so that there is enough work for all the threads
+            mwSize nChunk=(len+nthreads-1)/nthreads;
+            if (nChunk<4096) nChunk=(len<4096) ? len : 4096;
+            mwSize nc=(len+nChunk-1)/nChunk, nWork=nR*nc;
+            std::vector<double> buf((mwSize)nthreads*nK,0.0);
+            #pragma omp parallel
+            {
+                int tid=0;
+                #ifdef _OPENMP
+                tid=omp_get_thread_num();
+                #endif
+                double* acc=&buf[(mwSize)tid*nK];
+                long w;
+                #pragma omp for schedule(static)
+                for (w=0;w<(long)nWork;w++) {
+                    mwSize r=w/nc, c=w%nc;
+                    mwSize i0=c*nChunk, i1=(i0+nChunk<len) ? i0+nChunk : len;
+                    for (mwSize k=0;k<nK;k++) {
+                        const T* xk=x+koff[k]+roff[r];
+                        double s=0;
+                        for (mwSize i=i0;i<i1;i++)
+                            s+=xk[i];
+                        acc[k]+=s;
+                    }
+                }
+            }
+            for (mwSize k=0;k<nK;k++) {
+                double s=0;
+                for (int n=0;n<nthreads;n++)
+                    s+=buf[(mwSize)n*nK+k];
+                y[k]=(T)s;
+            }
+        }
+    }
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("sumDims");
+    if (nrhs!=2)
+        mexErrMsgTxt("Usage: y = sumDims(x,dims).\n");
+    if (!(mxIsDouble(prhs[0]) || mxIsSingle(prhs[0])) || mxIsSparse(prhs[0]))
+        mexErrMsgTxt("The input should be a full double or single array.\n");
+
+    int ndx=mxGetNumberOfDimensions(prhs[0]);              // number of dimensions of the input
+    const mwSize *dimsx=mxGetDimensions(prhs[0]);          // dimension vector of the input
+    int ndd=mxGetNumberOfElements(prhs[1]);
+    double *d=mxGetPr(prhs[1]);
+    int nd=ndx;
+    for (int k=0;k<ndd;k++) {
+        if (d[k]<1 || d[k]>MAXDIM)
+            mexErrMsgTxt("Invalid dimension index.\n");
+        if ((int)d[k]>nd) nd=(int)d[k];
+    }
+
+    // Size of the output and flags of summed dimensions
+    mwSize sz[MAXDIM], szy[MAXDIM];
+    bool red[MAXDIM];
+    for (int k=0;k<nd;k++) {
+        sz[k]=(k<ndx) ? dimsx[k] : 1;
+        red[k]=false;
+    }
+    for (int k=0;k<ndd;k++) red[(int)d[k]-1]=true;
+    for (int k=0;k<nd;k++) szy[k]=red[k] ? 1 : sz[k];
+
+    //Create output argument (initialized to zero)
+    plhs[0]=mxCreateNumericArray(nd, szy, mxGetClassID(prhs[0]), mxIsComplex(prhs[0]) ? mxCOMPLEX : mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    if (mxGetNumberOfElements(prhs[0])==0)
+        return;
+
+    // Merge adjacent dimensions of the same kind (singletons are dropped)
+    mwSize bsz[MAXDIM];
+    bool bred[MAXDIM];
+    int nb=0;
+    for (int k=0;k<nd;k++) {
+        if (sz[k]==1) continue;
+        if (nb>0 && bred[nb-1]==red[k]) bsz[nb-1]*=sz[k];
+        else {bsz[nb]=sz[k]; bred[nb]=red[k]; nb++;}
+    }
+    if (nb==0) {bsz[0]=1; bred[0]=false; nb=1;}
+
+    if (mxIsDouble(prhs[0])) {
+        sumDims<double>((const double*)mxGetData(prhs[0]),(double*)mxGetData(plhs[0]),nb,bsz,bred);
+        if (mxIsComplex(prhs[0]))
+            sumDims<double>((const double*)mxGetImagData(prhs[0]),(double*)mxGetImagData(plhs[0]),nb,bsz,bred);
+    } else {
+        sumDims<float>((const float*)mxGetData(prhs[0]),(float*)mxGetData(plhs[0]),nb,bsz,bred);
+        if (mxIsComplex(prhs[0]))
+            sumDims<float>((const float*)mxGetImagData(prhs[0]),(float*)mxGetImagData(plhs[0]),nb,bsz,bred);
+    }
+}
@@ -0,0 +1,22 @@
+% function y=sumDims(x,dims)
+%
+%  Sums x over all the dimensions listed in dims in a single pass (the
+%  summed dimensions are kept as singletons). Equivalent to
+%       for n=dims, x=sum(x,n); end
+%  without intermediate arrays. Mex implementation used by LinOpSum and
+%  by the adjoint of LinOpBroadcast.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
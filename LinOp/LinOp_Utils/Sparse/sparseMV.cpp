@@ -0,0 +1,220 @@
+#include <mex.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  Multithreaded sparse matrix-vector products used by LinOpMatrix:
+
+     S = sparseMV('build',M,valClass)
+           builds, once, the compressed sparse row (CSR) storage of the
+           real sparse matrix M (m x n). The values are stored in valClass
+           ('double' or 'single') and the indices in int32 (int64 if nnz(M)
+           or the size of M does not fit in int32). S is a struct with the
+           fields m, n, rowPtr, colIdx and valRow.
+     y = sparseMV('apply',S,x)        y = M*x        (m x 1)
+     y = sparseMV('adjoint',M,x)      y = M'*x       (n x 1)
+     y = sparseMV('hth',S,x,M)        y = M'*(M*x)   (n x 1)
+
+  Both products are computed as independent dot products distributed
+  among threads: rows of the CSR storage for M*x, and rows of M', i.e. the
+  columns of the compressed sparse column (CSC) storage of MATLAB (the
+  arrays jc, ir and pr of M itself), for M'*x. The adjoint is then as fast
+  as the direct product and needs neither atomic updates, nor the
+  transposition of M at each call, nor a second copy of M. 'hth' chains
+  the two products in the same call with an internal buffer (no
+  intermediate MATLAB array).
+
+  With single values and int32 indices, the CSR storage takes 8 bytes per
+  nonzero in addition to the 16 bytes of M.
+
+  x is a real double or single vector (any shape with the right number of
+  elements); y has the class of x. The dot products are accumulated in
+  double precision.
+
+  Compilation:
+     -linux: mex sparseMV.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildSparse.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+// y[r] = sum_k val[k]*x[idx[k]], k in [ptr[r],ptr[r+1]), for the nr rows r
+template <typename V, typename I, typename X, typename Y>
+static void rowProducts(const I* ptr, const I* idx, const V* val, const X* x, Y* y, long nr) {
+    #pragma omp parallel for schedule(dynamic,512)
+    for (long r=0;r<nr;r++) {
+        double s=0;
+        for (I k=ptr[r];k<ptr[r+1];k++)
+            s+=(double)val[k]*(double)x[idx[k]];
+        y[r]=(Y)s;
+    }
+}
+
+// CSR storage from the CSC storage of MATLAB (jc, ir, pr)
+template <typename V, typename I>
+static void build(const mwIndex* jc, const mwIndex* ir, const double* pr, mwSize m, mwSize n,
+                  I* rowPtr, I* colIdx, V* valRow) {
+    mwSize nnz=jc[n];
+    // Counts per row, then running positions (columns are visited in
+    // increasing order, so that the column indices are sorted in each row)
+    for (mwSize i=0;i<=m;i++) rowPtr[i]=0;
+    for (mwSize k=0;k<nnz;k++) rowPtr[ir[k]+1]++;
+    for (mwSize i=0;i<m;i++) rowPtr[i+1]+=rowPtr[i];
+    std::vector<I> pos(rowPtr,rowPtr+m);
+    for (mwSize j=0;j<n;j++)
+        for (mwIndex k=jc[j];k<jc[j+1];k++) {
+            I p=pos[ir[k]]++;
+            colIdx[p]=(I)j;
+            valRow[p]=(V)pr[k];
+        }
+}
+
+static mxArray* getField(const mxArray* S, const char* name) {
+    mxArray* f=mxGetField(S,0,name);
+    if (f == NULL)
+        mexErrMsgTxt("S should be the structure returned by sparseMV('build',M,valClass).\n");
+    return f;
+}
+
+// Checks that M is the matrix of the CSR storage S
+static void checkMatrix(const mxArray* M, long m, long n) {
+    if (!mxIsSparse(M) || !mxIsDouble(M) || mxIsComplex(M) || (long)mxGetM(M)!=m || (long)mxGetN(M)!=n)
+        mexErrMsgTxt("M should be the real sparse matrix given to sparseMV('build',M,valClass).\n");
+}
+
+// M'*x from the CSC storage of MATLAB
+template <typename X, typename Y>
+static void adjointProducts(const mxArray* M, const X* x, Y* y) {
+    rowProducts(mxGetJc(M),mxGetIr(M),mxGetPr(M),x,y,(long)mxGetN(M));
+}
+
+// Product selected by cmd for the value type V and the index type I of
+// the CSR storage ('apply' and 'hth')
+template <typename V, typename I>
+static mxArray* product(const char* cmd, const mxArray* S, const mxArray* x, const mxArray* M) {
+    long m=(long)mxGetScalar(getField(S,"m")), n=(long)mxGetScalar(getField(S,"n"));
+    bool direct=!strcmp(cmd,"apply");
+    long nout=direct ? m : n;
+    if ((long)mxGetNumberOfElements(x)!=n)
+        mexErrMsgTxt("x does not have the right number of elements.\n");
+    if (!direct) checkMatrix(M,m,n);
+    const I *rowPtr=(const I*)mxGetData(getField(S,"rowPtr")), *colIdx=(const I*)mxGetData(getField(S,"colIdx"));
+    const V *valRow=(const V*)mxGetData(getField(S,"valRow"));
+    mxArray* y=mxCreateNumericMatrix(nout,1,mxGetClassID(x),mxREAL);
+    if (y == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    if (mxIsDouble(x)) {
+        const double* xd=(const double*)mxGetData(x);
+        double* yd=(double*)mxGetData(y);
+        if (direct)
+            rowProducts(rowPtr,colIdx,valRow,xd,yd,m);
+        else {
+            std::vector<double> t(m);
+            rowProducts(rowPtr,colIdx,valRow,xd,t.data(),m);
+            adjointProducts(M,(const double*)t.data(),yd);
+        }
+    } else {
+        const float* xf=(const float*)mxGetData(x);
+        float* yf=(float*)mxGetData(y);
+        if (direct)
+            rowProducts(rowPtr,colIdx,valRow,xf,yf,m);
+        else {
+            std::vector<double> t(m);
+            rowProducts(rowPtr,colIdx,valRow,xf,t.data(),m);
+            adjointProducts(M,(const double*)t.data(),yf);
+        }
+    }
+    return y;
+}
+
+static void checkVector(const mxArray* x) {
+    if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsComplex(x) || mxIsSparse(x))
+        mexErrMsgTxt("x should be a full real double or single array.\n");
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs<3 || !mxIsChar(prhs[0]))
+        mexErrMsgTxt("Usage: sparseMV(command,...).\n");
+    char cmd[16];
+    mxGetString(prhs[0],cmd,sizeof(cmd));
+    KernelTimer timer("sparseMV",cmd);
+
+    if (!strcmp(cmd,"build")) {
+        const mxArray* M=prhs[1];
+        if (!mxIsSparse(M) || !mxIsDouble(M) || mxIsComplex(M))
+            mexErrMsgTxt("M should be a real sparse matrix.\n");
+        if (!mxIsChar(prhs[2]))
+            mexErrMsgTxt("Usage: S = sparseMV('build',M,valClass).\n");
+        char valClass[8];
+        mxGetString(prhs[2],valClass,sizeof(valClass));
+        bool single=!strcmp(valClass,"single");
+        if (!single && strcmp(valClass,"double"))
+            mexErrMsgTxt("valClass should be 'double' or 'single'.\n");
+        mwSize m=mxGetM(M), n=mxGetN(M);
+        const mwIndex *jc=mxGetJc(M), *ir=mxGetIr(M);
+        mwSize nnz=jc[n];
+        bool idx32=(nnz<(mwSize)INT32_MAX && m<(mwSize)INT32_MAX && n<(mwSize)INT32_MAX);
+        mxClassID ic=idx32 ? mxINT32_CLASS : mxINT64_CLASS, vc=single ? mxSINGLE_CLASS : mxDOUBLE_CLASS;
+        const char* fields[]={"m","n","rowPtr","colIdx","valRow"};
+        mxArray* S=mxCreateStructMatrix(1,1,5,fields);
+        mxArray *rowPtr=mxCreateNumericMatrix(m+1,1,ic,mxREAL), *colIdx=mxCreateNumericMatrix(nnz,1,ic,mxREAL);
+        mxArray *valRow=mxCreateNumericMatrix(nnz,1,vc,mxREAL);
+        if (!S || !rowPtr || !colIdx || !valRow)
+            mexErrMsgTxt("Could not create mxArray.\n");
+        const double* pr=mxGetPr(M);
+        if (idx32 && single)
+            build<float,int32_t>(jc,ir,pr,m,n,(int32_t*)mxGetData(rowPtr),(int32_t*)mxGetData(colIdx),(float*)mxGetData(valRow));
+        else if (idx32)
+            build<double,int32_t>(jc,ir,pr,m,n,(int32_t*)mxGetData(rowPtr),(int32_t*)mxGetData(colIdx),(double*)mxGetData(valRow));
+        else if (single)
+            build<float,int64_t>(jc,ir,pr,m,n,(int64_t*)mxGetData(rowPtr),(int64_t*)mxGetData(colIdx),(float*)mxGetData(valRow));
+        else
+            build<double,int64_t>(jc,ir,pr,m,n,(int64_t*)mxGetData(rowPtr),(int64_t*)mxGetData(colIdx),(double*)mxGetData(valRow));
+        mxSetField(S,0,"m",mxCreateDoubleScalar((double)m));
+        mxSetField(S,0,"n",mxCreateDoubleScalar((double)n));
+        mxSetField(S,0,"rowPtr",rowPtr); mxSetField(S,0,"colIdx",colIdx); mxSetField(S,0,"valRow",valRow);
+        plhs[0]=S;
+    } else if (!strcmp(cmd,"adjoint")) {
+        if (nrhs!=3)
+            mexErrMsgTxt("Usage: y = sparseMV('adjoint',M,x).\n");
+        const mxArray *M=prhs[1], *x=prhs[2];
+        checkMatrix(M,(long)mxGetM(M),(long)mxGetN(M));
+        checkVector(x);
+        if (mxGetNumberOfElements(x)!=mxGetM(M))
+            mexErrMsgTxt("x does not have the right number of elements.\n");
+        mxArray* y=mxCreateNumericMatrix(mxGetN(M),1,mxGetClassID(x),mxREAL);
+        if (y == NULL)
+            mexErrMsgTxt("Could not create mxArray.\n");
+        if (mxIsDouble(x))
+            adjointProducts(M,(const double*)mxGetData(x),(double*)mxGetData(y));
+        else
+            adjointProducts(M,(const float*)mxGetData(x),(float*)mxGetData(y));
+        plhs[0]=y;
+    } else if (!strcmp(cmd,"apply") || !strcmp(cmd,"hth")) {
+        bool hth=!strcmp(cmd,"hth");
+        if (nrhs!=(hth ? 4 : 3) || !mxIsStruct(prhs[1]))
+            mexErrMsgTxt("Usage: y = sparseMV('apply',S,x) or y = sparseMV('hth',S,x,M).\n");
+        const mxArray *S=prhs[1], *x=prhs[2], *M=hth ? prhs[3] : NULL;
+        checkVector(x);
+        bool idx32=(mxGetClassID(getField(S,"rowPtr"))==mxINT32_CLASS);
+        bool single=mxIsSingle(getField(S,"valRow"));
+        if (idx32 && single)
+            plhs[0]=product<float,int32_t>(cmd,S,x,M);
+        else if (idx32)
+            plhs[0]=product<double,int32_t>(cmd,S,x,M);
+        else if (single)
+            plhs[0]=product<float,int64_t>(cmd,S,x,M);
+        else
+            plhs[0]=product<double,int64_t>(cmd,S,x,M);
+    } else {
+        mexErrMsgTxt("Unknown command.\n");
+    }
+}
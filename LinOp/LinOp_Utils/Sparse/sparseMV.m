@@ -0,0 +1,27 @@
+% function varargout=sparseMV(cmd,varargin)
+%
+%  Multithreaded sparse matrix-vector products:
+%     S = sparseMV('build',M,valClass)   CSR storage of the real sparse
+%                                        matrix M, built once (values in
+%                                        valClass 'double' or 'single', int32
+%                                        indices when possible)
+%     y = sparseMV('apply',S,x)          y = M*x
+%     y = sparseMV('adjoint',M,x)        y = M'*x  (from the storage of M)
+%     y = sparseMV('hth',S,x,M)          y = M'*(M*x)
+%  x is a real double or single vector, y is a column vector of the same
+%  class. Mex implementation used by LinOpMatrix.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
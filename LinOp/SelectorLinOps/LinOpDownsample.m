@@ -11,6 +11,9 @@ classdef LinOpDownsample < LinOpSelector
     % All attributes of the parent class :class:`LinOpSelector` 
     % are inherited. 
     %
+    % **Note** The composition of a :class:`LinOpDownsample` with a
+    % :class:`LinOpConv` returns a :class:`LinOpDownsampledConv`.
+    %
     % **Example** D=LinOpDownsample(sz,df,first)
     %
     % See also :class:`LinOp`, :class:`LinOpSelector`,
@@ -72,7 +75,10 @@ classdef LinOpDownsample < LinOpSelector
             % Reimplemented from parent class :class:`LinOp`
             
             G=[];
-            if isa(H, 'LinOpComposition')
+            if isa(H, 'LinOpConv') && ~H.useRFT && isempty(H.Notindex)
+                % Only the retained samples are computed (polyphase evaluation)
+                G = LinOpDownsampledConv(H.mtf,this.df,this.first,H.isReal);
+            elseif isa(H, 'LinOpComposition')
                 if isa(H.H2,'LinOpAdjoint') && isequal(H.H2.TLinOp,this)
                     if isa(H.H1, 'LinOpConv')
                         P=LinOpSumPatches(this.sizein,this.sizein./this.df);
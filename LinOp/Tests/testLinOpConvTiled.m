@@ -0,0 +1,68 @@
+%--------------------------------------------------------------------------
+% This script checks LinOpConvTiled (overlap-save convolution by tiles)
+% against LinOpConv, and the block-wise deconvolution deconvTiled
+% (blending weights summing to one, comparison with the deconvolution of
+% the whole volume).
+%--------------------------------------------------------------------------
+close all;
+help testLinOpConvTiled
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Tiled convolution vs LinOpConv (the halos are periodic at the borders)
+sz=[45 38 21];
+psf=rand(7,6,5);
+H=LinOpConvTiled(psf,sz,[16 16 8]);
+k=zeros(sz); k(1:7,1:6,1:5)=psf;
+Href=LinOpConv(fftn(circshift(k,-floor([7 6 5]/2))));
+x=rand(sz); y=rand(sz);
+disp(['apply max error        : ',num2str(max(reshape(abs(H*x-Href*x),[],1)))]);
+disp(['applyAdjoint max error : ',num2str(max(reshape(abs(H'*y-Href'*y),[],1)))]);
+Ha=H';
+disp(['makeAdjoint max error  : ',num2str(max(reshape(abs(Ha*y-Href'*y),[],1)))]);
+disp(['Norm (bound)           : ',num2str(H.getNorm()),' (',num2str(Href.norm),')']);
+checkLinOp(H);
+
+%% Parallel tiles (thread-based pool) and single precision
+H.numWorkers=4;
+assert(max(reshape(abs(H*x-Href*x),[],1))<1e-10,'Parallel tiled convolution does not match');
+ys=H*single(x);
+assert(isa(ys,'single') && max(reshape(abs(ys-Href*x),[],1))<1e-4,'Single precision tiled convolution does not match');
+
+%% deconvTiled: the blending weights sum to one
+sz=[64 50 24];
+y=rand(sz);
+opts.halo=[5 5 3];
+xi=deconvTiled(y,rand(5,5,3),@(H,yb) yb,[24 20 10],opts);
+disp(['Blending max error     : ',num2str(max(abs(xi(:)-y(:))))]);
+xs=deconvTiled(single(y),rand(5,5,3),@(H,yb) yb,[24 20 10],opts);
+assert(isa(xs,'single') && max(abs(xs(:)-y(:)))<1e-5,'deconvTiled should accumulate in the class of the data');
+
+%% deconvTiled vs deconvolution of the whole volume (Tikhonov, closed form)
+[X,Y,Z]=ndgrid(-4:4,-4:4,-2:2);
+psf=exp(-(X.^2+Y.^2)/4-Z.^2/2); psf=psf/sum(psf(:));
+im=zeros(sz); im(randi(prod(sz),1,200))=1;
+k=zeros(sz); k(1:9,1:9,1:5)=psf;
+Hf=LinOpConv(fftn(circshift(k,-[4 4 2])));
+y=Hf*im;
+lamb=1e-2;
+tikh=@(H,yb) real(ifftn(conj(H.mtf).*fftn(yb)./(abs(H.mtf).^2+lamb)));
+xfull=tikh(Hf,y);
+opts.halo=[9 9 5];
+xt=deconvTiled(y,psf,tikh,[32 25 12],opts);
+cen={10:55,10:41,6:19};   % away from the periodic borders of the whole-volume problem
+disp(['Tiled vs full relative error (interior) : ',num2str(norm(reshape(xt(cen{:})-xfull(cen{:}),[],1))/norm(reshape(xfull(cen{:}),[],1)))]);
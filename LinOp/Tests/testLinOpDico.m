@@ -0,0 +1,60 @@
+%--------------------------------------------------------------------------
+% This script checks LinOpDico (synthesis and analysis as matrix products
+% with the dictionary, batched over several coefficient vectors) against
+% the broadcast expressions.
+%--------------------------------------------------------------------------
+close all;
+help testLinOpDico
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Dictionary of 2D atoms
+D=rand(16,16,64);
+Dm=reshape(D,256,64);       % dense reference
+H=LinOpDico(D);
+x=rand(H.sizein);
+y=rand(H.sizeout);
+assert(norm(reshape(H*x,[],1)-Dm*x(:))<=1e-12*norm(Dm*x(:)),'apply');
+assert(isequal(size(H*x),[16 16]),'apply: output size');
+assert(norm(reshape(H'*y,[],1)-Dm'*y(:))<=1e-12*norm(Dm'*y(:)),'applyAdjoint');
+assert(isequal(size(H'*y),H.sizein),'applyAdjoint: input size');
+assert(abs(dot(reshape(H*x,[],1),y(:))-dot(x(:),reshape(H'*y,[],1)))<=1e-12*abs(dot(y(:),reshape(H*x,[],1))),'adjointness');
+ref=Dm'*(Dm*x(:));
+assert(norm(reshape(H.applyHtH(x),[],1)-ref)<=1e-12*norm(ref),'applyHtH (Gram matrix)');
+assert(norm(reshape(H.applyHtH(2*x),[],1)-2*ref)<=1e-12*norm(ref),'applyHtH (cached Gram matrix)');
+checkLinOp(H);
+
+%% Overcomplete dictionary (applyHtH without Gram matrix)
+Do=rand(4,4,40);
+Dom=reshape(Do,16,40);
+Ho=LinOpDico(Do);
+xo=rand(Ho.sizein);
+ref=Dom'*(Dom*xo(:));
+assert(norm(reshape(Ho.applyHtH(xo),[],1)-ref)<=1e-12*norm(ref),'overcomplete applyHtH');
+
+%% Batch of coefficient vectors
+K=10;
+Hb=LinOpDico(D,K);
+xb=rand(Hb.sizein);
+yb=rand(Hb.sizeout);
+Xb=reshape(xb,64,K); Yb=reshape(yb,256,K);
+assert(norm(reshape(Hb*xb,256,K)-Dm*Xb,'fro')<=1e-12*norm(Dm*Xb,'fro'),'batched apply');
+assert(norm(reshape(Hb'*yb,64,K)-Dm'*Yb,'fro')<=1e-12*norm(Dm'*Yb,'fro'),'batched applyAdjoint');
+assert(abs(sum(reshape(Hb*xb,[],1).*yb(:))-sum(xb(:).*reshape(Hb'*yb,[],1)))<=1e-12*abs(sum(yb(:).*reshape(Hb*xb,[],1))),'batched adjointness');
+ref=Dm'*(Dm*Xb);
+assert(norm(reshape(Hb.applyHtH(xb),64,K)-ref,'fro')<=1e-12*norm(ref,'fro'),'batched applyHtH');
+checkLinOp(Hb);
@@ -0,0 +1,21 @@
+sz = [64, 48];
+df = [4, 2];
+first = [2, 1];
+mtf = fftn(rand(sz));
+C = LinOpConv(mtf);
+S = LinOpDownsample(sz,df,first);
+H = S*C;
+assert(isa(H,'LinOpDownsampledConv'))
+
+%% apply / adjoint (compare with the full resolution computation)
+x = rand(sz);
+y = rand(S.sizeout);
+z = real(ifftn(mtf.*fftn(x)));
+assert(norm(H*x - z(first(1):df(1):end,first(2):df(2):end),'fro') < 1e-10)
+z = zeros(sz); z(first(1):df(1):end,first(2):df(2):end) = y;
+assert(norm(H'*y - real(ifftn(conj(mtf).*fftn(z))),'fro') < 1e-10)
+
+%% (H'H + gamma I)^-1
+gamma = 0.3;
+u = H.applyHtHShiftedInverse(x,gamma);
+assert(norm(H.applyHtH(u) + gamma*u - x,'fro')/norm(x,'fro') < 1e-10)
@@ -0,0 +1,56 @@
+%--------------------------------------------------------------------------
+% This script checks the sparse backend of LinOpMatrix (multithreaded CSR/
+% CSC products of the mex file sparseMV, see buildSparse) against the
+% MATLAB products M*x, M'*x and M'*M*x, in double and single precision.
+%--------------------------------------------------------------------------
+close all;
+help testLinOpMatrix
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Sparse system matrix
+M=sprand(2000,1500,0.01);
+x=rand(1500,1);
+y=rand(2000,1);
+xc=x+1i*rand(1500,1);
+disp(['sparseMV mex available : ',num2str(exist('sparseMV')==3)]);
+
+%% Double precision values
+H=LinOpMatrix(M);
+assert(norm(H*x-M*x)<=1e-12*norm(M*x),'apply');
+assert(norm(H'*y-M'*y)<=1e-12*norm(M'*y),'applyAdjoint');
+assert(norm(H.applyHtH(x)-M'*(M*x))<=1e-12*norm(M'*(M*x)),'applyHtH');
+assert(norm(H*xc-M*xc)<=1e-12*norm(M*xc),'complex apply');
+assert(norm(H'*(y+1i*y)-M'*(y+1i*y))<=1e-12*norm(M'*(y+1i*y)),'complex applyAdjoint');
+assert(abs(dot(H*x,y)-dot(x,H'*y))<=1e-12*abs(dot(H*x,y)),'adjointness');
+checkLinOp(H);
+
+%% Single precision values
+Hs=LinOpMatrix(M,[],'single');
+assert(norm(Hs*x-M*x)<=1e-5*norm(M*x),'single apply');
+assert(norm(Hs'*y-M'*y)<=1e-12*norm(M'*y),'single applyAdjoint');
+assert(norm(Hs.applyHtH(x)-M'*(M*x))<=1e-5*norm(M'*(M*x)),'single applyHtH');
+ys=Hs*single(x);
+assert(isa(ys,'single'),'The output should have the class of the input');
+assert(norm(double(ys)-M*x)<=1e-5*norm(M*x),'single input');
+
+%% Sparse logical matrix (MATLAB products)
+Ml=sprand(200,150,0.05)>0;
+Hl=LinOpMatrix(Ml);
+xl=randn(150,1);
+assert(norm(Hl*xl-Ml*xl)<=1e-12*norm(Ml*xl),'logical apply');
+assert(norm(Hl'*Hl*xl-Ml'*(Ml*xl))<=1e-12*norm(Ml'*(Ml*xl)),'logical applyHtH');
@@ -0,0 +1,25 @@
+sz = [64, 48, 12];
+szPatch = [16, 8, 4];
+S = LinOpSumPatches(sz,szPatch);
+
+%% apply (compare with an explicit loop over patches)
+x = rand(sz);
+y = zeros(szPatch);
+for i=0:sz(1)/szPatch(1)-1
+    for j=0:sz(2)/szPatch(2)-1
+        for k=0:sz(3)/szPatch(3)-1
+            y = y + x(i*szPatch(1)+(1:szPatch(1)),j*szPatch(2)+(1:szPatch(2)),k*szPatch(3)+(1:szPatch(3)));
+        end
+    end
+end
+assert(norm(S*x-y,'fro')/norm(y,'fro') < 1e-14)
+
+%% adjoint
+y = rand(szPatch);
+assert(isequal(S'*y,repmat(y,sz./szPatch)))
+assert(abs(sum(sum(sum((S*x).*y)))-sum(sum(sum(x.*(S'*y))))) < 1e-10)
+
+%% single precision and vectors
+S = LinOpSumPatches([1000 1],[10 1]);
+x = single(rand(1000,1));
+assert(norm(double(S*x)-sum(reshape(double(x),10,[]),2)) < 1e-3)
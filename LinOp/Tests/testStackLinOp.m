@@ -0,0 +1,67 @@
+%--------------------------------------------------------------------------
+% This script checks StackLinOp (sequential and with numWorkers>0 when a
+% parallel pool is available) against the explicit stacking of the
+% outputs of its LinOps.
+%--------------------------------------------------------------------------
+close all;
+help testStackLinOp
+%--------------------------------------------------------------
+% Copyright (C) 2026, GlobalBioIm developers
+%
+%  This program is free software: you can redistribute it and/or modify
+%  it under the terms of the GNU General Public License as published by
+%  the Free Software Foundation, either version 3 of the License, or
+%  (at your option) any later version.
+%
+%  This program is distributed in the hope that it will be useful,
+%  but WITHOUT ANY WARRANTY; without even the implied warranty of
+%  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%  GNU General Public License for more details.
+%
+%  You should have received a copy of the GNU General Public License
+%  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%---------------------------------------------------------------
+
+%% Stack of 8 convolutions
+sz=[64 64]; N=8;
+A=cell(1,N);
+for n=1:N
+    A{n}=LinOpConv(fft2(rand(sz)));
+end
+alpha=rand(1,N);
+S=StackLinOp(A,alpha);
+x=rand(sz);
+w=rand(S.sizeout);
+yref=zeros([sz N]); xref=zeros(sz);
+for n=1:N
+    yref(:,:,n)=alpha(n)*(A{n}*x);
+    xref=xref+alpha(n)*A{n}'*w(:,:,n);
+end
+yseq=S*x; xseq=S'*w;
+assert(norm(yseq(:)-yref(:))<=1e-12*norm(yref(:)),'apply');
+assert(norm(xseq(:)-xref(:))<=1e-12*norm(xref(:)),'applyAdjoint');
+
+%% Same on the workers of the parallel pool (if it is thread-based)
+S.numWorkers=4;
+ypar=S*x; xpar=S'*w;
+assert(isequal(ypar,yseq),'parallel apply');
+assert(norm(xpar(:)-xseq(:))<=1e-12*norm(xseq(:)),'parallel applyAdjoint');   % order of the reduction
+checkLinOp(S);
+
+%% OneToMany, sequential and parallel
+O=OneToMany(A,alpha);
+z=cell(1,N);
+for n=1:N, z{n}=w(:,:,n); end
+yseq=O.apply(x); xseq=O.adjoint(z); hseq=O.HtH(x);
+href=zeros(sz);
+for n=1:N
+    assert(norm(yseq{n}-yref(:,:,n),'fro')<=1e-12*norm(yref(:,:,n),'fro'),'OneToMany apply');
+    href=href+alpha(n)*(A{n}'*(A{n}*x));
+end
+assert(norm(xseq(:)-xref(:))<=1e-12*norm(xref(:)),'OneToMany adjoint');
+assert(norm(hseq(:)-href(:))<=1e-12*norm(href(:)),'OneToMany HtH');
+O.numWorkers=4;
+ypar=O.apply(x); xpar=O.adjoint(z); hpar=O.HtH(x);
+assert(isequal(ypar,yseq),'parallel OneToMany apply');
+assert(norm(xpar(:)-xseq(:))<=1e-12*norm(xseq(:)),'parallel OneToMany adjoint');
+assert(norm(hpar(:)-hseq(:))<=1e-12*norm(hseq(:)),'parallel OneToMany HtH');
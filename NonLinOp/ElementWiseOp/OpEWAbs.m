@@ -34,6 +34,7 @@ classdef OpEWAbs < Map
             this.sizeout=sz;
             this.isDifferentiable=true; % almost ...
             this.isInvertible=false;
+            this.isElementWise=true;
         end
     end
 	
@@ -48,5 +49,13 @@ classdef OpEWAbs < Map
             assert(all(v(:)),'Input vector contains zeros');
             x=v./abs(v).*y;
         end	
+        function [y,d] = applyElementWise_(~,x)
+            % Reimplemented from parent class :class:`Map`.
+            y=abs(x);
+            if nargout>1
+                assert(all(x(:)),'Input vector contains zeros');
+                d=x./y;
+            end
+        end
     end
 end
\ No newline at end of file
@@ -34,6 +34,7 @@ classdef OpEWInverse < Map
             this.sizeout=sz;
             this.isDifferentiable=true;
             this.isInvertible=true;
+            this.isElementWise=true;
         end
     end
 	
@@ -51,5 +52,14 @@ classdef OpEWInverse < Map
             assert(sum(v(:)==0)==0,'Input vector contains zeros');
             x=-1./v.^2.*y;
         end	
+        function [y,d] = applyElementWise_(this,x)
+            % Reimplemented from parent class :class:`Map`.
+
+            assert(sum(x(:)==0)==0,'Input vector contains zeros');
+            y=1./x;
+            if nargout>1
+                d=-y.^2;
+            end
+        end
     end
 end
\ No newline at end of file
@@ -34,6 +34,7 @@ classdef OpEWSqrt < Map
             this.sizeout=sz;
             this.isDifferentiable=true;
             this.isInvertible=true;
+            this.isElementWise=true;
         end
     end
 	
@@ -50,5 +51,14 @@ classdef OpEWSqrt < Map
 
             x=1./(2*sqrt(v)).*y;
         end	
+        function [y,d] = applyElementWise_(this,x)
+            % Reimplemented from parent class :class:`Map`.
+
+            assert(sum(x(:)<0)==0,'Input vector contains negative values');
+            y=sqrt(x);
+            if nargout>1
+                d=1./(2*y);
+            end
+        end
     end
 end
\ No newline at end of file
@@ -34,6 +34,7 @@ classdef OpEWSquaredMagnitude < Map
             this.sizeout=sz;
             this.isDifferentiable=true;
             this.isInvertible=false;
+            this.isElementWise=true;
         end
     end
 	
@@ -49,5 +50,13 @@ classdef OpEWSquaredMagnitude < Map
 
             x=2*v.*y;
         end	
+        function [y,d] = applyElementWise_(this,x)
+            % Reimplemented from parent class :class:`Map`.
+
+            y=abs(x).^2;
+            if nargout>1
+                d=2*x;
+            end
+        end
     end
 end
\ No newline at end of file
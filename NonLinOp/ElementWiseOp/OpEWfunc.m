@@ -47,6 +47,7 @@ classdef OpEWfunc < Map
             this.name ='OpEWfunc';
             this.sizein=sz;
             this.sizeout=sz;
+            this.isElementWise=true;
             
             this.func = func ;
             
@@ -81,5 +82,15 @@ classdef OpEWfunc < Map
             % Reimplemented from parent class :class:`Map`.
             x=this.func_inv(y) ;
         end	
+        function [y,d] = applyElementWise_(this,x)
+            % Reimplemented from parent class :class:`Map`.
+            y=this.func(x) ;
+            if nargout>1
+                if ~this.isDifferentiable
+                    error('applyJacobianT_ method not implemented');
+                end
+                d=this.func_grad(x) ;
+            end
+        end
     end
 end
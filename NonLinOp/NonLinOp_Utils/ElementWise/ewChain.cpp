@@ -0,0 +1,285 @@
+#ifndef CPU_VARIANT
+#include <mex.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
+
+/***************************************************************************
+  [y,d] = ewChain(x,codes,coefs)
+
+  Applies a chain of element-wise operators to the array x in a single
+  pass: each block of elements goes through all the stages in the L1
+  cache, without intermediate arrays. The stages are given in order of application by codes:
+      1 : abs(u)                              (OpEWAbs)
+      2 : sqrt(u)                             (OpEWSqrt)
+      3 : 1./u                                (OpEWInverse)
+      4 : abs(u).^2                           (OpEWSquaredMagnitude)
+      5 : c.*u with c=coefs{k}                (LinOpDiag)
+  For the stage 5, coefs{k} must be of the same class as x and contain
+  either one or numel(x) elements (the other cells are ignored).
+
+  If requested, the second output d is the product of the derivatives of
+  all the stages, evaluated along the chain, such that the
+  Jacobian-transpose product of the chain at x is d.*w (with the same
+  conventions as the applyJacobianT_ methods of the corresponding Maps).
+
+  Supported types: double and single, real or complex.
+
+  The chain is compiled for several instruction sets and the variant is
+  chosen at run time (see cpuDispatch.h and cpuInfo).
+
+  Compilation:
+     -linux: mex ewChain.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildElementWise.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define EW_ABS     1
+#define EW_SQRT    2
+#define EW_INVERSE 3
+#define EW_SQMAG   4
+#define EW_COEF    5
+
+#define ERR_ZERO     1
+#define ERR_NEGATIVE 2
+
+#define EW_BLOCK 512   // elements per block (values and derivatives of a block: 16 KB in complex double)
+
+template <typename T> struct Stage {
+    int code;
+    const T* cr;     // real part of the coefficients (EW_COEF)
+    const T* ci;     // imaginary part of the coefficients (NULL if real)
+    bool full;       // one coefficient per element
+};
+
+template <typename T> static inline T conjV(T v) {return v;}
+template <typename T> static inline std::complex<T> conjV(std::complex<T> v) {return std::conj(v);}
+template <typename T> static inline bool negativeV(T v) {return v<0;}
+template <typename T> static inline bool negativeV(std::complex<T> v) {return v.real()<0;} // as MATLAB <
+template <typename T> static inline T sqrtV(T v) {return sqrt(v);}
+template <typename T> static inline std::complex<T> sqrtV(std::complex<T> v) {return std::sqrt(v);}
+template <typename T> static inline T loadV(const T* r, const T* i, mwSize n, T*) {return r[n];}
+template <typename T> static inline std::complex<T> loadV(const T* r, const T* i, mwSize n, std::complex<T>*) {
+    return std::complex<T>(r[n], i ? i[n] : T(0));
+}
+template <typename T> static inline void storeV(T v, T* r, T* i, mwSize n) {r[n]=v;}
+template <typename T> static inline void storeV(std::complex<T> v, T* r, T* i, mwSize n) {
+    r[n]=v.real();
+    if (i) i[n]=v.imag();
+}
+
+// Variants of ewChain for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "ewChain.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "ewChain.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "ewChain.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "ewChain.cpp"
+
+template <typename T>
+static void run(int nlhs, mxArray* plhs[], const mxArray* x, std::vector< Stage<T> >& stages,
+                bool cplxChain, bool yCplx, bool dCplx) {
+    mwSize numel=mxGetNumberOfElements(x);
+    mxClassID cid=mxGetClassID(x);
+    plhs[0]=mxCreateNumericArray(mxGetNumberOfDimensions(x), mxGetDimensions(x), cid, yCplx ? mxCOMPLEX : mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    T *dr=NULL, *di=NULL;
+    if (nlhs>1) {
+        plhs[1]=mxCreateNumericArray(mxGetNumberOfDimensions(x), mxGetDimensions(x), cid, dCplx ? mxCOMPLEX : mxREAL);
+        if (plhs[1] == NULL)
+            mexErrMsgTxt("Could not create mxArray.\n");
+        dr=(T*)mxGetData(plhs[1]);
+        di=(T*)mxGetImagData(plhs[1]);
+    }
+    const T* xr=(const T*)mxGetData(x);
+    const T* xi=(const T*)mxGetImagData(x);
+    T* yr=(T*)mxGetData(plhs[0]);
+    T* yi=(T*)mxGetImagData(plhs[0]);
+
+    int err, isa=cpuIsa();
+    if (cplxChain)
+        err=CPU_CALL(isa,ewChain,(xr,xi,yr,yi,dr,di,numel,stages,(std::complex<T>*)NULL));
+    else
+        err=CPU_CALL(isa,ewChain,(xr,xi,yr,yi,dr,di,numel,stages,(T*)NULL));
+    if (err & ERR_ZERO)
+        mexErrMsgTxt("Input vector contains zeros");
+    if (err & ERR_NEGATIVE)
+        mexErrMsgTxt("Input vector contains negative values");
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("ewChain");
+    if (nrhs!=3)
+        mexErrMsgTxt("Usage: [y,d] = ewChain(x,codes,coefs).\n");
+    const mxArray* x=prhs[0];
+    if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsSparse(x))
+        mexErrMsgTxt("The input should be a full double or single array.\n");
+    if (!mxIsDouble(prhs[1]) || !mxIsCell(prhs[2]) || mxGetNumberOfElements(prhs[1])!=mxGetNumberOfElements(prhs[2]))
+        mexErrMsgTxt("codes should be a double array and coefs a cell of the same length.\n");
+
+    int ns=(int)mxGetNumberOfElements(prhs[1]);
+    const double* codes=mxGetPr(prhs[1]);
+    mwSize numel=mxGetNumberOfElements(x);
+
+    // Check the stages and track the complexity of the value and of the derivative
+    bool cur=mxIsComplex(x), cplxChain=cur, dCplx=false;
+    for (int k=0;k<ns;k++) {
+        int code=(int)codes[k];
+        switch (code) {
+            case EW_ABS:
+            case EW_SQMAG:
+                dCplx=dCplx || cur;
+                cur=false;
+                break;
+            case EW_SQRT:
+            case EW_INVERSE:
+                dCplx=dCplx || cur;
+                break;
+            case EW_COEF: {
+                const mxArray* c=mxGetCell(prhs[2],k);
+                if (c==NULL || mxGetClassID(c)!=mxGetClassID(x) || mxIsSparse(c) ||
+                    (mxGetNumberOfElements(c)!=1 && mxGetNumberOfElements(c)!=numel))
+                    mexErrMsgTxt("Coefficients should be of the class of x, with one or numel(x) elements.\n");
+                cur=cur || mxIsComplex(c);
+                dCplx=dCplx || mxIsComplex(c);
+                cplxChain=cplxChain || mxIsComplex(c);
+                break;
+            }
+            default:
+                mexErrMsgTxt("Unknown element-wise operator code.\n");
+        }
+    }
+
+    if (mxIsDouble(x)) {
+        std::vector< Stage<double> > stages(ns);
+        for (int k=0;k<ns;k++) {
+            stages[k].code=(int)codes[k];
+            const mxArray* c=mxGetCell(prhs[2],k);
+            stages[k].cr=(stages[k].code==EW_COEF) ? (const double*)mxGetData(c) : NULL;
+            stages[k].ci=(stages[k].code==EW_COEF) ? (const double*)mxGetImagData(c) : NULL;
+            stages[k].full=(stages[k].code==EW_COEF) && mxGetNumberOfElements(c)==numel && numel>1;
+        }
+        run<double>(nlhs,plhs,x,stages,cplxChain,cur,dCplx);
+    } else {
+        std::vector< Stage<float> > stages(ns);
+        for (int k=0;k<ns;k++) {
+            stages[k].code=(int)codes[k];
+            const mxArray* c=mxGetCell(prhs[2],k);
+            stages[k].cr=(stages[k].code==EW_COEF) ? (const float*)mxGetData(c) : NULL;
+            stages[k].ci=(stages[k].code==EW_COEF) ? (const float*)mxGetImagData(c) : NULL;
+            stages[k].full=(stages[k].code==EW_COEF) && mxGetNumberOfElements(c)==numel && numel>1;
+        }
+        run<float>(nlhs,plhs,x,stages,cplxChain,cur,dCplx);
+    }
+}
+
+#else
+// V is either T (real chain) or std::complex<T> (complex chain), given by the type of the last argument.
+// The elements are processed by blocks of EW_BLOCK which stay in the L1 cache, one stage after the other:
+// the inner loops over the elements are straight-line code (vectorized for the real chains).
+template <typename T, typename V>
+CPU_TARGET static int CPU_NAME(ewChain)(const T* xr, const T* xi, T* yr, T* yi, T* dr, T* di, mwSize numel,
+                                        const std::vector< Stage<T> >& stages, V*) {
+    const int ns=(int)stages.size();
+    const bool doDer=(dr!=NULL);
+    const long nb=((long)numel+EW_BLOCK-1)/EW_BLOCK;
+    int err=0;
+    #pragma omp parallel reduction(|:err)
+    {
+        V u[EW_BLOCK], d[EW_BLOCK];
+        #pragma omp for
+        for (long b=0;b<nb;b++) {
+            const mwSize n0=(mwSize)b*EW_BLOCK;
+            const int len=(int)((numel-n0<EW_BLOCK) ? numel-n0 : EW_BLOCK);
+            int zero=0, neg=0;
+            for (int j=0;j<len;j++)
+                u[j]=loadV(xr,xi,n0+j,(V*)NULL);
+            if (doDer)
+                for (int j=0;j<len;j++)
+                    d[j]=V(1);
+            for (int k=0;k<ns;k++) {
+                const Stage<T>& s=stages[k];
+                switch (s.code) {
+                    case EW_ABS:
+                        if (doDer) {
+                            for (int j=0;j<len;j++) {
+                                T a=std::abs(u[j]);
+                                zero|=(a==T(0));
+                                d[j]*=u[j]/a;
+                                u[j]=V(a);
+                            }
+                        } else {
+                            for (int j=0;j<len;j++)
+                                u[j]=V(std::abs(u[j]));
+                        }
+                        break;
+                    case EW_SQRT:
+                        for (int j=0;j<len;j++) {
+                            neg|=negativeV(u[j]);
+                            u[j]=sqrtV(u[j]);
+                        }
+                        if (doDer)
+                            for (int j=0;j<len;j++)
+                                d[j]*=V(1)/(V(2)*u[j]);
+                        break;
+                    case EW_INVERSE:
+                        for (int j=0;j<len;j++) {
+                            zero|=(u[j]==V(0));
+                            u[j]=V(1)/u[j];
+                        }
+                        if (doDer)
+                            for (int j=0;j<len;j++)
+                                d[j]*=-u[j]*u[j];
+                        break;
+                    case EW_SQMAG:
+                        if (doDer)
+                            for (int j=0;j<len;j++)
+                                d[j]*=V(2)*u[j];
+                        for (int j=0;j<len;j++) {
+                            T a=std::abs(u[j]);
+                            u[j]=V(a*a);
+                        }
+                        break;
+                    case EW_COEF:
+                        if (s.full) {
+                            for (int j=0;j<len;j++)
+                                u[j]*=loadV(s.cr,s.ci,n0+j,(V*)NULL);
+                            if (doDer)
+                                for (int j=0;j<len;j++)
+                                    d[j]*=conjV(loadV(s.cr,s.ci,n0+j,(V*)NULL));
+                        } else {
+                            const V c=loadV(s.cr,s.ci,0,(V*)NULL);
+                            for (int j=0;j<len;j++)
+                                u[j]*=c;
+                            if (doDer)
+                                for (int j=0;j<len;j++)
+                                    d[j]*=conjV(c);
+                        }
+                        break;
+                }
+            }
+            for (int j=0;j<len;j++)
+                storeV(u[j],yr,yi,n0+j);
+            if (doDer)
+                for (int j=0;j<len;j++)
+                    storeV(d[j],dr,di,n0+j);
+            if (zero) err|=ERR_ZERO;
+            if (neg) err|=ERR_NEGATIVE;
+        }
+    }
+    return err;
+}
+#undef CPU_VARIANT
+#endif
@@ -0,0 +1,24 @@
+% function [y,d]=ewChain(x,codes,coefs)
+%
+%  Applies a chain of element-wise operators to x in a single pass and,
+%  if requested, computes the product d of the derivatives of the stages
+%  (the Jacobian-transpose product of the chain is then d.*w). The stages
+%  are given in order of application by codes: 1 (abs), 2 (sqrt),
+%  3 (inverse), 4 (squared magnitude), 5 (multiplication by coefs{k}).
+%  Mex implementation used by MapComposition for chains of OpEWAbs,
+%  OpEWSqrt, OpEWInverse, OpEWSquaredMagnitude and LinOpDiag.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
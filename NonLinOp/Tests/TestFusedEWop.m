@@ -0,0 +1,49 @@
+%-----------------------------------------------------------
+% TestFusedEWop script
+%
+% Check the fused evaluation of chains of element-wise Maps
+% (MapComposition, MapSummation and MapMultiplication of OpEW* and
+% LinOpDiag) against the closed-form expressions.
+%
+%-----------------------------------------------------------
+
+% Parameters
+sz=[64 48];
+x=rand(sz)+0.5;
+xc=x+1i*(rand(sz)-0.5);
+w=rand(sz);
+D=rand(sz)+0.1;
+
+%% Chain of element-wise operators: 2*D.*sqrt(1./abs(x).^2)
+sq=OpEWSquaredMagnitude(sz); iv=OpEWInverse(sz); sqr=OpEWSqrt(sz);
+H=2*LinOpDiag(sz,D)*sqr*iv*sq;
+assert(H.isElementWise && isa(H,'MapComposition') && length(H.ewMaps)==4,'Chain not flattened');
+y=H*xc;
+yref=2*D.*sqrt(1./abs(xc).^2);
+disp(['Chain apply max error          : ',num2str(max(abs(y(:)-yref(:))))]);
+g=H.applyJacobianT(w,xc);
+gref=2*D.*(1./(2*sqrt(1./abs(xc).^2))).*(-1./(abs(xc).^4)).*(2*xc).*w;
+disp(['Chain applyJacobianT max error : ',num2str(max(abs(g(:)-gref(:))))]);
+
+%% Chain with a generic element-wise function: exp(abs(x))
+ex=OpEWfunc(sz,@exp,@exp);
+H=ex*OpEWAbs(sz);
+y=H*xc;
+g=H.applyJacobianT(w,xc);
+disp(['EWfunc apply max error          : ',num2str(max(abs(y(:)-exp(abs(xc(:))))))]);
+gref=exp(abs(xc)).*xc./abs(xc).*w;
+disp(['EWfunc applyJacobianT max error : ',num2str(max(abs(g(:)-gref(:))))]);
+
+%% Sum and product of element-wise chains: sqrt(x).*(1./x) + 3*x.^2
+H=(sqr.*iv)+3*sq;
+assert(H.isElementWise,'Summation not element-wise');
+y=H*x;
+g=H.applyJacobianT(w,x);
+disp(['Sum/product apply max error          : ',num2str(max(abs(y(:)-(1./sqrt(x(:))+3*x(:).^2))))]);
+gref=(-0.5*x.^(-1.5)+6*x).*w;
+disp(['Sum/product applyJacobianT max error : ',num2str(max(abs(g(:)-gref(:))))]);
+
+%% Single precision
+H=LinOpDiag(sz,2)*sqr*sq;
+y=H*single(xc);
+disp(['Single apply max error : ',num2str(max(abs(y(:)-2*abs(single(xc(:))))))]);
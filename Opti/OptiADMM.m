@@ -28,6 +28,20 @@ classdef OptiADMM < Opti
     %
     %  - Otherwise the solver is required.
     %
+    %  - When all the \(\mathrm{H_n}\) (and the :class:`LinOp` of \(F_0\)) are circular convolutions
+    %    (:class:`LinOpConv`, :class:`LinOpGrad` and :class:`LinOpHess` with circular boundary conditions,
+    %    scaled identities), the operator \(\sum_{n} \rho_n \mathrm{H_n}^*\mathrm{H_n}\) is diagonalized by
+    %    the DFT. This is detected at construction: the real spectra of the \(\mathrm{H_n}^*\mathrm{H_n}\) are
+    %    computed once and the linear step is solved with one pair of FFTs (the denominator is updated
+    %    if rho_n is modified).
+    %
+    % **Note** The proximity operators of the \(F_n\) and the applications of the \(\mathrm{H_n}\) are
+    % independent across the splits. Setting the property numWorkers to a positive value dispatches them
+    % to the workers of the current thread-based parallel pool (parpool('threads'), parfor with per-split
+    % buffers), the results being joined before the x-update. With numWorkers=0 (default), without parallel
+    % pool or with a process-based pool, the splits are processed sequentially: the Maps would otherwise be
+    % serialized to the workers at every iteration and their memoize caches lost (see threadWorkers).
+    %
     % **Reference**
     %
     % [1] Boyd, Stephen, et al. "Distributed optimization and statistical learning via the alternating direction
@@ -76,11 +90,21 @@ classdef OptiADMM < Opti
         % GlobalBioIm
         prevIterCG=20;
     end
+    % Cached spectra of the Fourier-diagonal solver (when used)
+    properties (SetAccess = protected,GetAccess = public)
+        fourierA=[];           % real spectrum of A (for the rho_n given at construction)
+        fourierHtH={};         % real spectra of the Hn'*Hn
+        fourierRho0;           % rho_n used to build A
+        fourierRho;            % rho_n corresponding to fourierInv
+        fourierInv=[];         % inverse of the current spectrum of the linear step
+        fourierSym=false;      % true if A is a real operator (Hermitian spectrum)
+    end
     % Full public properties
     properties
         rho_n;                 % vector containing the multipliers
         CG;                    % conjugate gradient algo (Opti Object, when used)
         maxiterCG=20;
+        numWorkers=0;          % maximum number of workers processing the splits in parallel (0: sequential, thread-based pool only)
     end
     
     methods
@@ -154,7 +178,10 @@ classdef OptiADMM < Opti
                         error('If F0 is not a CostL2 / CostL2Composition / CostSummation of them, a solver is required in ADMM');
                     end
                 end
-                if ~this.A.isInvertible  % If A is non invertible -> intanciate a CG
+                if all(cellfun(@OptiADMM.isFourierDiagonal,this.Hn)) && OptiADMM.isFourierDiagonalCost(this.F0)
+                    this.initFourierSolver();
+                end
+                if isempty(this.fourierInv) && ~this.A.isInvertible  % If A is non invertible -> intanciate a CG
                     this.CG=OptiConjGrad(this.A,zeros_(this.A.sizeout));
                     this.CG.verbose=0;
                     this.CG.maxiter=this.maxiterCG;
@@ -199,9 +226,13 @@ classdef OptiADMM < Opti
         end
         function flag=doIteration(this)
             % Reimplementation from :class:`Opti`. For details see [1].
-            for n=1:length(this.Fn)
-                this.yn{n}=this.Fn{n}.applyProx(this.Hnx{n} - this.wn{n},1/this.rho_n(n));
+            Fn=this.Fn; Hnx=this.Hnx; wn=this.wn; rho=this.rho_n;
+            yn=cell(size(Fn));
+            nw=threadWorkers(this.numWorkers);
+            parfor (n=1:length(Fn),nw)
+                yn{n}=Fn{n}.applyProx(Hnx{n} - wn{n},1/rho(n));
             end
+            this.yn=yn;
             if isempty(this.solver)
                 b=this.rho_n(1)*this.Hn{1}.applyAdjoint(this.yn{1}+this.wn{1});
                 for n=2:length(this.Hn)
@@ -210,7 +241,9 @@ classdef OptiADMM < Opti
                 if ~isempty(this.b0)
                     b=b+this.b0;
                 end
-                if this.A.isInvertible
+                if ~isempty(this.fourierInv)
+                    this.xopt=this.solveFourier(b);
+                elseif this.A.isInvertible
                     this.xopt=this.A.applyInverse(b);
                 else
                     this.CG.set_b(b);
@@ -224,13 +257,118 @@ classdef OptiADMM < Opti
                 this.xopt=this.solver(zn,this.rho_n, this.xopt);
                 clear zn;
             end
-            for n=1:length(this.wn)
-                this.Hnx{n}=this.Hn{n}.apply(this.xopt);
-                this.wn{n}=this.wn{n} - (this.Hnx{n}-this.yn{n});
+            Hn=this.Hn; xopt=this.xopt;
+            parfor (n=1:length(wn),nw)
+                Hnx{n}=Hn{n}.apply(xopt);
+                wn{n}=wn{n} - (Hnx{n}-yn{n});
             end
+            this.Hnx=Hnx; this.wn=wn;
             flag=0;
         end
-        
-        
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (not when the linear step is solved by conjugate gradient, whose steps are global).
+            tf=isempty(this.CG);
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`.
+            st=getState@Opti(this);
+            st.yn=this.yn; st.wn=this.wn; st.Hnx=this.Hnx; st.rho_n=this.rho_n;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.yn=st.yn; this.wn=st.wn; this.Hnx=st.Hnx; this.rho_n=st.rho_n;
+        end
+        function [f,args]=costEvaluator(this)
+            % Reimplementation from :class:`Opti`: the cost of each split
+            % is evaluated at Hnx (computed at the end of doIteration)
+            if isempty(this.Hnx) || ~isempty(this.batchDim)
+                [f,args]=costEvaluator@Opti(this);
+            else
+                f=@OptiADMM.splitCost;
+                args={this.F0,this.Fn,this.xopt,this.Hnx};
+            end
+        end
+    end
+    
+    methods (Access = protected)
+        function initFourierSolver(this)
+            % Computes the real spectra of A and of the Hn'*Hn by applying
+            % them to a Dirac. The solver is not used if A is not invertible.
+            e1=zeros_(this.A.sizein); e1(1)=1;
+            Ae1=this.A.apply(e1);
+            sA=real(fftn(Ae1));
+            if min(sA(:)) <= 1e-12*max(sA(:)), return; end
+            this.fourierA=sA;
+            this.fourierSym=isreal(Ae1);
+            for n=1:length(this.Hn)
+                this.fourierHtH{n}=real(fftn(this.Hn{n}.applyHtH(e1)));
+            end
+            this.fourierRho0=this.rho_n;
+            this.fourierRho=this.rho_n;
+            this.fourierInv=1./sA;
+        end
+        function x=solveFourier(this,b)
+            % Solves A x = b in the Fourier domain, A being built with the
+            % current rho_n
+            if any(this.rho_n(:)~=this.fourierRho(:))
+                den=this.fourierA;
+                for n=1:length(this.Hn)
+                    den=den+(this.rho_n(n)-this.fourierRho0(n))*this.fourierHtH{n};
+                end
+                this.fourierInv=1./den;
+                this.fourierRho=this.rho_n;
+            end
+            if this.fourierSym && isreal(b)
+                x=ifftn(fftn(b).*this.fourierInv,'symmetric');
+            else
+                x=ifftn(fftn(b).*this.fourierInv);
+            end
+        end
+    end
+    
+    methods (Static, Access = protected)
+        function cc=splitCost(F0,Fn,x,Hnx)
+            % Cost F0(x) + sum_n Fn(Hn x) from the stored Hn x
+            cc=0;
+            if ~isempty(F0), cc=F0.apply(x); end
+            for n=1:length(Fn)
+                cc=cc+Fn{n}.apply(Hnx{n});
+            end
+        end
+        function b=isFourierDiagonal(H)
+            % True if H'*H is a circular convolution along all the dimensions
+            if isa(H,'LinOpConv')
+                b=isempty(H.Notindex);
+                if ~b   % the mtf has to be constant along the non-convolved dimensions
+                    idx=repmat({':'},1,ndims(H.mtf));
+                    idx(H.Notindex(H.Notindex<=ndims(H.mtf)))={1};
+                    b=~any(reshape(bsxfun(@minus,H.mtf,H.mtf(idx{:})),[],1));
+                end
+            elseif isa(H,'LinOpGrad') || isa(H,'LinOpHess')
+                b=strcmp(H.bc,'circular');
+            elseif isa(H,'LinOpDiag')
+                b=H.isScaledIdentity;
+            elseif isa(H,'LinOpComposition') && isa(H.H1,'LinOpDiag') && H.H1.isScaledIdentity
+                b=OptiADMM.isFourierDiagonal(H.H2);
+            else
+                b=false;
+            end
+        end
+        function b=isFourierDiagonalCost(F)
+            % True if the part of A coming from F0 is a circular convolution
+            if isempty(F) || isa(F,'CostL2')
+                b=true;
+            elseif isa(F,'CostL2Composition')
+                W=F.H1.W;
+                b=OptiADMM.isFourierDiagonal(F.H2) && (isnumeric(W) && isscalar(W) || isa(W,'LinOpDiag') && W.isScaledIdentity);
+            elseif isa(F,'CostMultiplication') && F.isnum
+                b=OptiADMM.isFourierDiagonalCost(F.cost2);
+            elseif isa(F,'CostSummation')
+                b=all(cellfun(@OptiADMM.isFourierDiagonalCost,F.mapsCell));
+            else
+                b=false;
+            end
+        end
     end
 end
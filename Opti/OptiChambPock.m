@@ -6,7 +6,7 @@ classdef OptiChambPock < Opti
     % :param G: a :class:`Cost` with an implementation of the :meth:`prox`.
     % :param H: a :class:`LinOp`.
     % :param tau: parameter of the algorithm (default 1)
-    % :param sig: parameter of the algorithm which is computed automatically if H.norm is different from -1.
+    % :param sig: parameter of the algorithm which is computed automatically from the norm of H (see :meth:`getNorm` of :class:`Map`) if not set.
     % :param var: select the "bar" variable of the algorithm (see [1]):
     %
     %   - if 1 (default) then the primal variable \\(\\bar{\\mathrm{x}} = 2\\mathrm{x}_n  - \\mathrm{x}_{n-1}\\) is used 
@@ -107,9 +107,12 @@ classdef OptiChambPock < Opti
             % Reimplementation from :class:`Opti`.
             
             initialize@Opti(this,x0);
+            if isempty(this.sig) && ~isempty(this.tau)
+                this.sig=1/(this.tau*this.H.getNorm()^2)-eps;
+            end
+            assert(~isempty(this.sig),'parameter sig is not setted');
+            assert(~isempty(this.tau),'parameter tau is not setted');
             if ~isempty(x0) % To restart from current state if wanted
-                assert(~isempty(this.sig),'parameter sig is not setted');
-                assert(~isempty(this.tau),'parameter tau is not setted');
                 this.y=this.H.apply(x0);
                 if this.var==1
                     this.xbar=x0;
@@ -156,5 +159,23 @@ classdef OptiChambPock < Opti
             end
             flag=this.OPTI_NEXT_IT;
         end
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (the acceleration depends only on gam).
+            tf=true;
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti` (with the parameters updated by the acceleration).
+            st=getState@Opti(this);
+            st.y=this.y; st.xbar=this.xbar; st.Kxbar=this.Kxbar; st.Kxopt=this.Kxopt;
+            st.ybar=this.ybar; st.KTy=this.KTy; st.KTybar=this.KTybar;
+            st.tau=this.tau; st.sig=this.sig; st.theta=this.theta;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.y=st.y; this.xbar=st.xbar; this.Kxbar=st.Kxbar; this.Kxopt=st.Kxopt;
+            this.ybar=st.ybar; this.KTy=st.KTy; this.KTybar=st.KTybar;
+            this.tau=st.tau; this.sig=st.sig; this.theta=st.theta;
+        end
 	end
 end
@@ -8,6 +8,22 @@ classdef OptiConjGrad < Opti
     %
     % All attributes of parent class :class:`Opti` are inherited.
     %
+    % **Note** The algorithm can be preconditioned through the property
+    % precond which is either
+    %
+    %  - an array of the size of x containing the inverse of the diagonal of
+    %    \(\mathrm{A}\) (Jacobi preconditioner),
+    %  - a :class:`LinOp` approximating \(\mathrm{A}^{-1}\) (e.g. a
+    %    :class:`LinOpConv` with the inverse of the spectrum of a circulant
+    %    approximation of \(\mathrm{A}\), Fourier preconditioner).
+    %
+    % When the mex file cgFused is available (see buildConjGrad), the vector
+    % updates and inner products are fused into two passes per iteration
+    % (without preconditioner or with a Jacobi one; three near convergence,
+    % where beta is computed from the exact residual norm), the inner
+    % products being accumulated in double precision. Setting storageClass to 'single'
+    % stores the iterates, the residual and the direction in single precision.
+    %
     % **Example** CG=OptiConjGrad(A,b,OutOp)
     %
     % See also :class:`Opti`, :class:`OutputOpti` :class:`Cost`
@@ -36,8 +52,15 @@ classdef OptiConjGrad < Opti
     % Full protected properties
     properties (SetAccess = protected,GetAccess = protected)
         r; % residual
-        rho_prec;
+        rho_prec; % inner product of the residual and the preconditioned residual
         p;
+        w;        % Jacobi preconditioner in the class of the residual
+        useMex;   % true if the mex file cgFused is available
+    end
+    % Full public properties
+    properties
+        precond=[];       % preconditioner (see the note above)
+        storageClass=[];  % class of the iterates ('double' or 'single', empty: unchanged)
     end
     
     methods
@@ -48,6 +71,7 @@ classdef OptiConjGrad < Opti
             assert(checkSize(b,this.A.sizeout),'A sizeout and size of b must be equal');
             this.b=b;
             this.cost=CostL2(this.A.sizeout,0., this.A) - CostLinear(this.A.sizeout, this.b);
+            this.useMex=(exist('cgFused')==3);
         end
         %% Set data b
         function set_b(this,b)
@@ -63,8 +87,23 @@ classdef OptiConjGrad < Opti
             
             initialize@Opti(this,x0);
             if ~isempty(x0) % To restart from current state if wanted
+                if ~isempty(this.storageClass)
+                    this.xopt = cast(this.xopt,this.storageClass);
+                end
                 this.r = this.b - this.A.apply(this.xopt);
-                this.p = this.r;
+                if ~isempty(this.storageClass)
+                    this.r = cast(this.r,this.storageClass);
+                end
+            end
+            % Jacobi preconditioner in the class of the residual (also
+            % after resume, the residual being part of the state)
+            this.w = [];
+            if isnumeric(this.precond) && ~isempty(this.precond) && ~isempty(this.r)
+                this.w = cast(this.precond,class(gather(this.r(1))));
+            end
+            if ~isempty(x0)
+                this.p = this.applyPrecond(this.r);
+                this.rho_prec = real(dot(this.r(:),this.p(:)));
             end
         end
         function flag=doIteration(this)
@@ -72,24 +111,82 @@ classdef OptiConjGrad < Opti
             % algorithm scheme see `here
             % <https://en.wikipedia.org/wiki/Conjugate_gradient_method#The_resulting_algorithm>`_
             
-            rho = dot(this.r(:),this.r(:));
-            if this.niter > 0
-                beta = rho/this.rho_prec;
-                this.p = this.r + beta*this.p;
-            end
+            % The direction p is updated at the end of the iteration (it
+            % is the preconditioned residual at the first iteration)
+            rho = this.rho_prec;
             q = this.A*this.p;
-            alpha = rho/dot(this.p(:), q(:));
+            if this.useMex && isMexCompatible(this.xopt,this.r,this.p,q) && (isempty(this.w) || isMexCompatible(this.r,this.w))
+                % Fused updates: first pass for the inner products, second
+                % pass for x, r and p
+                d = cgFused('dots',this.p,q,this.r,this.w);
+                pq = d(1); pr = d(2);
+            else
+                pq = real(dot(this.p(:), q(:)));
+                pr = real(dot(this.p(:),this.r(:)));
+                d = [];
+            end
+            alpha = rho/pq;
             
             % stop if rounding errors
-            if dot(this.p(:),this.r(:))<=0
+            if pr<=0
                 this.endingMessage = [this.name ,'Rounding errors prevent further optimization'];
                 flag = this.OPTI_STOP;
                 return
             end
-            this.xopt = this.xopt + alpha*this.p;
-            this.r = this.r - alpha*q;
-            this.rho_prec = rho;
+            % <r,M r> after the update predicted from the inner products,
+            % used for beta only when the cancellation is negligible (far
+            % from convergence); otherwise beta is computed from the exact
+            % <r,M r> in a third pass
+            fused = ~isempty(d) && (isempty(this.precond) || ~isempty(this.w));
+            if fused
+                rhoNew = rho - 2*alpha*d(3) + alpha^2*d(4);
+                fused = rhoNew > sqrt(eps(class(this.r)))*(rho + 2*abs(alpha*d(3)) + alpha^2*d(4));
+            end
+            if fused
+                % rho_prec is the exact <r,M r> of the new residual
+                [this.xopt,this.r,this.p,this.rho_prec] = cgFused('update',this.xopt,this.r,this.p,q,alpha,rhoNew/rho,this.w);
+            else
+                if ~isempty(d)
+                    [this.xopt,this.r] = cgFused('step',this.xopt,this.r,this.p,q,alpha);
+                else
+                    this.xopt = this.xopt + alpha*this.p;
+                    this.r = this.r - alpha*q;
+                end
+                z = this.applyPrecond(this.r);
+                if ~isempty(d) && isMexCompatible(this.r,z)
+                    [this.p,this.rho_prec] = cgFused('direction',z,this.p,this.r,rho);
+                else
+                    this.rho_prec = real(dot(this.r(:),z(:)));
+                    this.p = z + (this.rho_prec/rho)*this.p;
+                end
+            end
             flag=this.OPTI_NEXT_IT;
         end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`.
+            st=getState@Opti(this);
+            st.r=this.r; st.p=this.p; st.rho_prec=this.rho_prec;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.r=st.r; this.p=st.p; this.rho_prec=st.rho_prec;
+        end
+    end
+    
+    methods (Access = protected)
+        function z = applyPrecond(this,r)
+            % Applies the preconditioner to the residual r
+            if isempty(this.precond)
+                z = r;
+            elseif ~isempty(this.w)
+                z = this.w.*r;
+            else
+                z = this.precond*r;
+                if ~isempty(this.storageClass)
+                    z = cast(z,this.storageClass);
+                end
+            end
+        end
     end
 end
@@ -74,5 +74,19 @@ classdef OptiDouglasRachford < Opti
             this.y = this.y + this.lambda .* ( this.F1.applyProx(2.*this.xopt- this.y,this.gamma(1)) - this.xopt);
             flag=this.OPTI_NEXT_IT;
         end
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (fixed parameters gamma and lambda).
+            tf=true;
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`.
+            st=getState@Opti(this);
+            st.y=this.y;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.y=st.y;
+        end
     end
 end
@@ -16,6 +16,8 @@ classdef OptiFBS < Opti
     % ensured by taking \\(\\gamma \\in (0,2/L] \\) where \\(L\\) is the Lipschitz constant of \\(\\nabla F\\) (see [1]).
     % When FISTA is used [3], \\(\\gamma \\) should be in \\((0,1/L]\\). For nonconvex functions [2] take \\(\\gamma \\in (0,1/L]\\).
     % If \\(L\\) is known (i.e. F.lip different from -1), parameter \\(\\gamma\\) is automatically set to \\(1/L\\).
+    % Otherwise, when \\(F\\) is a :class:`CostL2Composition` \\(\\|\\mathrm{Hx}-\\mathrm{y}\\|^2\\) and gam is not set,
+    % \\(L\\) is computed at initialization from the norm of \\(\\mathrm{H}\\) (see :meth:`getNorm` of :class:`Map`).
     %
     % **References**:
     %
@@ -87,8 +89,11 @@ classdef OptiFBS < Opti
             % Reimplementation from :class:`Opti`.
             
             initialize@Opti(this,x0);
+            if isempty(this.gam) && isa(this.F,'CostL2Composition') && this.F.H1.lip~=-1
+                this.gam=1/(this.F.H1.lip*this.F.H2.getNorm()^2);
+            end
+            assert(~isempty(this.gam),'parameter gam is not setted');
             if ~isempty(x0) % To restart from current state if wanted
-                assert(~isempty(this.gam),'parameter gam is not setted');
                 if this.fista
                     this.tk=1;
                     this.y=x0;
@@ -104,13 +109,13 @@ classdef OptiFBS < Opti
                 end
                 if this.fista
                     tmp=this.y;
-                    this.xopt=this.G.applyProx(this.y - this.gam.*this.F.applyGrad(this.y),this.gam);
                 else
                     tmp=this.xopt;
-                    this.xopt=this.G.applyProx(this.xopt - this.gam.*this.F.applyGrad(this.xopt),this.gam);
                 end
-                g = this.F*tmp;
-                grad = this.F.applyGrad(tmp);
+                % Value and gradient at the current point in one evaluation
+                % (the gradient is shared by the forward step and the test)
+                [g,grad] = this.F.applyAndGrad(tmp);
+                this.xopt=this.G.applyProx(tmp - this.gam.*grad,this.gam);
                 if isa(this.F,'CostPartialSummation')
                     this.F.subset = orig_subset;
                 end
@@ -150,5 +155,19 @@ classdef OptiFBS < Opti
             
             flag=this.OPTI_NEXT_IT;            
         end
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (not with the backtracking rule nor the momentum restart, which are global).
+            tf=~strcmp(this.updateGam,'backtracking') && ~(this.fista && this.momRestart);
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti` (with the step gam, updated by the backtracking).
+            st=getState@Opti(this);
+            st.y=this.y; st.tk=this.tk; st.gam=this.gam;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.y=st.y; this.tk=st.tk; this.gam=st.gam;
+        end
     end
 end
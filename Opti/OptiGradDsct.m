@@ -59,8 +59,10 @@ classdef OptiGradDsct < Opti
             initialize@Opti(this,x0);
             if this.nagd
                 this.needxold = true;
-                this.xold = x0;
-                this.y=x0;
+                if ~isempty(x0)
+                    this.xold = x0;
+                    this.y=x0;
+                end
             end
             if isempty(this.gam), error('Parameter gam is not setted'); end
         end
@@ -78,5 +80,19 @@ classdef OptiGradDsct < Opti
            
             flag=this.OPTI_NEXT_IT;
         end
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (fixed step gam).
+            tf=true;
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`.
+            st=getState@Opti(this);
+            st.y=this.y;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.y=st.y;
+        end
 	end
 end
@@ -25,6 +25,19 @@ classdef OptiPrimalDualCondat < Opti
     %     - \\sigma \\times \\Vert \\sum_n \\mathrm{H_n^*H_n}  \\Vert\\right)^{-1} \\in [1,2[ $$
     %     to ensure convergence (see [1, Theorem 5.1]).
     %
+    %   - When sig is not set (and tau is), it is computed at initialization as
+    %     $$ \\sigma = 0.99 \\left(\\frac{1}{\\tau} - \\frac{\\beta}{2}\\right) \\Big/ \\sum_n \\Vert \\mathrm{H_n} \\Vert^2 $$
+    %     where \\(\\sum_n \\Vert \\mathrm{H_n} \\Vert^2 \\) bounds \\(\\Vert \\sum_n \\mathrm{H_n^*H_n} \\Vert\\), the norms
+    %     being known or estimated once (see :meth:`getNorm` of :class:`Map`).
+    %
+    %   - When rho is not set, it is 1.95 if \\(F_0=0\\), and otherwise \\(0.99\\,\\delta\\) (at most 1.95), with
+    %     \\(\\delta\\) computed from the same bound (0.99 when \\(\\delta\\) cannot be computed, \\(\\delta\\) being
+    %     greater than 1 as soon as the condition on sig and tau holds).
+    %
+    %   - The dual updates are independent across the \(F_n\). Setting the property numWorkers to a
+    %     positive value dispatches them to the workers of the current thread-based parallel pool
+    %     (see :class:`OptiADMM`).
+    %
     % **Reference**
     %
     % [1] Laurent Condat, "A Primal-Dual Splitting Method for Convex Optimization Involving Lipchitzian, Proximable and Linear
@@ -65,7 +78,8 @@ classdef OptiPrimalDualCondat < Opti
     properties
         tau;       % parameter of the algorithm
         sig;       % parameter of the algorithm
-        rho=1.95;  % parameter of the algorithm
+        rho=[];    % parameter of the algorithm (see the note below)
+        numWorkers=0; % maximum number of workers processing the dual updates in parallel (0: sequential, thread-based pool only)
     end
     
     methods
@@ -102,9 +116,39 @@ classdef OptiPrimalDualCondat < Opti
                 end
             end
             % Check parameters
+            if isempty(this.sig) && ~isempty(this.tau)
+                beta=0;
+                if ~isempty(this.F0)
+                    assert(this.F0.lip~=-1,'parameter sig is not set and the Lipschitz constant of F0 is unknown');
+                    beta=this.F0.lip;
+                end
+                nrm2=0;
+                for n=1:length(this.Hn)
+                    nrm2=nrm2+this.Hn{n}.getNorm()^2;
+                end
+                assert(1/this.tau>beta/2,'parameter tau is too large: 1/tau should be greater than lip(F0)/2');
+                this.sig=0.99*(1/this.tau-beta/2)/nrm2;
+            end
             assert(~isempty(this.sig),'parameter sig is not set');
             assert(~isempty(this.tau),'parameter tau is not set');
-            assert(~isempty(this.rho),'parameter rho is not set');
+            if isempty(this.rho)
+                if isempty(this.F0)
+                    this.rho=1.95;
+                else
+                    % rho < delta (see the note), from the bound of ||sum_n Hn'*Hn||
+                    this.rho=0.99;
+                    if this.F0.lip~=-1
+                        nrm2=0;
+                        for n=1:length(this.Hn)
+                            nrm2=nrm2+this.Hn{n}.getNorm()^2;
+                        end
+                        d=1/this.tau-this.sig*nrm2;
+                        if d>this.F0.lip/2
+                            this.rho=min(1.95,0.99*(2-this.F0.lip/(2*d)));
+                        end
+                    end
+                end
+            end
         end
         function flag=doIteration(this)
             % Reimplementation from :class:`Opti`. For details see [1].
@@ -126,12 +170,29 @@ classdef OptiPrimalDualCondat < Opti
             % Update xopt
             this.xopt=this.rho*xtilde+(1-this.rho)*this.xopt;
             % Update ytilde and y
-            for n=1:length(this.Fn)
-                ytilde=this.Fn{n}.applyProxFench(this.y{n}+this.sig*this.Hn{n}.apply(2*xtilde-this.xold),this.sig);
-                this.y{n}=this.rho*ytilde +(1-this.rho)*this.y{n};
-            end  
+            Fn=this.Fn; Hn=this.Hn; y=this.y; sig=this.sig; rho=this.rho;
+            xbar=2*xtilde-this.xold;
+            parfor (n=1:length(Fn),threadWorkers(this.numWorkers))
+                ytilde=Fn{n}.applyProxFench(y{n}+sig*Hn{n}.apply(xbar),sig);
+                y{n}=rho*ytilde +(1-rho)*y{n};
+            end
+            this.y=y;
 
             flag=this.OPTI_NEXT_IT;
         end
+        function tf=batchSupported(this)
+            % Reimplementation from :class:`Opti` (fixed parameters tau, sig and rho).
+            tf=true;
+        end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`.
+            st=getState@Opti(this);
+            st.y=this.y;
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            this.y=st.y;
+        end
     end
 end
@@ -16,6 +16,13 @@ classdef OptiRichLucy < Opti
     % However, when TV is used, the positivity of the iterates is not ensured 
     % anymore if \\(\\lambda \\) is too large. Hence, \\(\\lambda \\) needs to be carefully chosen.
     %
+    % **Note** When the mex file richLucyUpdate is compiled (see
+    % buildRichLucy), the multiplicative update, the TV gradient (evaluated
+    % on the fly within the finite differences stencil) and the positivity
+    % check are computed in a single pass. When \\(\\mathrm{H}\\) is a real
+    % :class:`LinOpConv` acting on all dimensions, its MTF is kept and the
+    % convolutions are computed directly with real-output inverse FFTs.
+    %
     % **References**
     %
 	% [1] Lucy, Leon B. "An iterative technique for the rectification of observed distributions" The astronomical journal (1974)
@@ -63,6 +70,8 @@ classdef OptiRichLucy < Opti
         data;
         He1;
         bet;
+        mtf;    % MTF of F.H2 when it is a real LinOpConv acting on all dimensions (empty otherwise)
+        useMex; % true if the mex file richLucyUpdate is available
     end
    
     methods
@@ -87,6 +96,7 @@ classdef OptiRichLucy < Opti
                     this.cost=this.cost + this.lamb*CostMixNorm21([this.F.sizein,3],4)*this.G;
                 end
             end
+            this.useMex=(exist('richLucyUpdate')==3);
         end
         function initialize(this,x0)
             % Reimplementation from :class:`Opti`.
@@ -97,12 +107,30 @@ classdef OptiRichLucy < Opti
             this.bet=this.F.H1.bet;
             this.He1=max(this.F.H2.applyAdjoint(ones_(this.F.H2.sizeout)),this.bet);
             if this.bet==0, error('Smoothing parameter beta has to be different from 0 (see constructor of CostKullLeib)'); end;
+            % Keep the MTF when the convolution can be done with real-output inverse FFTs
+            H=this.F.H2;
+            this.mtf=[];
+            if isa(H,'LinOpConv') && ~H.useRFT && H.isReal && isempty(H.Notindex) && isreal(this.xopt) && isreal(this.data)
+                h=ifftn(H.mtf);
+                if max(abs(imag(h(:))))<=1e-12*max(abs(h(:)))  % Hermitian MTF (real PSF)
+                    this.mtf=H.mtf;
+                end
+            end
         end
         function flag=doIteration(this)
             % Reimplementation from :class:`Opti`. For details see [1-3].
             
-            if ~this.TV
-                this.xopt=this.xopt./this.He1.*this.F.H2.applyAdjoint(this.data./(this.F.H2.apply(this.xopt)+this.bet));
+            % Correction factor H'(data./(Hx+bet))
+            if isempty(this.mtf)
+                c=this.F.H2.applyAdjoint(this.data./(this.F.H2.apply(this.xopt)+this.bet));
+            else
+                c=ifftn(conj(this.mtf).*fftn(this.data./(ifftn(this.mtf.*fftn(this.xopt),'symmetric')+this.bet)),'symmetric');
+            end
+            nneg=0;
+            if this.useMex && isMexCompatible(this.xopt,c,this.He1)
+                [this.xopt,nneg]=richLucyUpdate(this.xopt,c,this.He1,this.TV*this.lamb,this.epsl);
+            elseif ~this.TV
+                this.xopt=this.xopt./this.He1.*c;
             else
                 tmp=this.G.apply(this.xopt);
                 if length(size(tmp))==2     % 1D
@@ -113,15 +141,21 @@ classdef OptiRichLucy < Opti
                     nor=repmat(sqrt(sum(tmp.^2,4)+this.epsl),[1,1,1,size(tmp,4)]);
                 end
                 gradReg=this.G.applyAdjoint(tmp./nor);
-                this.xopt=this.xopt./(this.He1 + this.lamb*gradReg).*this.F.H2.applyAdjoint(this.data./(this.F.H2.apply(this.xopt)+this.bet));
-                if sum(this.xopt(:)<0)~=0
-                    warnStruct = warning('off','backtrace');
-                    warning('Violation of the positivity of the solution (the regularization parameter should be decreased).');
-                    warning(warnStruct);
-                end
+                this.xopt=this.xopt./(this.He1 + this.lamb*gradReg).*c;
+                nneg=any(this.xopt(:)<0);
+            end
+            if this.TV && nneg~=0
+                warnStruct = warning('off','backtrace');
+                warning('Violation of the positivity of the solution (the regularization parameter should be decreased).');
+                warning(warnStruct);
             end
             flag=this.OPTI_NEXT_IT;
         end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti` (the other variables are
+            % set up by :meth:`initialize` from xopt and the cost).
+            st=getState@Opti(this);
+        end
  
 	end
 end
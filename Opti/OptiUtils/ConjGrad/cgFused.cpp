@@ -0,0 +1,228 @@
+#include <mex.h>
+#include <math.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  Fused vector operations of the (preconditioned) conjugate gradient used
+  by OptiConjGrad, with w either empty (no preconditioner) or the inverse
+  of the diagonal of A (Jacobi preconditioner, z=w.*r):
+
+     d = cgFused('dots',p,q,r,w)
+           d = [<p,q> <p,r> <q,w.*r> <q,w.*q>] in a single pass
+     [x,r,p,rho] = cgFused('update',x,r,p,q,alpha,beta,w)
+           x = x + alpha*p,  r = r - alpha*q,  z = w.*r,
+           p = z + beta*p,   rho = <r,z>      in a single pass
+     [x,r] = cgFused('step',x,r,p,q,alpha)
+           x = x + alpha*p,  r = r - alpha*q  (p is not modified)
+     [p,rho] = cgFused('direction',z,p,r,rhoOld)
+           rho = <r,z>, p = z + rho/rhoOld*p (for a preconditioner which
+           is not diagonal, z being computed by the caller)
+
+  With the dots of the first pass, the new residual norm
+     <r-alpha*q,w.*(r-alpha*q)> = <r,w.*r> - 2*alpha*<q,w.*r> + alpha^2*<q,w.*q>
+  can be predicted before the update (giving beta), such that one
+  iteration of the conjugate gradient needs two passes over the vectors
+  (plus the application of A). The update returns the exact rho=<r,z> of
+  the new residual. The outputs are new arrays written in the same pass
+  (the inputs are not modified).
+
+  All the vectors have the same size and class, double or single (real).
+  The inner products are accumulated in double precision.
+
+  Compilation:
+     -linux: mex cgFused.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildConjGrad.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+template <typename T>
+static void dots(const T* p, const T* q, const T* r, const T* w, long n, double* d) {
+    double pq=0, pr=0, qz=0, qwq=0;
+    if (w) {
+        #pragma omp parallel for simd reduction(+:pq,pr,qz,qwq)
+        for (long i=0;i<n;i++) {
+            double qi=q[i], wi=w[i];
+            pq+=(double)p[i]*qi;
+            pr+=(double)p[i]*r[i];
+            qz+=qi*wi*r[i];
+            qwq+=qi*wi*qi;
+        }
+    } else {
+        #pragma omp parallel for simd reduction(+:pq,pr,qz,qwq)
+        for (long i=0;i<n;i++) {
+            double qi=q[i];
+            pq+=(double)p[i]*qi;
+            pr+=(double)p[i]*r[i];
+            qz+=qi*r[i];
+            qwq+=qi*qi;
+        }
+    }
+    d[0]=pq; d[1]=pr; d[2]=qz; d[3]=qwq;
+}
+
+template <typename T>
+static void step(const T* x, const T* r, const T* p, const T* q, T alpha, long n, T* xo, T* ro) {
+    #pragma omp parallel for simd
+    for (long i=0;i<n;i++) {
+        xo[i]=x[i]+alpha*p[i];
+        ro[i]=r[i]-alpha*q[i];
+    }
+}
+
+template <typename T>
+static double update(const T* x, const T* r, const T* p, const T* q, const T* w, T alpha, T beta, long n,
+                     T* xo, T* ro, T* po) {
+    double rho=0;
+    if (w) {
+        #pragma omp parallel for simd reduction(+:rho)
+        for (long i=0;i<n;i++) {
+            T pi=p[i];
+            xo[i]=x[i]+alpha*pi;
+            T ri=r[i]-alpha*q[i];
+            T zi=w[i]*ri;
+            ro[i]=ri;
+            po[i]=zi+beta*pi;
+            rho+=(double)ri*zi;
+        }
+    } else {
+        #pragma omp parallel for simd reduction(+:rho)
+        for (long i=0;i<n;i++) {
+            T pi=p[i];
+            xo[i]=x[i]+alpha*pi;
+            T ri=r[i]-alpha*q[i];
+            ro[i]=ri;
+            po[i]=ri+beta*pi;
+            rho+=(double)ri*ri;
+        }
+    }
+    return rho;
+}
+
+template <typename T>
+static double direction(const T* z, const T* p, const T* r, double rhoOld, long n, T* po) {
+    double rho=0;
+    #pragma omp parallel for simd reduction(+:rho)
+    for (long i=0;i<n;i++)
+        rho+=(double)r[i]*z[i];
+    T beta=(T)(rho/rhoOld);
+    #pragma omp parallel for simd
+    for (long i=0;i<n;i++)
+        po[i]=z[i]+beta*p[i];
+    return rho;
+}
+
+// Output array of the size and class of ref, not initialized (written by the kernels)
+static mxArray* createOutput(const mxArray* ref) {
+    mxArray* out=mxCreateUninitNumericArray(mxGetNumberOfDimensions(ref),(mwSize*)mxGetDimensions(ref),mxGetClassID(ref),mxREAL);
+    if (out==NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    return out;
+}
+
+// Checks that v is a full real array of the class and number of elements of ref
+static void checkVector(const mxArray* v, const mxArray* ref, const char* msg) {
+    if (mxGetClassID(v)!=mxGetClassID(ref) || mxIsComplex(v) || mxIsSparse(v) ||
+        mxGetNumberOfElements(v)!=mxGetNumberOfElements(ref))
+        mexErrMsgTxt(msg);
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs<1 || !mxIsChar(prhs[0]))
+        mexErrMsgTxt("Usage: cgFused(command,...).\n");
+    char cmd[16];
+    mxGetString(prhs[0],cmd,sizeof(cmd));
+    KernelTimer timer("cgFused",cmd);
+    const char* errVec="All the vectors should be full real arrays of the same size and class (double or single).\n";
+
+    if (!strcmp(cmd,"dots")) {
+        if (nrhs!=5)
+            mexErrMsgTxt("Usage: d = cgFused('dots',p,q,r,w).\n");
+        const mxArray *p=prhs[1], *q=prhs[2], *r=prhs[3], *w=prhs[4];
+        if (!(mxIsDouble(p) || mxIsSingle(p)) || mxIsComplex(p) || mxIsSparse(p))
+            mexErrMsgTxt(errVec);
+        checkVector(q,p,errVec);
+        checkVector(r,p,errVec);
+        if (!mxIsEmpty(w)) checkVector(w,p,errVec);
+        long n=(long)mxGetNumberOfElements(p);
+        plhs[0]=mxCreateDoubleMatrix(1,4,mxREAL);
+        if (mxIsDouble(p))
+            dots<double>((const double*)mxGetData(p),(const double*)mxGetData(q),(const double*)mxGetData(r),
+                         mxIsEmpty(w) ? NULL : (const double*)mxGetData(w),n,mxGetPr(plhs[0]));
+        else
+            dots<float>((const float*)mxGetData(p),(const float*)mxGetData(q),(const float*)mxGetData(r),
+                        mxIsEmpty(w) ? NULL : (const float*)mxGetData(w),n,mxGetPr(plhs[0]));
+    } else if (!strcmp(cmd,"update")) {
+        if (nrhs!=8)
+            mexErrMsgTxt("Usage: [x,r,p,rho] = cgFused('update',x,r,p,q,alpha,beta,w).\n");
+        const mxArray *x=prhs[1], *r=prhs[2], *p=prhs[3], *q=prhs[4], *w=prhs[7];
+        if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsComplex(x) || mxIsSparse(x))
+            mexErrMsgTxt(errVec);
+        checkVector(r,x,errVec);
+        checkVector(q,x,errVec);
+        checkVector(p,x,errVec);
+        if (!mxIsEmpty(w)) checkVector(w,x,errVec);
+        double alpha=mxGetScalar(prhs[5]), beta=mxGetScalar(prhs[6]);
+        long n=(long)mxGetNumberOfElements(x);
+        plhs[0]=createOutput(x);
+        plhs[1]=createOutput(x);
+        plhs[2]=createOutput(x);
+        double rho;
+        if (mxIsDouble(x))
+            rho=update<double>((const double*)mxGetData(x),(const double*)mxGetData(r),(const double*)mxGetData(p),
+                               (const double*)mxGetData(q),mxIsEmpty(w) ? NULL : (const double*)mxGetData(w),alpha,beta,n,
+                               (double*)mxGetData(plhs[0]),(double*)mxGetData(plhs[1]),(double*)mxGetData(plhs[2]));
+        else
+            rho=update<float>((const float*)mxGetData(x),(const float*)mxGetData(r),(const float*)mxGetData(p),
+                              (const float*)mxGetData(q),mxIsEmpty(w) ? NULL : (const float*)mxGetData(w),(float)alpha,(float)beta,n,
+                              (float*)mxGetData(plhs[0]),(float*)mxGetData(plhs[1]),(float*)mxGetData(plhs[2]));
+        plhs[3]=mxCreateDoubleScalar(rho);
+    } else if (!strcmp(cmd,"step")) {
+        if (nrhs!=6)
+            mexErrMsgTxt("Usage: [x,r] = cgFused('step',x,r,p,q,alpha).\n");
+        const mxArray *x=prhs[1], *r=prhs[2], *p=prhs[3], *q=prhs[4];
+        if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsComplex(x) || mxIsSparse(x))
+            mexErrMsgTxt(errVec);
+        checkVector(r,x,errVec);
+        checkVector(p,x,errVec);
+        checkVector(q,x,errVec);
+        double alpha=mxGetScalar(prhs[5]);
+        long n=(long)mxGetNumberOfElements(x);
+        plhs[0]=createOutput(x);
+        plhs[1]=createOutput(x);
+        if (mxIsDouble(x))
+            step<double>((const double*)mxGetData(x),(const double*)mxGetData(r),(const double*)mxGetData(p),
+                         (const double*)mxGetData(q),alpha,n,(double*)mxGetData(plhs[0]),(double*)mxGetData(plhs[1]));
+        else
+            step<float>((const float*)mxGetData(x),(const float*)mxGetData(r),(const float*)mxGetData(p),
+                        (const float*)mxGetData(q),(float)alpha,n,(float*)mxGetData(plhs[0]),(float*)mxGetData(plhs[1]));
+    } else if (!strcmp(cmd,"direction")) {
+        if (nrhs!=5)
+            mexErrMsgTxt("Usage: [p,rho] = cgFused('direction',z,p,r,rhoOld).\n");
+        const mxArray *z=prhs[1], *p=prhs[2], *r=prhs[3];
+        if (!(mxIsDouble(z) || mxIsSingle(z)) || mxIsComplex(z) || mxIsSparse(z))
+            mexErrMsgTxt(errVec);
+        checkVector(p,z,errVec);
+        checkVector(r,z,errVec);
+        double rhoOld=mxGetScalar(prhs[4]);
+        long n=(long)mxGetNumberOfElements(z);
+        plhs[0]=createOutput(z);
+        double rho;
+        if (mxIsDouble(z))
+            rho=direction<double>((const double*)mxGetData(z),(const double*)mxGetData(p),(const double*)mxGetData(r),rhoOld,n,
+                                  (double*)mxGetData(plhs[0]));
+        else
+            rho=direction<float>((const float*)mxGetData(z),(const float*)mxGetData(p),(const float*)mxGetData(r),rhoOld,n,
+                                 (float*)mxGetData(plhs[0]));
+        if (nlhs>1) plhs[1]=mxCreateDoubleScalar(rho);
+    } else {
+        mexErrMsgTxt("Unknown command.\n");
+    }
+}
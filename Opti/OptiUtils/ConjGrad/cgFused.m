@@ -0,0 +1,28 @@
+% function varargout=cgFused(command,...)
+%
+%  Fused vector operations of the conjugate gradient (w is empty or the
+%  Jacobi preconditioner, i.e. the inverse of the diagonal of A):
+%     d = cgFused('dots',p,q,r,w)          d=[<p,q> <p,r> <q,w.*r> <q,w.*q>]
+%     [x,r,p,rho] = cgFused('update',x,r,p,q,alpha,beta,w)
+%                    x=x+alpha*p, r=r-alpha*q, p=w.*r+beta*p, rho=<r,w.*r>
+%     [x,r] = cgFused('step',x,r,p,q,alpha)
+%     [p,rho] = cgFused('direction',z,p,r,rhoOld)
+%                    rho=<r,z>, p=z+rho/rhoOld*p
+%  Each command is a single pass over the vectors (double or single), the
+%  inner products being accumulated in double precision. Mex
+%  implementation used by OptiConjGrad.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
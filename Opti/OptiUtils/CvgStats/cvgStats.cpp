@@ -0,0 +1,78 @@
+#include <mex.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+
+/***************************************************************************
+  s = cvgStats(x,xold)
+
+  Statistics on the step between two successive iterates used by the
+  convergence tests (see TestCvg), computed in a single pass over x and
+  xold without any temporary array:
+       s = [ ||x-xold||  ||xold||  ||x||  max|x-xold| ]
+  (Euclidean norms, modulus for complex arrays). The sums of squares and the
+  maximum are accumulated in double precision.
+
+  Supported types: double and single, real or complex (the real and
+  imaginary parts are stored separately). x and xold must have the same
+  class and number of elements; one of them may be real when the other is
+  complex.
+
+  Compilation:
+     -linux: mex cvgStats.cpp -I../../../Util/Profiling CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildCvgStats.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+// xi/yi are NULL for real arrays
+template <typename T>
+static void cvgStats(const T* xr, const T* xi, const T* yr, const T* yi, long n, double* s) {
+    double dd=0, yy=0, xx=0, dmax=0;
+    if (!xi && !yi) {
+        #pragma omp parallel for simd reduction(+:dd,yy,xx) reduction(max:dmax)
+        for (long k=0;k<n;k++) {
+            double a=xr[k], b=yr[k], d=a-b;
+            dd+=d*d; yy+=b*b; xx+=a*a;
+            d=fabs(d);
+            dmax= d>dmax ? d : dmax;
+        }
+        s[3]=dmax;
+    } else {
+        #pragma omp parallel for simd reduction(+:dd,yy,xx) reduction(max:dmax)
+        for (long k=0;k<n;k++) {
+            double a=xr[k], ai=xi ? (double)xi[k] : 0, b=yr[k], bi=yi ? (double)yi[k] : 0;
+            double d=a-b, di=ai-bi, m=d*d+di*di;
+            dd+=m; yy+=b*b+bi*bi; xx+=a*a+ai*ai;
+            dmax= m>dmax ? m : dmax;
+        }
+        s[3]=sqrt(dmax);
+    }
+    s[0]=sqrt(dd); s[1]=sqrt(yy); s[2]=sqrt(xx);
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("cvgStats");
+    if (nrhs!=2)
+        mexErrMsgTxt("Usage: s = cvgStats(x,xold).\n");
+    const mxArray *x=prhs[0], *y=prhs[1];
+    if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsSparse(x))
+        mexErrMsgTxt("x should be a full double or single array.\n");
+    if (mxGetClassID(y)!=mxGetClassID(x) || mxIsSparse(y) || mxGetNumberOfElements(y)!=mxGetNumberOfElements(x))
+        mexErrMsgTxt("xold should be a full array of the same class and number of elements as x.\n");
+
+    long n=(long)mxGetNumberOfElements(x);
+    plhs[0]=mxCreateDoubleMatrix(1,4,mxREAL);
+    double* s=mxGetPr(plhs[0]);
+    if (mxIsDouble(x))
+        cvgStats<double>((const double*)mxGetData(x),mxIsComplex(x) ? (const double*)mxGetImagData(x) : NULL,
+                         (const double*)mxGetData(y),mxIsComplex(y) ? (const double*)mxGetImagData(y) : NULL,n,s);
+    else
+        cvgStats<float>((const float*)mxGetData(x),mxIsComplex(x) ? (const float*)mxGetImagData(x) : NULL,
+                        (const float*)mxGetData(y),mxIsComplex(y) ? (const float*)mxGetImagData(y) : NULL,n,s);
+}
@@ -0,0 +1,156 @@
+#ifndef CPU_VARIANT
+#include <mex.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "kernelTimer.h"
+#include "cpuDispatch.h"
+
+/***************************************************************************
+  [xn,nneg] = richLucyUpdate(x,c,He1,lamb,epsl)
+
+  Multiplicative update of the Richardson-Lucy algorithm (see OptiRichLucy)
+       xn = x ./ (He1 + lamb*gradReg) .* c
+  where c is the correction factor H'(data./(Hx+bet)) and gradReg the
+  gradient of the smoothed TV regularizer
+       gradReg = G'( Gx ./ sqrt(sum_k (Gx)_k.^2 + epsl) )
+  with G the finite differences with circular boundary conditions (see
+  LinOpGrad). The normalized gradient is evaluated on the fly within the
+  stencil so that neither Gx nor its normalization is stored. When
+  lamb==0, gradReg is not computed (plain Richardson-Lucy).
+
+  The second output nneg is the number of negative elements of xn,
+  counted in the same pass.
+
+  He1 can be either a scalar or an array of the size of x. A column vector
+  x is treated as a 1D signal (as in LinOpGrad), otherwise the finite
+  differences are taken along all the dimensions of x.
+
+  Supported types: double and single (real).
+
+  The update is compiled for several instruction sets and the variant is
+  chosen at run time (see cpuDispatch.h and cpuInfo).
+
+  Compilation:
+     -linux: mex richLucyUpdate.cpp -I../../../Util/Profiling -I../../../Util/CpuDispatch CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildRichLucy.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define MAXDIM 32
+
+// Normalization sqrt(sum_k (x(o+dp[k])-x(o))^2+epsl) at offset o
+template <typename T>
+static inline T normAt(const T* x, mwSignedIndex o, const mwSignedIndex* dp, int nd, T epsl) {
+    T s=epsl, xo=x[o];
+    for (int k=0;k<nd;k++) {
+        T g=x[o+dp[k]]-xo;
+        s+=g*g;
+    }
+    return sqrt(s);
+}
+
+// Variants of richLucyUpdate for each instruction set (see cpuDispatch.h)
+#define CPU_VARIANT CPU_GENERIC
+#include "richLucyUpdate.cpp"
+#define CPU_VARIANT CPU_SSE4
+#include "richLucyUpdate.cpp"
+#define CPU_VARIANT CPU_AVX2
+#include "richLucyUpdate.cpp"
+#define CPU_VARIANT CPU_AVX512
+#include "richLucyUpdate.cpp"
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    KernelTimer timer("richLucyUpdate");
+    if (nrhs!=5)
+        mexErrMsgTxt("Usage: [xn,nneg] = richLucyUpdate(x,c,He1,lamb,epsl).\n");
+    const mxArray *x=prhs[0], *c=prhs[1], *He1=prhs[2];
+    if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsSparse(x) || mxIsComplex(x))
+        mexErrMsgTxt("x should be a full real double or single array.\n");
+    if (mxGetClassID(c)!=mxGetClassID(x) || mxIsComplex(c) || mxIsSparse(c) || mxGetNumberOfElements(c)!=mxGetNumberOfElements(x))
+        mexErrMsgTxt("c should be a real array of the same size and class as x.\n");
+    if (mxGetClassID(He1)!=mxGetClassID(x) || mxIsComplex(He1) || mxIsSparse(He1) ||
+        (mxGetNumberOfElements(He1)!=1 && mxGetNumberOfElements(He1)!=mxGetNumberOfElements(x)))
+        mexErrMsgTxt("He1 should be a real scalar or an array of the same size and class as x.\n");
+    double lamb=mxGetScalar(prhs[3]), epsl=mxGetScalar(prhs[4]);
+
+    int nd=mxGetNumberOfDimensions(x);
+    const mwSize* dims=mxGetDimensions(x);
+    if (nd>MAXDIM)
+        mexErrMsgTxt("Too many dimensions.\n");
+    if (nd==2 && dims[1]==1) nd=1;   // column vector: 1D signal (as in LinOpGrad)
+
+    plhs[0]=mxCreateNumericArray(mxGetNumberOfDimensions(x), dims, mxGetClassID(x), mxREAL);
+    if (plhs[0] == NULL)
+        mexErrMsgTxt("Could not create mxArray.\n");
+    mwSize nneg=0;
+    bool fullHe1=(mxGetNumberOfElements(He1)==mxGetNumberOfElements(x)) && mxGetNumberOfElements(x)>1;
+    if (mxGetNumberOfElements(x)>0) {
+        int isa=cpuIsa();
+        if (mxIsDouble(x))
+            nneg=CPU_CALL(isa,richLucyUpdate,((const double*)mxGetData(x),(const double*)mxGetData(c),(const double*)mxGetData(He1),
+                                              fullHe1,lamb,epsl,(double*)mxGetData(plhs[0]),nd,dims));
+        else
+            nneg=CPU_CALL(isa,richLucyUpdate,((const float*)mxGetData(x),(const float*)mxGetData(c),(const float*)mxGetData(He1),
+                                              fullHe1,(float)lamb,(float)epsl,(float*)mxGetData(plhs[0]),nd,dims));
+    }
+    if (nlhs>1)
+        plhs[1]=mxCreateDoubleScalar((double)nneg);
+}
+
+#else
+template <typename T>
+CPU_TARGET static mwSize CPU_NAME(richLucyUpdate)(const T* x, const T* c, const T* He1, bool fullHe1, T lamb, T epsl,
+                                                 T* y, int nd, const mwSize* sz) {
+    mwSignedIndex stride[MAXDIM];
+    stride[0]=1;
+    for (int k=1;k<nd;k++) stride[k]=stride[k-1]*sz[k-1];
+    mwSize n0=sz[0], nLines=1;
+    for (int k=1;k<nd;k++) nLines*=sz[k];
+    const bool doTV=(lamb!=0);
+    mwSize nneg=0;
+
+    #pragma omp parallel for reduction(+:nneg)
+    for (long l=0;l<(long)nLines;l++) {
+        // Offsets to the +e_k / -e_k neighbours (circular) for the dimensions k>=1
+        mwSignedIndex dp[MAXDIM], dm[MAXDIM], dq[MAXDIM];
+        mwSize r=(mwSize)l;
+        for (int k=1;k<nd;k++) {
+            mwSize ck=r%sz[k];
+            r/=sz[k];
+            dp[k]=(ck==sz[k]-1) ? -(mwSignedIndex)(sz[k]-1)*stride[k] : stride[k];
+            dm[k]=(ck==0) ? (mwSignedIndex)(sz[k]-1)*stride[k] : -stride[k];
+        }
+        mwSignedIndex base=(mwSignedIndex)l*(mwSignedIndex)n0;
+        for (mwSize i0=0;i0<n0;i0++) {
+            mwSignedIndex o=base+(mwSignedIndex)i0;
+            T den=fullHe1 ? He1[o] : He1[0];
+            if (doTV) {
+                dp[0]=(i0==n0-1) ? -(mwSignedIndex)(n0-1) : 1;
+                dm[0]=(i0==0) ? (mwSignedIndex)(n0-1) : -1;
+                T xo=x[o];
+                T nrm=normAt(x,o,dp,nd,epsl);
+                T gradReg=0;
+                for (int k=0;k<nd;k++) {
+                    // Point q=o-e_k: its +e_k neighbour is o, the others are unchanged
+                    mwSignedIndex q=o+dm[k];
+                    for (int m=0;m<nd;m++) dq[m]=dp[m];
+                    dq[k]=-dm[k];
+                    gradReg+=(xo-x[q])/normAt(x,q,dq,nd,epsl) - (x[o+dp[k]]-xo)/nrm;
+                }
+                den+=lamb*gradReg;
+            }
+            T v=x[o]/den*c[o];
+            y[o]=v;
+            if (v<0) nneg++;
+        }
+    }
+    return nneg;
+}
+#undef CPU_VARIANT
+#endif
@@ -0,0 +1,23 @@
+% function [xn,nneg]=richLucyUpdate(x,c,He1,lamb,epsl)
+%
+%  Multiplicative update of the Richardson-Lucy algorithm
+%       xn = x./(He1 + lamb*gradReg).*c
+%  where c=H'(data./(Hx+bet)) and gradReg is the gradient of the smoothed
+%  TV (circular finite differences along all the dimensions of x),
+%  evaluated on the fly within the stencil. nneg is the number of negative
+%  elements of xn. Mex implementation used by OptiRichLucy.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
@@ -0,0 +1,444 @@
+#include <mex.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+
+/***************************************************************************
+  Native VMLMB engine (limited memory variable metric with bound
+  constraints) driven by reverse communication from OptiVMLMB.
+
+     ws = vmlmbEngine('create',n,m,precision,opts)
+           n         : number of variables
+           m         : number of memorized correction pairs
+           precision : 'double' or 'single', storage class of the workspace
+                       (history, saved iterate/gradient and search direction)
+           opts      : [sftol epsilon delta fatol frtol gatol grtol xatol xrtol]
+     [task,x] = vmlmbEngine('iterate',ws,x,f,g,xmin,xmax)
+           task=1 (FG): the cost and its gradient have to be computed at
+                        the returned x and passed to the next call,
+           task=3 (NEWX): x is a new iterate,
+           task=4 (CONV): convergence,
+           task=5 (WARN) or 6 (ERROR): the algorithm cannot progress.
+           The returned x is a new array (the input is never modified).
+           xmin/xmax are either empty, scalars or arrays of the size of x.
+     msg = vmlmbEngine('reason',ws)
+     vmlmbEngine('destroy',ws)
+
+  The search direction is given by the L-BFGS two-loop recursion
+  restricted to the free variables (those which are not blocked by a bound
+  with a gradient pushing outside), the history being stored in the chosen
+  precision. The line search is a backtracking (Armijo) search along the
+  projected path, the trial points being projected onto the bounds in the
+  same pass as the update. The vector operations (dot products, axpy with
+  projection, free variables and norms) are OpenMP SIMD loops with double
+  precision accumulators.
+
+  Supported types: double and single (real) for x and g.
+
+  Compilation:
+     -linux: mex vmlmbEngine.cpp CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildVMLMBEngine.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+#define TASK_FG    1
+#define TASK_NEWX  3
+#define TASK_CONV  4
+#define TASK_WARN  5
+#define TASK_ERROR 6
+
+#define STAGE_START  0
+#define STAGE_LNSRCH 1
+#define STAGE_NEWX   2
+#define STAGE_DONE   3
+
+#define STPMIN 1e-20
+
+// Bounds: empty (no bound), scalar or one value per variable
+template <typename X> struct Bound {
+    const X* v;
+    bool full;
+    inline bool has() const {return v!=NULL;}
+    inline X at(mwSize i) const {return full ? v[i] : v[0];}
+};
+
+template <typename X>
+static inline X project(X v, mwSize i, const Bound<X>& lo, const Bound<X>& up) {
+    if (lo.has() && v<lo.at(i)) v=lo.at(i);
+    if (up.has() && v>up.at(i)) v=up.at(i);
+    return v;
+}
+
+template <typename X>
+static inline bool isFree(X x, X g, mwSize i, const Bound<X>& lo, const Bound<X>& up) {
+    if (lo.has() && x<=lo.at(i) && g>0) return false;
+    if (up.has() && x>=up.at(i) && g<0) return false;
+    return true;
+}
+
+class WorkspaceBase {
+public:
+    std::string reason;
+    virtual ~WorkspaceBase() {}
+    virtual bool isSingle() const=0;
+};
+
+template <typename T>
+class Workspace : public WorkspaceBase {
+public:
+    mwSize n;
+    int m;
+    double sftol, epsilon, delta, fatol, frtol, gatol, grtol, xatol, xrtol;
+    std::vector<T> x0, g0, d, S, Y;   // S and Y: m pairs of n values
+    std::vector<double> sty;          // <s_k,y_k> of the stored pairs
+    int mp, mk;                       // number of stored pairs, index of the newest one
+    double f0, dg0, dgx, alpha, gtest;
+    int stage;
+    bool first;
+
+    Workspace(mwSize n_, int m_, const double* o) : n(n_), m(m_),
+        x0(n_), g0(n_), d(n_), S((size_t)n_*m_), Y((size_t)n_*m_), sty(m_,0.),
+        mp(0), mk(-1), f0(0), dg0(0), dgx(0), alpha(0), gtest(0), stage(STAGE_START), first(true) {
+        sftol=o[0]; epsilon=o[1]; delta=o[2]; fatol=o[3]; frtol=o[4];
+        gatol=o[5]; grtol=o[6]; xatol=o[7]; xrtol=o[8];
+    }
+    bool isSingle() const {return sizeof(T)==sizeof(float);}
+
+    // Direction d from (x,g), returns the task
+    template <typename X>
+    int newDirection(X* xout, const X* x, double f, const X* g, const Bound<X>& lo, const Bound<X>& up) {
+        const long N=(long)n;
+        const bool bounded=lo.has() || up.has();
+        T* D=&d[0];
+
+        // Norm of the projected gradient and initial direction -g on the free variables
+        double gnorm2=0, xnorm2=0;
+        #pragma omp parallel for simd reduction(+:gnorm2,xnorm2)
+        for (long i=0;i<N;i++) {
+            X gi=isFree(x[i],g[i],(mwSize)i,lo,up) ? g[i] : X(0);
+            D[i]=(T)(-gi);
+            gnorm2+=(double)gi*(double)gi;
+            xnorm2+=(double)x[i]*(double)x[i];
+        }
+        double gnorm=sqrt(gnorm2);
+        if (first) gtest=(gatol>grtol*gnorm) ? gatol : grtol*gnorm;
+        if (gnorm<=gtest) {
+            reason="Gradient tolerance reached";
+            return TASK_CONV;
+        }
+
+        // L-BFGS two-loop recursion restricted to the free variables (d holds -g masked)
+        bool scaled=false;
+        if (mp>0) {
+            std::vector<double> rho(m,0.), a(m,0.);
+            double gamma=0;
+            for (int j=0;j<mp;j++) {
+                int k=(mk-j+m)%m;
+                double sy=sty[k], yy=0;
+                const T* Sk=&S[(size_t)k*n];
+                const T* Yk=&Y[(size_t)k*n];
+                if (bounded) {
+                    sy=0;
+                    #pragma omp parallel for simd reduction(+:sy,yy)
+                    for (long i=0;i<N;i++) {
+                        if (isFree(x[i],g[i],(mwSize)i,lo,up)) {
+                            sy+=(double)Sk[i]*(double)Yk[i];
+                            yy+=(double)Yk[i]*(double)Yk[i];
+                        }
+                    }
+                } else if (gamma==0) {
+                    #pragma omp parallel for simd reduction(+:yy)
+                    for (long i=0;i<N;i++) yy+=(double)Yk[i]*(double)Yk[i];
+                }
+                if (sy>0) {
+                    rho[k]=1./sy;
+                    if (gamma==0 && yy>0) gamma=sy/yy;  // scaling from the newest valid pair
+                }
+            }
+            if (gamma>0) {
+                scaled=true;
+                for (int j=0;j<mp;j++) {
+                    int k=(mk-j+m)%m;
+                    if (rho[k]==0) continue;
+                    a[k]=rho[k]*dotFree(&S[(size_t)k*n],D,x,g,lo,up,bounded);
+                    axpyFree(-a[k],&Y[(size_t)k*n],D,x,g,lo,up,bounded);
+                }
+                #pragma omp parallel for simd
+                for (long i=0;i<N;i++) D[i]=(T)(gamma*(double)D[i]);
+                for (int j=mp-1;j>=0;j--) {
+                    int k=(mk-j+m)%m;
+                    if (rho[k]==0) continue;
+                    double b=rho[k]*dotFree(&Y[(size_t)k*n],D,x,g,lo,up,bounded);
+                    axpyFree(a[k]-b,&S[(size_t)k*n],D,x,g,lo,up,bounded);
+                }
+            }
+        }
+
+        // Check that d is a sufficient descent direction
+        double dg=0, dnorm2=0;
+        #pragma omp parallel for simd reduction(+:dg,dnorm2)
+        for (long i=0;i<N;i++) {
+            dg+=(double)D[i]*(double)g[i];
+            dnorm2+=(double)D[i]*(double)D[i];
+        }
+        if (scaled && (dg>=0 || (epsilon>0 && dg>-epsilon*sqrt(dnorm2)*gnorm))) scaled=false;
+        if (!scaled) {
+            // Steepest feasible descent direction
+            #pragma omp parallel for simd
+            for (long i=0;i<N;i++) D[i]=(T)(isFree(x[i],g[i],(mwSize)i,lo,up) ? -g[i] : X(0));
+            dg=-gnorm2;
+            double xnorm=sqrt(xnorm2);
+            alpha=(delta>0 && xnorm>0) ? delta*xnorm/gnorm : 1./gnorm;
+        } else {
+            alpha=1.;
+        }
+
+        // Save the starting point of the line search and compute the first trial point
+        f0=f; dg0=dg;
+        #pragma omp parallel for simd
+        for (long i=0;i<N;i++) {x0[i]=(T)x[i]; g0[i]=(T)g[i];}
+        trialPoint(xout,lo,up);
+        stage=STAGE_LNSRCH;
+        first=false;
+        return TASK_FG;
+    }
+
+    // Line search step: accept the trial point or backtrack
+    template <typename X>
+    int lineSearch(X* xout, const X* x, double f, const X* g, const Bound<X>& lo, const Bound<X>& up) {
+        const long N=(long)n;
+        if (f<=f0+sftol*dgx) {
+            // Update the history with s=x-x0 and y=g-g0
+            mk=(mk+1)%m;
+            T* Sk=&S[(size_t)mk*n];
+            T* Yk=&Y[(size_t)mk*n];
+            double sy=0, snorm2=0, xnorm2=0;
+            #pragma omp parallel for simd reduction(+:sy,snorm2,xnorm2)
+            for (long i=0;i<N;i++) {
+                double s=(double)x[i]-(double)x0[i], y=(double)g[i]-(double)g0[i];
+                Sk[i]=(T)s; Yk[i]=(T)y;
+                sy+=s*y; snorm2+=s*s; xnorm2+=(double)x[i]*(double)x[i];
+                xout[i]=x[i];
+            }
+            if (sy>0) {
+                sty[mk]=sy;
+                if (mp<m) mp++;
+            } else {
+                // Discard the pair (its slot held the oldest pair if the history was full)
+                mk=(mk-1+m)%m;
+                if (mp==m) mp--;
+            }
+            // Convergence in the function and in the variables
+            if (f<=fatol || fabs(f-f0)<=frtol*fmax(fabs(f),fabs(f0))) {
+                reason="Relative function reduction tolerance reached";
+                stage=STAGE_DONE;
+                return TASK_CONV;
+            }
+            double snorm=sqrt(snorm2);
+            if (snorm<=xatol || (xrtol>0 && snorm<=xrtol*sqrt(xnorm2))) {
+                reason="Relative norm variable reduction tolerance reached";
+                stage=STAGE_DONE;
+                return TASK_CONV;
+            }
+            stage=STAGE_NEWX;
+            return TASK_NEWX;
+        }
+        // Backtracking with a safeguarded quadratic interpolation
+        double q=f-f0-alpha*dg0, a=(q>0) ? -dg0*alpha*alpha/(2*q) : 0.5*alpha;
+        if (a<0.1*alpha) a=0.1*alpha;
+        if (a>0.5*alpha) a=0.5*alpha;
+        if (a<STPMIN) {
+            reason="Line search step too small";
+            #pragma omp parallel for simd
+            for (long i=0;i<N;i++) xout[i]=(X)x0[i];
+            stage=STAGE_DONE;
+            return TASK_WARN;
+        }
+        alpha=a;
+        trialPoint(xout,lo,up);
+        return TASK_FG;
+    }
+
+private:
+    // xout = P(x0 + alpha*d) and dgx = <g0, xout-x0> in one pass
+    template <typename X>
+    void trialPoint(X* xout, const Bound<X>& lo, const Bound<X>& up) {
+        const long N=(long)n;
+        const T* X0=&x0[0];
+        const T* G0=&g0[0];
+        const T* D=&d[0];
+        const double a=alpha;
+        double s=0;
+        #pragma omp parallel for simd reduction(+:s)
+        for (long i=0;i<N;i++) {
+            X v=project((X)((double)X0[i]+a*(double)D[i]),(mwSize)i,lo,up);
+            xout[i]=v;
+            s+=(double)G0[i]*((double)v-(double)X0[i]);
+        }
+        dgx=s;
+    }
+    template <typename X>
+    double dotFree(const T* u, const T* v, const X* x, const X* g, const Bound<X>& lo, const Bound<X>& up, bool bounded) {
+        const long N=(long)n;
+        double s=0;
+        if (bounded) {
+            #pragma omp parallel for simd reduction(+:s)
+            for (long i=0;i<N;i++)
+                if (isFree(x[i],g[i],(mwSize)i,lo,up)) s+=(double)u[i]*(double)v[i];
+        } else {
+            #pragma omp parallel for simd reduction(+:s)
+            for (long i=0;i<N;i++) s+=(double)u[i]*(double)v[i];
+        }
+        return s;
+    }
+    template <typename X>
+    void axpyFree(double a, const T* u, T* v, const X* x, const X* g, const Bound<X>& lo, const Bound<X>& up, bool bounded) {
+        const long N=(long)n;
+        if (bounded) {
+            #pragma omp parallel for simd
+            for (long i=0;i<N;i++)
+                if (isFree(x[i],g[i],(mwSize)i,lo,up)) v[i]=(T)((double)v[i]+a*(double)u[i]);
+        } else {
+            #pragma omp parallel for simd
+            for (long i=0;i<N;i++) v[i]=(T)((double)v[i]+a*(double)u[i]);
+        }
+    }
+};
+
+// Registry of the workspaces (handles given to Matlab)
+static std::map<uint64_t, WorkspaceBase*> workspaces;
+static uint64_t lastHandle=0;
+
+static void cleanup(void) {
+    for (std::map<uint64_t, WorkspaceBase*>::iterator it=workspaces.begin();it!=workspaces.end();++it)
+        delete it->second;
+    workspaces.clear();
+}
+
+static WorkspaceBase* getWorkspace(const mxArray* h) {
+    if (!mxIsUint64(h) || mxGetNumberOfElements(h)!=1)
+        mexErrMsgTxt("Invalid workspace handle.\n");
+    std::map<uint64_t, WorkspaceBase*>::iterator it=workspaces.find(*(uint64_t*)mxGetData(h));
+    if (it==workspaces.end())
+        mexErrMsgTxt("Invalid or destroyed workspace.\n");
+    return it->second;
+}
+
+template <typename X>
+static Bound<X> getBound(const mxArray* b, const mxArray* x) {
+    Bound<X> B;
+    B.v=NULL; B.full=false;
+    if (mxIsEmpty(b)) return B;
+    if (mxGetClassID(b)!=mxGetClassID(x) || mxIsComplex(b) || mxIsSparse(b) ||
+        (mxGetNumberOfElements(b)!=1 && mxGetNumberOfElements(b)!=mxGetNumberOfElements(x)))
+        mexErrMsgTxt("Bounds should be empty, a scalar or an array of the size of x, of the class of x.\n");
+    B.v=(const X*)mxGetData(b);
+    B.full=mxGetNumberOfElements(b)>1;
+    return B;
+}
+
+template <typename T, typename X>
+static int iterate(Workspace<T>* ws, mxArray* xout, const mxArray* x, double f, const mxArray* g,
+                   const mxArray* xmin, const mxArray* xmax) {
+    Bound<X> lo=getBound<X>(xmin,x), up=getBound<X>(xmax,x);
+    X* xo=(X*)mxGetData(xout);
+    const X* xi=(const X*)mxGetData(x);
+    const X* gi=(const X*)mxGetData(g);
+    switch (ws->stage) {
+        case STAGE_START:
+        case STAGE_NEWX: {
+            int task=ws->newDirection(xo,xi,f,gi,lo,up);
+            if (task!=TASK_FG) {
+                memcpy(xo,xi,ws->n*sizeof(X));
+                ws->stage=STAGE_DONE;
+            }
+            return task;
+        }
+        case STAGE_LNSRCH:
+            return ws->lineSearch(xo,xi,f,gi,lo,up);
+        default:
+            memcpy(xo,xi,ws->n*sizeof(X));
+            return TASK_ERROR;
+    }
+}
+
+template <typename T>
+static int iterateT(Workspace<T>* ws, mxArray* xout, const mxArray* x, double f, const mxArray* g,
+                    const mxArray* xmin, const mxArray* xmax) {
+    if (mxIsDouble(x))
+        return iterate<T,double>(ws,xout,x,f,g,xmin,xmax);
+    else
+        return iterate<T,float>(ws,xout,x,f,g,xmin,xmax);
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs<1 || !mxIsChar(prhs[0]))
+        mexErrMsgTxt("Usage: vmlmbEngine(command,...).\n");
+    char cmd[16];
+    mxGetString(prhs[0],cmd,sizeof(cmd));
+    mexAtExit(cleanup);
+
+    if (!strcmp(cmd,"create")) {
+        if (nrhs!=5 || mxGetNumberOfElements(prhs[4])!=9 || !mxIsDouble(prhs[4]))
+            mexErrMsgTxt("Usage: ws = vmlmbEngine('create',n,m,precision,opts).\n");
+        mwSize n=(mwSize)mxGetScalar(prhs[1]);
+        int m=(int)mxGetScalar(prhs[2]);
+        if (m<1) mexErrMsgTxt("The number of memorized pairs should be positive.\n");
+        char prec[8];
+        mxGetString(prhs[3],prec,sizeof(prec));
+        WorkspaceBase* ws;
+        if (!strcmp(prec,"single"))
+            ws=new Workspace<float>(n,m,mxGetPr(prhs[4]));
+        else
+            ws=new Workspace<double>(n,m,mxGetPr(prhs[4]));
+        workspaces[++lastHandle]=ws;
+        plhs[0]=mxCreateNumericMatrix(1,1,mxUINT64_CLASS,mxREAL);
+        *(uint64_t*)mxGetData(plhs[0])=lastHandle;
+    } else if (!strcmp(cmd,"iterate")) {
+        if (nrhs!=7)
+            mexErrMsgTxt("Usage: [task,x] = vmlmbEngine('iterate',ws,x,f,g,xmin,xmax).\n");
+        WorkspaceBase* ws=getWorkspace(prhs[1]);
+        const mxArray *x=prhs[2], *g=prhs[4];
+        if (!(mxIsDouble(x) || mxIsSingle(x)) || mxIsComplex(x) || mxIsSparse(x))
+            mexErrMsgTxt("x should be a full real double or single array.\n");
+        if (mxGetClassID(g)!=mxGetClassID(x) || mxIsComplex(g) || mxIsSparse(g) || mxGetNumberOfElements(g)!=mxGetNumberOfElements(x))
+            mexErrMsgTxt("g should be a real array of the size and class of x.\n");
+        double f=mxGetScalar(prhs[3]);
+        mxArray* xout=mxCreateNumericArray(mxGetNumberOfDimensions(x),mxGetDimensions(x),mxGetClassID(x),mxREAL);
+        int task;
+        if (ws->isSingle()) {
+            Workspace<float>* w=static_cast<Workspace<float>*>(ws);
+            if (w->n!=mxGetNumberOfElements(x)) mexErrMsgTxt("Size of x does not match the workspace.\n");
+            task=iterateT<float>(w,xout,x,f,g,prhs[5],prhs[6]);
+        } else {
+            Workspace<double>* w=static_cast<Workspace<double>*>(ws);
+            if (w->n!=mxGetNumberOfElements(x)) mexErrMsgTxt("Size of x does not match the workspace.\n");
+            task=iterateT<double>(w,xout,x,f,g,prhs[5],prhs[6]);
+        }
+        plhs[0]=mxCreateDoubleScalar((double)task);
+        if (nlhs>1) plhs[1]=xout; else mxDestroyArray(xout);
+    } else if (!strcmp(cmd,"reason")) {
+        WorkspaceBase* ws=getWorkspace(prhs[1]);
+        plhs[0]=mxCreateString(ws->reason.c_str());
+    } else if (!strcmp(cmd,"destroy")) {
+        if (nrhs==2 && mxIsUint64(prhs[1]) && mxGetNumberOfElements(prhs[1])==1) {
+            std::map<uint64_t, WorkspaceBase*>::iterator it=workspaces.find(*(uint64_t*)mxGetData(prhs[1]));
+            if (it!=workspaces.end()) {
+                delete it->second;
+                workspaces.erase(it);
+            }
+        }
+    } else {
+        mexErrMsgTxt("Unknown command.\n");
+    }
+}
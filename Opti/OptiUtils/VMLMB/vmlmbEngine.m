@@ -0,0 +1,27 @@
+% function varargout=vmlmbEngine(command,...)
+%
+%  Native VMLMB engine (limited memory variable metric with bound
+%  constraints) driven by reverse communication:
+%     ws = vmlmbEngine('create',n,m,precision,opts)
+%     [task,x] = vmlmbEngine('iterate',ws,x,f,g,xmin,xmax)
+%     msg = vmlmbEngine('reason',ws)
+%     vmlmbEngine('destroy',ws)
+%  where opts=[sftol epsilon delta fatol frtol gatol grtol xatol xrtol] and
+%  precision ('double' or 'single') is the storage class of the L-BFGS
+%  history. The returned task follows the OPL_TASK_* constants of
+%  OptiVMLMB. Mex implementation used by OptiVMLMB (impl='native').
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
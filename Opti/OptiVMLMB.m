@@ -15,6 +15,18 @@ classdef OptiVMLMB<Opti
     % default to reasonable values. See the function m_vmlmb_first.m in the
     % MatlabOptimPack folder for more details.
     %
+    % Three implementations are available through the property impl:
+    %
+    %  - 'mat' (default) the Matlab implementation (installed by installVMLMB),
+    %  - 'mex' the mex files of OptimPackLegacy (installed by installOptimPack),
+    %  - 'native' the in-tree engine vmlmbEngine (built by buildVMLMBEngine).
+    %    The L-BFGS recursion restricted to the free variables, the projection
+    %    onto the bounds and the line search run in OpenMP/SIMD loops, and the
+    %    correction pairs are stored in the class given by historyClass
+    %    ('double' or 'single', the latter halving the memory). It uses the
+    %    tolerances ftol, gtol and xtol of the 'mat' implementation, and does
+    %    not modify x0.
+    %
     % **Reference**
     %
     % [1] Eric Thiebaut, "Optimization issues in blind deconvolution algorithms",
@@ -77,10 +89,13 @@ classdef OptiVMLMB<Opti
         sxtol=0.1;
         delta=0.1;          %   DELTA is a small nonegative value used to compute a small initial step.
         active;
+        historyClass='double'; % storage class of the correction pairs for impl='native' ('double' or 'single')
     end
     properties (SetAccess = protected,GetAccess = public)
         nparam;
-        ws;
+    end
+    properties (SetAccess = protected,GetAccess = public,Transient)
+        ws;             % workspace of the 'mex' and 'native' engines (not saved: valid only in this session)
     end
     % -- matlab implementation
     properties (Constant)
@@ -150,6 +165,8 @@ classdef OptiVMLMB<Opti
         last_print = -1; % iteration number for last print
         freevars = [];   % subset of free variables (not yet known)
         t0;
+        nxmin=[];        % bounds in the class of x (impl='native')
+        nxmax=[];        % -
     end
    
     %% Methods
@@ -167,17 +184,28 @@ classdef OptiVMLMB<Opti
                 end
             end
             this.cost=C;
-            
+
         end
-                
+        function delete(this)
+            % Frees the workspace of the 'native' engine when the run did
+            % not end by convergence, error or maxeval (e.g. by maxiter)
+            if ~isempty(this.ws) && isa(this.ws,'uint64') && exist('vmlmbEngine')==3
+                vmlmbEngine('destroy',this.ws);   % unknown handles are ignored
+                this.ws = [];
+            end
+        end
+
         function initialize(this,x0)
             % Reimplementation from :class:`Opti`.
 
             initialize@Opti(this,x0);
+            if isempty(x0), return; end   % state restored by setState
             if strcmp(this.impl,'mex')
                 initialize_mex(this,x0);
             elseif strcmp(this.impl,'mat')
                 initialize_mat(this,x0);
+            elseif strcmp(this.impl,'native')
+                initialize_native(this,x0);
             end
         end
         function initialize_mat(this,x0)
@@ -205,6 +233,12 @@ classdef OptiVMLMB<Opti
                 this.t0 = time();
             end
 
+            set_tolerances(this);
+
+            this.x0 = x0 ;
+            this.task = this.OPL_STAGE_INIT ;
+        end
+        function set_tolerances(this)
             % Tolerances.  Most of these are forced to be nonnegative to simplify tests.
             if isscalar(this.ftol)
                 this.fatol = -Inf;
@@ -227,9 +261,33 @@ classdef OptiVMLMB<Opti
                 this.xatol = max(0.0, this.xtol(1));
                 this.xrtol = max(0.0, this.xtol(2));
             end
+        end
+        function initialize_native(this,x0)
+            if exist('vmlmbEngine')~=3
+                buildVMLMBEngine();
+            end
+            if ~isempty(this.ws) && isa(this.ws,'uint64')
+                vmlmbEngine('destroy',this.ws);
+            end
+            set_tolerances(this);
 
-            this.x0 = x0 ;
-            this.task = this.OPL_STAGE_INIT ;
+            % The engine works on CPU arrays, with the bounds in the class of x
+            this.xopt = gather(x0);
+            cl = class(this.xopt);
+            this.nxmin = []; this.nxmax = [];
+            if bitand(this.bounds,1), this.nxmin = cast(gather(this.xmin),cl); end
+            if bitand(this.bounds,2), this.nxmax = cast(gather(this.xmax),cl); end
+            if ~isempty(this.nxmin), this.xopt = max(this.xopt,this.nxmin); end % new array: no side effect on x0
+            if ~isempty(this.nxmax), this.xopt = min(this.xopt,this.nxmax); end
+
+            this.nparam = numel(x0);
+            this.ws = vmlmbEngine('create',this.nparam,this.m,this.historyClass, ...
+                [this.sftol,this.epsilon,this.delta,this.fatol,this.frtol,this.gatol,this.grtol,this.xatol,this.xrtol]);
+            this.task = this.OPL_TASK_FG;
+            [cc,grad] = this.cost.applyAndGrad(this.xopt);
+            this.cc = double(gather(cc));
+            this.grad = cast(gather(real(grad)),cl);
+            this.nbeval = 1;
         end
         function initialize_mex(this,x0)
 
@@ -264,8 +322,9 @@ classdef OptiVMLMB<Opti
             end
 
 
-            this.cc = gather(this.cost.apply(this.xopt));
-            this.grad = gather(real(this.cost.applyGrad(this.xopt)));
+            [cc,grad] = this.cost.applyAndGrad(this.xopt);
+            this.cc = gather(cc);
+            this.grad = gather(real(grad));
 
             this.nbeval=this.nbeval+1;
         end
@@ -275,6 +334,8 @@ classdef OptiVMLMB<Opti
                 flag = doIteration_mex(this);
             elseif strcmp(this.impl,'mat')
                 flag = doIteration_mat(this);
+            elseif strcmp(this.impl,'native')
+                flag = doIteration_native(this);
             end
         end
         function flag=doIteration_mat(this)
@@ -293,8 +354,9 @@ classdef OptiVMLMB<Opti
                 this.projs = this.projs + 1;
             end
             %-- Compute objective function and its gradient.
-            this.cc = gather(this.cost.apply(this.xopt));
-            this.grad = gather(real(this.cost.applyGrad(this.xopt)));
+            [cc,grad] = this.cost.applyAndGrad(this.xopt);
+            this.cc = gather(cc);
+            this.grad = gather(real(grad));
 
             this.nbeval = this.nbeval + 1;
             if this.cc < this.best_f || this.nbeval == 1
@@ -503,6 +565,57 @@ classdef OptiVMLMB<Opti
                 this.xopt = this.x0 + this.alpha*this.d;
             end
         end
+        function st=getState(this)
+            % Reimplementation from :class:`Opti`. With the 'mex' and
+            % 'native' implementations, the workspace of the engine is not
+            % saved: the algorithm restarts from xopt (see :meth:`setState`).
+            st=getState@Opti(this);
+            if strcmp(this.impl,'mat')
+                for f=OptiVMLMB.matStateFields()
+                    st.(f{1})=this.(f{1});
+                end
+            end
+        end
+        function setState(this,st)
+            % Reimplementation from :class:`Opti`.
+            setState@Opti(this,st);
+            if strcmp(this.impl,'mat')
+                for f=OptiVMLMB.matStateFields()
+                    this.(f{1})=st.(f{1});
+                end
+            else
+                this.initialize(this.xopt);
+            end
+        end
+        function flag=doIteration_native(this)
+            % Reimplementation from :class:`Opti`. The engine returns the
+            % point where the cost has to be evaluated (OPL_TASK_FG) until
+            % a new iterate is accepted (OPL_TASK_NEWX).
+
+            [this.task,x] = vmlmbEngine('iterate',this.ws,this.xopt,this.cc,this.grad,this.nxmin,this.nxmax);
+            this.xopt = x;
+            flag=this.OPTI_REDO_IT;
+            if (this.task == this.OPL_TASK_FG)
+                [cc,grad] = this.cost.applyAndGrad(this.xopt);
+                this.cc = double(gather(cc));
+                this.grad = cast(gather(real(grad)),class(this.xopt));
+                this.nbeval=this.nbeval+1;
+                if this.nbeval >= this.maxeval
+                    this.endingMessage = ['Max number of evaluations reached'];
+                    vmlmbEngine('destroy',this.ws);
+                    this.ws = [];
+                    flag=this.OPTI_STOP;
+                end
+            elseif (this.task == this.OPL_TASK_NEWX)
+                flag=this.OPTI_NEXT_IT;
+            else
+                % Convergence, or error, or warning (x is the last accepted iterate)
+                this.endingMessage = vmlmbEngine('reason',this.ws);
+                vmlmbEngine('destroy',this.ws);
+                this.ws = [];
+                flag=this.OPTI_STOP;
+            end
+        end
         function flag=doIteration_mex(this)
             % Reimplementation from :class:`Opti`. For details see [1].
             
@@ -524,8 +637,9 @@ classdef OptiVMLMB<Opti
                 end
                 
                 
-                this.cc = gather(this.cost.apply(this.xopt));
-                this.grad = gather(real(this.cost.applyGrad(this.xopt)));
+                [cc,grad] = this.cost.applyAndGrad(this.xopt);
+                this.cc = gather(cc);
+                this.grad = gather(real(grad));
                 
                 
                 this.nbeval=this.nbeval+1;
@@ -566,5 +680,13 @@ classdef OptiVMLMB<Opti
             end
         end
     end
-    
+    methods (Static, Access = protected)
+        function f=matStateFields()
+            % Internal variables of the 'mat' implementation
+            f={'nbeval','grad','cc','task','lnsrch','lbfgs','x0','f0','g0','d','s','pg','pg0', ...
+                'gnorm','gtest','fatol','frtol','gatol','grtol','xatol','xrtol','alpha','amin','amax', ...
+                'iters','projs','rejects','status','best_f','best_g','best_x','best_gnorm','best_alpha', ...
+                'best_evals','last_evals','last_print','freevars','blmvm'};
+        end
+    end
 end
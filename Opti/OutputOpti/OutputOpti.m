@@ -22,6 +22,18 @@ classdef OutputOpti < matlab.mixin.Copyable
     % :param evolxopt:  cell saving the optimization variable xopt
     % :param iterVerb:  message will be displayed every iterVerb iterations (must be a multiple of the :attr:`ItUpOut` parameter of classes :class:`Opti`)
     % :param costIndex: select a specific cost function among a sum in the case where the optimized cost function is a sum of cost functions
+    % :param async: boolean (default false), if true the evaluations are done asynchronously on a parallel pool
+    %
+    % **Note** In asynchronous mode, the update method snapshots the current iterate (copy-on-write, no copy)
+    % and submits the evaluation of the cost (and SNR) to a worker of the pool (the current pool by default,
+    % a thread-based pool being the most efficient) while the algorithm continues. The results are stored
+    % (and displayed) when they are available, and the pending ones are collected at the end of the
+    % algorithm (see :meth:`flush`). Without parallel pool the evaluations are synchronous. In both modes
+    % the cost is evaluated through the method costEvaluator of :class:`Opti` which lets the algorithms
+    % reuse quantities they already computed (e.g. \(\mathrm{H_nx}\) in :class:`OptiADMM`).
+    % An evaluation which fails on the pool is stored as NaN (with a warning) and the algorithm continues.
+    % On a process-based pool the arguments of each evaluation, including the cost operators (handle
+    % objects), are serialized to the worker at every update; a thread-based pool shares them.
     %
     % **Example** OutOpti=OutputOpti(computecost,iterVerb,costIndex) 
     %
@@ -59,6 +71,11 @@ classdef OutputOpti < matlab.mixin.Copyable
         iterVerb=0;        % message will be displayed every iterVerb iterations
         costIndex=0;       % index of the cost function
         saveXopt=false;    % save evolution of the optimized variable
+        async=false;       % asynchronous evaluation on a parallel pool
+        pool=[];           % parallel pool used in asynchronous mode (default: current pool)
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+        pending={};        % pending asynchronous evaluations {future, index, iteration, display}
     end
     
     methods
@@ -97,10 +114,12 @@ classdef OutputOpti < matlab.mixin.Copyable
         	this.evolcost=zeros_(1);
 			this.iternum = [];
             this.evolxopt = {};
+            this.pending = {};
         end
         %% Update method
         function update(this,opti)
             % Computes SNR, cost and display evolution.
+            if this.async && this.updateAsync(opti), return; end
             str=sprintf('Iter: %5i',opti.niter);
             if this.computecost
                 cc=this.computeCost(opti);
@@ -121,16 +140,93 @@ classdef OutputOpti < matlab.mixin.Copyable
         function cc=computeCost(this,opti)
             % Evaluate the cost function at the current iterate xopt of
             % the given :class:`Opti` opti object
+            [f,args]=this.costJob(opti);
+            cc=f(args{:});
+        end
+        function flush(this)
+            % Waits for the pending asynchronous evaluations and stores
+            % their results
+            this.collect(true);
+        end
+    end
+    methods (Access = protected)
+        function [f,args]=costJob(this,opti)
+            % Function handle f and arguments (snapshots) such that
+            % f(args{:}) is the cost at the current iterate of opti
             if (any(this.costIndex>0) && isa(opti.cost,'CostSummation'))
-                cc = 0;
-                for n=1:numel(this.costIndex)
-                    cc = cc+opti.cost.mapsCell{this.costIndex(n)}*opti.xopt;
-                end
+                f=@OutputOpti.partialCost;
+                args={opti.cost.mapsCell(this.costIndex),opti.xopt};
             else
-                cc = opti.cost*opti.xopt;
+                [f,args]=opti.costEvaluator();
+            end
+        end
+        function [f,args]=asyncJob(this,opti)
+            % Evaluation submitted in asynchronous mode (empty f if nothing
+            % has to be computed), f returning the vector of values given
+            % to storeAsync
+            f=[]; args={};
+            if this.computecost
+                [fc,ac]=this.costJob(opti);
+                f=@OutputOpti.evalJob;
+                args={fc,ac};
+            end
+        end
+        function storeAsync(this,idx,niter,v,dsp)
+            % Stores (and displays) the values v computed asynchronously
+            % for the iteration niter
+            this.evolcost(idx)=v(1);
+            if dsp
+                fprintf('Iter: %5i | Cost: %4.4e\n',niter,v(1));
+            end
+        end
+        function ok=updateAsync(this,opti)
+            % Submits the evaluations for the current iterate to the pool.
+            % Returns false if no pool is available.
+            p=this.pool;
+            if isempty(p), p=gcp('nocreate'); end
+            ok=~isempty(p);
+            if ~ok, return; end
+            this.collect(false);
+            [f,args]=this.asyncJob(opti);
+            dsp=opti.verbose && (opti.niter~=0 && (mod(opti.niter,this.iterVerb)==0) || (opti.niter==1 && this.iterVerb~=0));
+            if ~isempty(f)
+                this.pending{end+1}={parfeval(p,f,1,args{:}),this.count,opti.niter,dsp};
+            elseif dsp
+                fprintf('Iter: %5i\n',opti.niter);
+            end
+            if this.saveXopt
+                this.evolxopt{this.count}=opti.xopt;
+            end
+            this.iternum(this.count)=opti.niter;
+            this.count=this.count+1;
+        end
+        function collect(this,wait)
+            % Stores the results of the finished evaluations (in order), or
+            % of all of them if wait is true
+            while ~isempty(this.pending) && (wait || strcmp(this.pending{1}{1}.State,'finished'))
+                job=this.pending{1};
+                this.pending(1)=[];
+                try
+                    v=fetchOutputs(job{1});
+                catch err
+                    % A failed evaluation must not stop the algorithm
+                    warning('OutputOpti:asyncFailed','Evaluation at iteration %i failed: %s',job{3},err.message);
+                    v=NaN(1,2);
+                end
+                this.storeAsync(job{2},job{3},v,job{4});
+            end
+        end
+    end
+    methods (Static, Access = protected)
+        function v=evalJob(f,args)
+            v=f(args{:});
+        end
+        function cc=partialCost(C,x)
+            cc = 0;
+            for n=1:numel(C)
+                cc = cc+C{n}*x;
             end
         end
-
     end
     methods (Access = protected)
         %% Copy
@@ -44,11 +44,18 @@ classdef OutputOptiConjGrad < OutputOptiSNR
                 this.ytWy = 0.5.*yty;
             end                
         end
-        function cc=computeCost(this,opti)
-            % Evaluate the cost function at the current iterate xopt of
-            % the given :class:`Opti` opti object  
-            r = 0.5.* opti.A.apply(opti.xopt) - opti.b ;
-            cc = sum(opti.xopt(:).*r(:)) + this.ytWy;
+    end
+    methods (Access = protected)
+        function [f,args]=costJob(this,opti)
+            % Reimplemented from parent class :class:`OutputOpti`.
+            f=@OutputOptiConjGrad.cgCost;
+            args={opti.A,opti.b,opti.xopt,this.ytWy};
+        end
+    end
+    methods (Static, Access = protected)
+        function cc=cgCost(A,b,x,ytWy)
+            r = 0.5.* A.apply(x) - b ;
+            cc = sum(x(:).*r(:)) + ytWy;
         end
     end
 end
@@ -99,10 +99,12 @@ classdef OutputOptiSNR  < OutputOpti
             this.evolsnr=zeros_(1);
             this.iternum = [];
             this.evolxopt = {};
+            this.pending = {};
         end
         %% Update method
         function update(this,opti)
             % Computes SNR, cost and display evolution.
+            if this.async && this.updateAsync(opti), return; end
             str=sprintf('Iter: %5i',opti.niter);
             if this.computecost
                 cc=this.computeCost(opti);
@@ -123,23 +125,46 @@ classdef OutputOptiSNR  < OutputOpti
                 disp(str);
             end
         end
-        function cc=computeCost(this,opti)
-            % Evaluate the cost function at the current iterate xopt of
-            % the given :class:`Opti` opti object
-            if (any(this.costIndex>0) && isa(opti.cost,'CostSummation'))
-                cc = 0;
-                for n=1:numel(this.costIndex)
-                    cc = cc+opti.cost.mapsCell{this.costIndex(n)}*opti.xopt;
-                end
-            else
-                cc = opti.cost*opti.xopt;
-            end
-        end
         function snr=computeSNR(this,opti)
             % Evaluate the snr for the current iterate xopt of
             % the given :class:`Opti` opti object
-            reconstruction = this.snrOp.apply(opti.xopt);
-            snr=20*log10(this.normXtrue/norm(this.xtrue(:)-reconstruction(:)));
+            snr=OutputOptiSNR.snrOf(this.snrOp,this.xtrue,this.normXtrue,opti.xopt);
+        end
+    end
+    methods (Access = protected)
+        function [f,args]=asyncJob(this,opti)
+            % Reimplemented from parent class :class:`OutputOpti`: the
+            % cost (NaN if not computed) and the SNR are evaluated together.
+            fc=[]; ac={};
+            if this.computecost
+                [fc,ac]=this.costJob(opti);
+            end
+            f=@OutputOptiSNR.evalJobSNR;
+            args={fc,ac,this.snrOp,this.xtrue,this.normXtrue,opti.xopt};
+        end
+        function storeAsync(this,idx,niter,v,dsp)
+            % Reimplemented from parent class :class:`OutputOpti`.
+            str=sprintf('Iter: %5i',niter);
+            if this.computecost
+                this.evolcost(idx)=v(1);
+                str=sprintf('%s | Cost: %4.4e',str,v(1));
+            end
+            this.evolsnr(idx)=v(2);
+            if dsp
+                disp(sprintf('%s | SNR: %4.4e dB',str,v(2)));
+            end
+        end
+    end
+    methods (Static, Access = protected)
+        function snr=snrOf(snrOp,xtrue,normXtrue,x)
+            reconstruction = snrOp.apply(x);
+            snr=20*log10(normXtrue/norm(xtrue(:)-reconstruction(:)));
+        end
+        function v=evalJobSNR(fc,ac,snrOp,xtrue,normXtrue,x)
+            v=[NaN,OutputOptiSNR.snrOf(snrOp,xtrue,normXtrue,x)];
+            if ~isempty(fc)
+                v(1)=fc(ac{:});
+            end
         end
     end
 end
@@ -11,6 +11,11 @@ classdef TestCvg  < matlab.mixin.Copyable
     % be generic for all Optimization routines. Hence the update method has access (in reading mode)
     % to all the properties of :class:`Opti` objects.
     %
+    % **Note** Tests based on the step between two successive iterates get its statistics through
+    % :meth:`stepStats`, computed in a single pass over xopt and xold (mex file cvgStats when it is
+    % compiled, see buildCvgStats). Within a :class:`TestCvgCombine`, this pass is shared by all
+    % the tests with needStats=true.
+    %
     % See also :class:`Opti`
     
     %%    Copyright (C) 2018
@@ -32,6 +37,10 @@ classdef TestCvg  < matlab.mixin.Copyable
     properties (SetAccess = protected,GetAccess = public)
         name = 'TestCvg';
         needxold = false;
+        needStats = false;   % true if the test uses :meth:`stepStats`
+    end
+    properties (SetAccess = protected,GetAccess = protected)
+        sharedStats = [];    % statistics given by setStepStats (used once)
     end
     
     methods
@@ -45,5 +54,58 @@ classdef TestCvg  < matlab.mixin.Copyable
             
             stop = false;            
         end
+        function stop = testConvergenceBatch(this,opti,dim)
+            % Convergence test for each problem of a batch stacked along
+            % the dimension dim of opti.xopt (see :class:`Opti`)
+            %
+            % :return: boolean vector with one element per problem
+            %
+            % Default implementation: all the problems stop when
+            % :meth:`testConvergence` returns true.
+            
+            stop = repmat(this.testConvergence(opti),1,size(opti.xopt,dim));
+        end
+        function s = stepStats(this,opti)
+            % Statistics on the step between the two last iterates
+            %
+            % :return: s = [||xopt-xold|| ||xold|| ||xopt|| max|xopt-xold|]
+            %          (empty if xold is not available)
+            %
+            % The statistics given by :meth:`setStepStats` are used if any,
+            % otherwise they are computed by :meth:`computeStepStats`.
+            
+            if ~isempty(this.sharedStats)
+                s = this.sharedStats;
+                this.sharedStats = [];
+            else
+                s = TestCvg.computeStepStats(opti.xopt,opti.xold);
+            end
+        end
+        function setStepStats(this,s)
+            % Gives the statistics to be returned by the next call to
+            % :meth:`stepStats` (empty to discard them)
+            
+            this.sharedStats = s;
+        end
+    end
+    
+    methods (Static)
+        function s = computeStepStats(x,xold)
+            % Computes [||x-xold|| ||xold|| ||x|| max|x-xold|] in a single
+            % pass when the mex file cvgStats is available
+            
+            persistent useMex
+            if isempty(useMex)
+                useMex = (exist('cvgStats')==3);
+            end
+            if isempty(xold)
+                s = [];
+            elseif useMex && isMexCompatible(x,xold,'complex') && numel(x)==numel(xold)
+                s = cvgStats(x,xold);
+            else
+                d = x(:)-xold(:);
+                s = double(gather([norm(d) norm(xold(:)) norm(x(:)) max(abs(d))]));
+            end
+        end
     end
 end
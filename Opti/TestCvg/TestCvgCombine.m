@@ -50,16 +50,37 @@ classdef TestCvgCombine < TestCvg
                     this.testNumber = this.testNumber + varargin{n}.testNumber;
                 end
                 this.needxold = this.needxold || this.cvList{this.testNumber}.needxold;
+                this.needStats = this.needStats || this.cvList{this.testNumber}.needStats;
             end
         end
         %% Update method
         function stop = testConvergence(this,opti)       
-            % Reimplemented from parent class :class:`TestCvg`.
+            % Reimplemented from parent class :class:`TestCvg`. The step
+            % statistics are computed once and shared by all the tests.
             stop = false;
+            if this.needStats
+                s = this.stepStats(opti);
+                for n=1:this.testNumber
+                    if this.cvList{n}.needStats, this.cvList{n}.setStepStats(s); end
+                end
+            end
             for n=1:this.testNumber
                 stop = this.cvList{n}.testConvergence(opti);
                 if stop, break; end
             end
+            if this.needStats
+                for n=1:this.testNumber
+                    this.cvList{n}.setStepStats([]);
+                end
+            end
+        end
+        function stop = testConvergenceBatch(this,opti,dim)
+            % Reimplemented from parent class :class:`TestCvg`.
+            stop = false(1,size(opti.xopt,dim));
+            for n=1:this.testNumber
+                stop = stop | reshape(this.cvList{n}.testConvergenceBatch(opti,dim),1,[]);
+                if all(stop), break; end
+            end
         end
     end
     
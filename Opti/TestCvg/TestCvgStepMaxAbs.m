@@ -0,0 +1,55 @@
+classdef TestCvgStepMaxAbs  < TestCvg
+    % TestCvgStepMaxAbs stops the optimization when the largest change of
+    % an element of the iterate is below the value STEPMAXABSTOL
+    %
+    % :param stepMaxAbsTol:  absolute tolerance on the elements of the step
+    %
+    % **Example** CvOpti=TestCvgStepMaxAbs(stepMaxAbsTol )
+    %
+    % See also :class:`TestCvg`
+    
+    %%    Copyright (C) 2026
+    %     GlobalBioIm developers
+    %
+    %     This program is free software: you can redistribute it and/or modify
+    %     it under the terms of the GNU General Public License as published by
+    %     the Free Software Foundation, either version 3 of the License, or
+    %     (at your option) any later version.
+    %
+    %     This program is distributed in the hope that it will be useful,
+    %     but WITHOUT ANY WARRANTY; without even the implied warranty of
+    %     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    %     GNU General Public License for more details.
+    %
+    %     You should have received a copy of the GNU General Public License
+    %     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    
+    properties (SetAccess = public,GetAccess = public)
+        stepMaxAbsTol=1e-5;      % stopping criteria tolerance on the largest absolute change btw two successive iterates
+    end
+    methods
+        %% Constructor
+        function this=TestCvgStepMaxAbs( stepMaxAbsTol)
+            this.name = 'TestCvgStepMaxAbs';
+            assert(isscalar(stepMaxAbsTol),'stepMaxAbsTol must be scalar');
+            this.stepMaxAbsTol =stepMaxAbsTol;
+            this.needxold = true;
+            this.needStats = true;
+        end
+        %% Update method
+        function stop = testConvergence(this,opti)
+            % Tests algorithm convergence from the largest absolute difference between the elements of two successive iterates
+            %
+            % :return: boolean true if
+            %          $$ \\| \\mathrm{x}^{k} - \\mathrm{x}^{k-1}\\|_\\infty < \\text{stepMaxAbsTol}.$$
+            
+            stop = false;
+            s = this.stepStats(opti);
+            if ~isempty(s) && s(4) < this.stepMaxAbsTol
+                stop  =true;
+                endingMessage = [this.name,': Largest change between two successive iterates below the absolute tolerance : ',num2str(s(4)),' < ',num2str(this.stepMaxAbsTol)];
+                opti.endingMessage = endingMessage;
+            end
+        end
+    end
+end
@@ -34,6 +34,7 @@ classdef TestCvgStepRelative  < TestCvg
             assert(isscalar(stepRelativeTol),'stepRelativeTol must be scalar');
             this.stepRelativeTol =stepRelativeTol;
             this.needxold = true;
+            this.needStats = true;
         end
         %% Update method
         function stop = testConvergence(this,opti)
@@ -43,9 +44,9 @@ classdef TestCvgStepRelative  < TestCvg
             %          $$ \\frac{\\| \\mathrm{x}^{k} - \\mathrm{x}^{k-1}\\|}{\\|\\mathrm{x}^{k-1}\\|} < \\text{stepRelativeTol}.$$
             
             stop = false;
-            if ~isempty(opti.xold)
-                r=opti.xopt-opti.xold;
-                xdiff=norm(r(:))/(norm(opti.xold(:))+eps);
+            s = this.stepStats(opti);
+            if ~isempty(s)
+                xdiff=s(1)/(s(2)+eps);
                 if( xdiff < this.stepRelativeTol)
                     stop  =true;
                     endingMessage = [this.name,': Step variation between two successive iterates below the relative tolerance : ',num2str(xdiff),' < ',num2str(this.stepRelativeTol)];
@@ -53,5 +54,19 @@ classdef TestCvgStepRelative  < TestCvg
                 end
             end
         end
+        function stop = testConvergenceBatch(this,opti,dim)
+            % Reimplemented from parent class :class:`TestCvg`: the relative
+            % step is computed for each problem of the batch.
+            
+            stop = false(1,size(opti.xopt,dim));
+            if ~isempty(opti.xold)
+                nd=max(ndims(opti.xopt),dim);
+                perm=[1:dim-1,dim+1:nd,dim];
+                r=reshape(permute(opti.xopt-opti.xold,perm),[],size(opti.xopt,dim));
+                xo=reshape(permute(opti.xold,perm),[],size(opti.xopt,dim));
+                xdiff=sqrt(sum(abs(r).^2,1))./(sqrt(sum(abs(xo).^2,1))+eps);
+                stop = gather(xdiff < this.stepRelativeTol);
+            end
+        end
     end
 end
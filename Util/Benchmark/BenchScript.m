@@ -0,0 +1,54 @@
+%--------------------------------------------------------------
+%            Benchmarks of the GlobalBioIm Library
+%
+% USAGE :
+%    - set generateBaseline=1; to run the benchmarks and save the results
+%    as the baseline of this machine (e.g. from a reference version of
+%    the Library)
+%    - set generateBaseline=0; to run the benchmarks and compare their
+%    timings to the baseline (cases slower than (1+tol) times the
+%    baseline are reported as regressions)
+%    - use the structure 'opts' to choose the groups, sizes and numbers
+%    of threads (see benchSuite)
+%
+% The results are written in Util/Benchmark/Data as JSON files named
+% after the host (bench_<host>.json, baseline_<host>.json).
+%
+%  Copyright (C) 2026 GlobalBioIm developers
+%--------------------------------------------------------------
+% Initializations
+clc; clear; close all;
+generateBaseline=0;
+tol=0.2;               % relative tolerance on the times
+
+% Select benchmarks
+opts.groups={'kernels','operators','pipelines'};
+opts.sizes=[128 512 2048];
+opts.threads=unique([1 maxNumCompThreads]);
+opts.repeat=5;
+
+[lpath,~,~] = fileparts(which('setGlobalBioImPath'));
+warning('off','MATLAB:MKDIR:DirectoryExists');
+mkdir(fullfile(lpath,'Util/Benchmark/Data'));
+warning('on','MATLAB:MKDIR:DirectoryExists');
+[~,host]=system('hostname'); host=regexprep(strtrim(host),'[^\w-]','_');
+baseFile=fullfile(lpath,'Util/Benchmark/Data',['baseline_',host,'.json']);
+
+% Run
+if generateBaseline
+    opts.output=baseFile;
+else
+    opts.output=fullfile(lpath,'Util/Benchmark/Data',['bench_',host,'.json']);
+end
+tt=tic;
+bench=benchSuite(opts);
+fprintf(' Benchmarks done in %.1f s\n',toc(tt));
+
+% Compare
+if ~generateBaseline
+    if exist(baseFile,'file')
+        regressions=benchCompare(bench,baseFile,tol);
+    else
+        fprintf(' No baseline for this machine (%s): set generateBaseline=1 to create it\n',baseFile);
+    end
+end
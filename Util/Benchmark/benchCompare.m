@@ -0,0 +1,95 @@
+function [regressions, cmp] = benchCompare(bench, baseline, tol, tolMemory)
+% Compares benchmark results (see benchSuite) with stored baseline results.
+%
+% Usage: [regressions, cmp] = benchCompare(bench, baseline, tol, tolMemory)
+%
+% bench, baseline - structures returned by benchSuite, or paths of the
+% JSON files written by benchSuite.
+%
+% tol - relative tolerance on the (median) time: a case is a regression
+% if time > (1+tol)*baseline time. Default 0.2.
+%
+% tolMemory - relative tolerance on the peak memory (ignored when the
+% memory is not measured). Default 0.2.
+%
+% regressions - cases of cmp which are regressions.
+%
+% cmp - structure array with one element per case found in both results
+% (same group, name, size, number of threads and number of OpenMP
+% threads), with the fields group,
+% name, size, threads, time, baseTime, ratio (time/baseTime), peakMemory,
+% basePeakMemory and status ('ok', 'faster', 'slower' or 'memory').
+% A table of the comparison is displayed.
+%
+% See also benchSuite, BenchScript
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+if nargin < 3 || isempty(tol), tol = 0.2; end
+if nargin < 4 || isempty(tolMemory), tolMemory = 0.2; end
+bench = readBench(bench);
+baseline = readBench(baseline);
+
+key = @(r) sprintf('%s|%s|%s|%d|%d', r.group, r.name, r.size, r.threads, ompThreadsOf(r));
+baseKeys = arrayfun(key, baseline.results, 'UniformOutput', false);
+cmp = struct('group', {}, 'name', {}, 'size', {}, 'threads', {}, 'time', {}, 'baseTime', {}, 'ratio', {}, ...
+    'peakMemory', {}, 'basePeakMemory', {}, 'status', {});
+for k = 1:numel(bench.results)
+    r = bench.results(k);
+    i = find(strcmp(key(r), baseKeys), 1);
+    if isempty(i), continue; end
+    b = baseline.results(i);
+    c.group = r.group; c.name = r.name; c.size = r.size; c.threads = r.threads;
+    c.time = r.time; c.baseTime = b.time; c.ratio = r.time/b.time;
+    c.peakMemory = r.peakMemory; c.basePeakMemory = b.peakMemory;
+    if c.ratio > 1+tol
+        c.status = 'slower';
+    elseif ~isnan(r.peakMemory) && ~isnan(b.peakMemory) && r.peakMemory > (1+tolMemory)*b.peakMemory && r.peakMemory-b.peakMemory > 2^20
+        c.status = 'memory';
+    elseif c.ratio < 1/(1+tol)
+        c.status = 'faster';
+    else
+        c.status = 'ok';
+    end
+    cmp(end+1) = c; %#ok<AGROW>
+end
+regressions = cmp(strcmp({cmp.status}, 'slower') | strcmp({cmp.status}, 'memory'));
+
+fprintf(' Baseline: %s (%s)\n', baseline.meta.host, baseline.meta.date);
+for k = 1:numel(cmp)
+    fprintf(' %-10s %-32s %-14s %3d threads : %10.4g s (baseline %10.4g s, x%5.2f)  --> %s\n', cmp(k).group, ...
+        cmp(k).name, cmp(k).size, cmp(k).threads, cmp(k).time, cmp(k).baseTime, cmp(k).ratio, cmp(k).status);
+end
+fprintf(' %d case(s) compared, %d regression(s)\n', numel(cmp), numel(regressions));
+end
+
+function n = ompThreadsOf(r)
+% Number of OpenMP threads of a result (0 for results written before it was recorded)
+n = 0;
+if isfield(r, 'ompThreads'), n = r.ompThreads; end
+end
+
+function b = readBench(b)
+% Results from a JSON file written by benchSuite
+if ischar(b)
+    b = jsondecode(fileread(b));
+    for k = 1:numel(b.results)     % null values (NaN) of jsonencode
+        for f = {'throughput', 'bandwidth', 'peakMemory'}
+            if isempty(b.results(k).(f{1})), b.results(k).(f{1}) = NaN; end
+        end
+    end
+end
+end
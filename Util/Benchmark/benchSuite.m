@@ -0,0 +1,277 @@
+function bench = benchSuite(opts)
+% Measures the speed of the native kernels, of core operators and of full
+% deconvolution pipelines (Example/DeconvEx scripts).
+%
+% Usage: bench = benchSuite(opts)
+%
+% opts - structure with the optional fields
+%   - groups: cell among 'kernels', 'operators' and 'pipelines'
+%     (default all)
+%   - sizes: linear sizes swept by the kernels and operators (2D: n x n,
+%     3D: n x n x n/4). Default [128 512 2048].
+%   - threads: numbers of threads swept, set for MATLAB by
+%     maxNumCompThreads and for the OpenMP kernels by ompThreads.
+%     Default [1 maxNumCompThreads].
+%   - repeat: number of timed runs per case (after a warm-up run), the
+%     median being kept. Default 5.
+%   - filter: regular expression selecting the cases by name (default all)
+%   - output: path of the JSON file where the results are written
+%     (default none)
+%
+% bench - structure with the fields meta (host, date, MATLAB version,
+% number of cores, OMP_NUM_THREADS, instruction set of the dispatched
+% kernels given by cpuInfo) and results, a structure array with
+% one element per (case, size, threads):
+%   - group, name, size, threads (number of threads of MATLAB)
+%   - ompThreads: number of threads of the OpenMP kernels during the runs
+%   - time, timeMin: median and minimum time of one run (s)
+%   - throughput: processed elements per second
+%   - bandwidth: bytes of the inputs and outputs per second
+%   - peakMemory: peak of the resident memory during the runs, above
+%     the memory at the start of the case (bytes, Linux only, NaN
+%     otherwise)
+%
+% The mex kernels which are not compiled are skipped. The number of
+% threads of the OpenMP kernels is not changed by maxNumCompThreads; it is
+% set by ompThreads (see buildOmpThreads). When ompThreads is not
+% compiled, it stays the one given by the environment variable
+% OMP_NUM_THREADS when MATLAB is started (recorded in meta.ompThreads) and
+% the kernels are run for the first number of threads only.
+%
+% See also benchCompare, BenchScript
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+if nargin < 1, opts = struct(); end
+if ~isfield(opts, 'groups'), opts.groups = {'kernels', 'operators', 'pipelines'}; end
+if ~isfield(opts, 'sizes'), opts.sizes = [128 512 2048]; end
+if ~isfield(opts, 'threads'), opts.threads = unique([1 maxNumCompThreads]); end
+if ~isfield(opts, 'repeat'), opts.repeat = 5; end
+if ~isfield(opts, 'filter'), opts.filter = ''; end
+if ~isfield(opts, 'output'), opts.output = ''; end
+
+[~, host] = system('hostname');
+bench.meta = struct('host', strtrim(host), 'date', datestr(now, 31), 'matlab', version, ...
+    'cores', feature('numcores'), 'ompThreads', getenv('OMP_NUM_THREADS'), 'cpu', '');
+if exist('cpuInfo') == 3
+    bench.meta.cpu = cpuInfo();
+end
+bench.results = struct('group', {}, 'name', {}, 'size', {}, 'threads', {}, 'ompThreads', {}, 'time', {}, 'timeMin', {}, ...
+    'throughput', {}, 'bandwidth', {}, 'peakMemory', {});
+
+nthOld = maxNumCompThreads;
+ompControl = exist('ompThreads') == 3; %#ok<EXIST>
+if ompControl
+    ompOld = ompThreads();
+    nOmp = ompOld;
+else
+    nOmp = str2double(bench.meta.ompThreads);
+    if isnan(nOmp), nOmp = feature('numcores'); end   % default of the OpenMP runtime
+end
+cases = benchCases();
+for nth = opts.threads
+    maxNumCompThreads(nth);
+    if ompControl, nOmp = ompThreads(nth); end
+    for c = 1:numel(cases)
+        cs = cases(c);
+        if ~any(strcmp(cs.group, opts.groups)) || (~isempty(opts.filter) && isempty(regexp(cs.name, opts.filter, 'once')))
+            continue;
+        end
+        if strcmp(cs.group, 'kernels') && ~ompControl && nth ~= opts.threads(1)
+            continue;                        % same number of OpenMP threads as the first run
+        end
+        if ~isempty(cs.mex) && ~all(cellfun(@(m) exist(m) == 3, cs.mex)) %#ok<EXIST>
+            continue;
+        end
+        if strcmp(cs.group, 'pipelines'), sizes = NaN; else, sizes = opts.sizes; end
+        for n = sizes
+            rng(1);
+            data = cs.setup(n);              % data of the case: f (timed function), elements, bytes, size
+            if isempty(data), continue; end
+            resetPeakMemory();
+            mem0 = residentMemory();
+            data.f();                        % warm-up (plans, caches, precomputations)
+            t = zeros(1, opts.repeat);
+            for r = 1:opts.repeat
+                tt = tic; data.f(); t(r) = toc(tt);
+            end
+            res.group = cs.group; res.name = cs.name; res.size = data.size; res.threads = nth; res.ompThreads = nOmp;
+            res.time = median(t); res.timeMin = min(t);
+            res.throughput = data.elements/res.time;
+            res.bandwidth = data.bytes/res.time;
+            res.peakMemory = peakMemory() - mem0;
+            bench.results(end+1) = res;
+            fprintf(' %-10s %-32s %-14s %3d threads (%3d OpenMP) : %10.4g s  %10.4g elem/s  %8.3g GB/s\n', res.group, res.name, ...
+                res.size, nth, nOmp, res.time, res.throughput, res.bandwidth/1e9);
+            clear data;
+        end
+    end
+end
+maxNumCompThreads(nthOld);
+if ompControl, ompThreads(ompOld); end
+
+if ~isempty(opts.output)
+    fid = fopen(opts.output, 'w');
+    assert(fid > 0, ['Cannot open the file ''', opts.output, '''']);
+    fprintf(fid, '%s', jsonencode(bench));
+    fclose(fid);
+end
+end
+
+%% Cases
+function cases = benchCases()
+% Each case gives the mex files it needs and a setup function of the
+% linear size n returning the timed function and the amount of data
+cases = struct('group', {}, 'name', {}, 'mex', {}, 'setup', {});
+% -- Native kernels
+cases(end+1) = mk('kernels', 'svd2D_decomp', {'svd2D_decomp'}, @(n) kern2(n, 3, @(x) svd2D_decomp(x), 3+4));
+cases(end+1) = mk('kernels', 'svd3D_decomp', {'svd3D_decomp'}, @(n) kern3(n, 6, @(x) svd3D_decomp(x), 6+3+9));
+cases(end+1) = mk('kernels', 'svd2D_recomp', {'svd2D_decomp', 'svd2D_recomp'}, @(n) kernRecomp(n, 2));
+cases(end+1) = mk('kernels', 'svd3D_recomp', {'svd3D_decomp', 'svd3D_recomp'}, @(n) kernRecomp(n, 3));
+cases(end+1) = mk('kernels', 'fftw_rft', {'fftw_rft'}, @(n) kern2(n, 1, @(x) Srft(x, []), 1+1));
+cases(end+1) = mk('kernels', 'sumDims', {'sumDims'}, @(n) kern3(n, 1, @(x) sumDims(x, [1 3]), 1));
+cases(end+1) = mk('kernels', 'sumPatches', {'sumPatches'}, @(n) kern2(n, 1, @(x) sumPatches(x, [n n]/4), 1));
+cases(end+1) = mk('kernels', 'cgFused dots', {'cgFused'}, @(n) kern2(n, 1, @(x) cgFused('dots', x, x, x, []), 3));
+cases(end+1) = mk('kernels', 'klFused applygrad', {'klFused'}, @(n) kern2(n, 1, @(x) klApplyGrad(x), 3));
+cases(end+1) = mk('kernels', 'cvgStats', {'cvgStats'}, @(n) kern2(n, 1, @(x) cvgStats(x, x+1), 2));
+cases(end+1) = mk('kernels', 'sparseMV apply', {'sparseMV'}, @(n) kernSparse(n));
+% -- Operators (3D for the convolutions, 2D for the others)
+cases(end+1) = mk('operators', 'LinOpConv apply', {}, @(n) op3(n, @(sz) LinOpConv(fftn(rand(sz))), 'apply'));
+cases(end+1) = mk('operators', 'LinOpConv applyAdjoint', {}, @(n) op3(n, @(sz) LinOpConv(fftn(rand(sz))), 'applyAdjoint'));
+cases(end+1) = mk('operators', 'LinOpConv (RFT) apply', {'fftw_rft'}, @(n) op3(n, @(sz) LinOpConv('PSF', rand(sz), 1, [], 'useRFT'), 'apply'));
+cases(end+1) = mk('operators', 'LinOpConvTiled apply', {}, @(n) op3(n, @(sz) LinOpConvTiled(rand(9, 9, 5), sz, [64 64 32]), 'apply'));
+cases(end+1) = mk('operators', 'LinOpGrad apply', {}, @(n) op2(n, @(sz) LinOpGrad(sz), 'apply'));
+cases(end+1) = mk('operators', 'LinOpGrad applyAdjoint', {}, @(n) op2(n, @(sz) LinOpGrad(sz), 'applyAdjoint'));
+cases(end+1) = mk('operators', 'LinOpHess apply', {}, @(n) op2(n, @(sz) LinOpHess(sz), 'apply'));
+cases(end+1) = mk('operators', 'CostMixNormSchatt1 prox', {'svd2D_decomp', 'svd2D_recomp'}, @(n) costProx(n));
+cases(end+1) = mk('operators', 'CostKullLeib applyAndGrad', {}, @(n) costKL(n));
+% -- Full pipelines (Example/DeconvEx)
+cases(end+1) = mk('pipelines', 'Deconv_LS_TV', {}, @(n) pipeline('Deconv_LS_TV'));
+cases(end+1) = mk('pipelines', 'Deconv_KL_TV_NonNeg', {}, @(n) pipeline('Deconv_KL_TV_NonNeg'));
+cases(end+1) = mk('pipelines', 'Deconv_LS_HessSchatt', {'svd2D_decomp', 'svd2D_recomp'}, @(n) pipeline('Deconv_LS_HessSchatt'));
+end
+
+function c = mk(group, name, mexFiles, setup)
+c = struct('group', group, 'name', name, 'mex', {mexFiles}, 'setup', setup);
+end
+
+function d = kern2(n, nc, f, nArrays)
+% 2D kernel applied to an n x n x nc array; nArrays arrays of n x n are read or written
+x = rand(n, n, nc);
+d = struct('f', @() f(x), 'elements', n^2, 'bytes', nArrays*n^2*8, 'size', sprintf('%dx%d', n, n));
+end
+
+function d = kern3(n, nc, f, nArrays)
+% 3D kernel applied to an n x n x n/4 x nc array
+sz = [n n max(n/4, 1)];
+x = rand([sz nc]);
+d = struct('f', @() f(x), 'elements', prod(sz), 'bytes', nArrays*prod(sz)*8, 'size', sprintf('%dx%dx%d', sz));
+end
+
+function d = kernRecomp(n, dim)
+if dim == 2
+    [E, V] = svd2D_decomp(rand(n, n, 3));
+    d = struct('f', @() svd2D_recomp(E, V), 'elements', n^2, 'bytes', (2+2+3)*n^2*8, 'size', sprintf('%dx%d', n, n));
+else
+    sz = [n n max(n/4, 1)];
+    [E, V] = svd3D_decomp(rand([sz 6]));
+    d = struct('f', @() svd3D_recomp(E, V), 'elements', prod(sz), 'bytes', (3+9+6)*prod(sz)*8, 'size', sprintf('%dx%dx%d', sz));
+end
+end
+
+function g = klApplyGrad(x)
+[~, g] = klFused('applygrad', x, x, 0.1);
+end
+
+function d = kernSparse(n)
+% Sparse matrix (n^2 x n^2) with 5 nonzeros per row
+M = spdiags(rand(n^2, 5), [-n -1 0 1 n], n^2, n^2);
+S = sparseMV('build', M, 'double');
+x = rand(n^2, 1);
+d = struct('f', @() sparseMV('apply', S, x), 'elements', nnz(M), 'bytes', nnz(M)*(8+4)+2*n^2*8, 'size', sprintf('%dx%d', n^2, n^2));
+end
+
+function d = op3(n, mkOp, method)
+% Method of a 3D operator of size n x n x n/4
+sz = [n n max(n/4, 1)];
+if prod(sz) > 2^27, d = []; return; end     % 1 GB per array
+H = mkOp(sz);
+x = rand(sz);
+d = struct('f', @() H.(method)(x), 'elements', prod(sz), 'bytes', 2*prod(sz)*8, 'size', sprintf('%dx%dx%d', sz));
+end
+
+function d = op2(n, mkOp, method)
+% Method of a 2D operator of size n x n
+sz = [n n];
+H = mkOp(sz);
+if strcmp(method, 'apply'), x = rand(H.sizein); else, x = rand(H.sizeout); end
+nOut = prod(H.sizeout)/prod(sz);
+d = struct('f', @() H.(method)(x), 'elements', prod(sz), 'bytes', (1+nOut)*prod(sz)*8, 'size', sprintf('%dx%d', sz));
+end
+
+function d = costProx(n)
+sz = [n n];
+C = CostMixNormSchatt1([sz 3], 1);
+x = rand([sz 3]);
+d = struct('f', @() C.applyProx(x, 1), 'elements', prod(sz), 'bytes', 6*prod(sz)*8, 'size', sprintf('%dx%d', sz));
+end
+
+function d = costKL(n)
+sz = [n n];
+y = 10*rand(sz);
+C = CostKullLeib(sz, y, 0.1);
+x = rand(sz);
+d = struct('f', @() C.applyAndGrad(x), 'elements', prod(sz), 'bytes', 3*prod(sz)*8, 'size', sprintf('%dx%d', sz));
+end
+
+function d = pipeline(script)
+% Full example script (figures closed, output discarded)
+d = struct('f', @() runScript(script), 'elements', NaN, 'bytes', NaN, 'size', '-');
+end
+
+function runScript(script)
+evalc(['run ', script]);
+close all;
+end
+
+%% Memory (Linux: /proc)
+function resetPeakMemory()
+% Resets the high water mark of the resident memory to the current value
+fid = fopen(sprintf('/proc/%d/clear_refs', feature('getpid')), 'w');
+if fid > 0
+    fprintf(fid, '5');
+    fclose(fid);
+end
+end
+
+function m = residentMemory()
+m = procStatus('VmRSS');
+end
+
+function m = peakMemory()
+m = procStatus('VmHWM');
+end
+
+function m = procStatus(field)
+% Field (in kB) of /proc/self/status converted to bytes, NaN if not available
+m = NaN;
+fid = fopen('/proc/self/status', 'r');
+if fid < 0, return; end
+txt = fread(fid, '*char')';
+fclose(fid);
+tok = regexp(txt, [field, ':\s*(\d+)\s*kB'], 'tokens', 'once');
+if ~isempty(tok), m = 1024*str2double(tok{1}); end
+end
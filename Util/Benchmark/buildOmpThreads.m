@@ -0,0 +1,41 @@
+function buildOmpThreads(options)
+%% buildOmpThreads function
+%   build the mex file setting the number of OpenMP threads of the kernels
+%
+%   You can give as a parameter of this function the path to your GCC
+%   compiler. Ex: buildOmpThreads('GCC=/usr/bin/gcc-6')
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+if nargin==0
+    options=[];
+end
+
+disp('Installing OmpThreads');
+get_architecture;
+if linux
+   options = [ options, ' CXXFLAGS='' -fopenmp ''',' LDFLAGS=''$LDFLAGS -fopenmp '''];
+else
+    disp('On your system and compiler,  OPENMP is desactivated: the number of threads of the kernels cannot be set. This can be tuned using the options parameter:');
+    disp('Example: options =  CXXFLAGS=  -fopenmp ');
+end
+
+[mpath,~,~] = fileparts(which('buildOmpThreads'));
+pth = cd;
+cd(mpath);
+MexOpt= ['-largeArrayDims ' ,options,  ' CXXFLAGS=''$CXXFLAGS -fPIC -Wall -O2  '''  ' LDFLAGS=''$LDFLAGS '''];
+eval(['mex ',' ompThreads.cpp ',MexOpt]);
+cd(pth);
+end
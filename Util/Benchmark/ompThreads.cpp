@@ -0,0 +1,42 @@
+#include <mex.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+
+/***************************************************************************
+  n = ompThreads(nth)
+
+  Sets the number of threads of the next OpenMP parallel regions to nth
+  (omp_set_num_threads) and returns the number of threads they use
+  (omp_get_max_threads). Without argument, only returns it. The setting
+  applies to the calling (MATLAB) thread in all the mex files linked with
+  the same OpenMP runtime, i.e. the native kernels compiled with -fopenmp,
+  which maxNumCompThreads does not control. Returns 1 when compiled
+  without OpenMP. Used by benchSuite to sweep the number of threads of
+  the kernels.
+
+  Compilation:
+     -linux: mex ompThreads.cpp CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildOmpThreads.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs>1 || (nrhs==1 && (!mxIsNumeric(prhs[0]) || mxGetNumberOfElements(prhs[0])!=1)))
+        mexErrMsgTxt("Usage: n = ompThreads(nth).\n");
+#ifdef _OPENMP
+    if (nrhs==1) {
+        int nth=(int)mxGetScalar(prhs[0]);
+        if (nth<1)
+            mexErrMsgTxt("The number of threads should be positive.\n");
+        omp_set_num_threads(nth);
+    }
+    plhs[0]=mxCreateDoubleScalar((double)omp_get_max_threads());
+#else
+    plhs[0]=mxCreateDoubleScalar(1.0);
+#endif
+}
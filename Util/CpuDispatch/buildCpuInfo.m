@@ -0,0 +1,33 @@
+function buildCpuInfo(options)
+%% buildCpuInfo function
+%   build the mex file reporting the instruction set of the dispatched kernels
+%
+%   You can give as a parameter of this function the path to your GCC
+%   compiler. Ex: buildCpuInfo('GCC=/usr/bin/gcc-6')
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+if nargin==0
+    options=[];
+end
+
+disp('Installing CpuInfo');
+[mpath,~,~] = fileparts(which('buildCpuInfo'));
+pth = cd;
+cd(mpath);
+MexOpt= ['-largeArrayDims ' ,options,  ' CXXFLAGS=''$CXXFLAGS -fPIC -Wall -O2  '''  ' LDFLAGS=''$LDFLAGS '''];
+eval(['mex ',' cpuInfo.cpp ',MexOpt]);
+cd(pth);
+end
@@ -0,0 +1,111 @@
+/***************************************************************************
+  Runtime dispatch of the mex kernels among variants compiled for several
+  instruction sets (x86: generic, SSE4.2, AVX2+FMA, AVX-512), such that a
+  single binary runs at the full vector width of each node of a
+  heterogeneous cluster.
+
+  A kernel compiles its hot functions (the ones containing the OpenMP
+  loops, since the outlined loop bodies inherit the instruction set of
+  their function) once per instruction set by including its own source
+  file with CPU_VARIANT defined:
+
+       #ifndef CPU_VARIANT
+       ... includes (with cpuDispatch.h), helpers ...
+       #define CPU_VARIANT CPU_GENERIC
+       #include "kernel.cpp"
+       ... (CPU_SSE4, CPU_AVX2, CPU_AVX512) ...
+       void mexFunction(...) { ... CPU_CALL(cpuIsa(),fun,(args)); ... }
+       #else
+       template <typename T> CPU_TARGET static void CPU_NAME(fun)(...) { ... }
+       #undef CPU_VARIANT
+       #endif
+
+  CPU_CALL(isa,fun,(args)) calls the variant of fun for isa (the template
+  arguments of fun must be deduced from args).
+
+  The helpers called in the loops are compiled once per variant too
+  (defined or included in the CPU_VARIANT section with CPU_TARGET and
+  CPU_NAME, see eig3x3.h): a helper compiled without target attribute
+  runs the generic code in all the variants.
+
+  cpuIsa() returns the best instruction set supported by the processor
+  (and by the OS), lowered to the one given by the environment variable
+  GLOBALBIOIM_CPU (generic, sse4, avx2 or avx512) when it is set, e.g.
+  setenv('GLOBALBIOIM_CPU','sse4') in MATLAB to test the SSE4 variants on
+  an AVX-512 machine (see cpuInfo). It is evaluated at each call of the
+  kernels. With compilers other than GCC/Clang or on other architectures
+  only the generic variant is used.
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+#ifndef CPUDISPATCH_H
+#define CPUDISPATCH_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CPU_GENERIC 0
+#define CPU_SSE4    1
+#define CPU_AVX2    2
+#define CPU_AVX512  3
+#define CPU_NUMBER  4
+
+static const char* const cpuIsaNames[CPU_NUMBER]={"generic","sse4","avx2","avx512"};
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86
+#define CPU_TARGET_0
+#define CPU_TARGET_1 __attribute__((target("sse4.2,popcnt")))
+#define CPU_TARGET_2 __attribute__((target("avx2,fma")))
+#define CPU_TARGET_3 __attribute__((target("avx512f,avx512dq,avx512bw,avx512vl,avx2,fma")))
+#else
+#define CPU_TARGET_0
+#define CPU_TARGET_1
+#define CPU_TARGET_2
+#define CPU_TARGET_3
+#endif
+
+// Attribute and name of a function in the variant CPU_VARIANT
+#define CPU_TARGET CPU_TARGET_(CPU_VARIANT)
+#define CPU_TARGET_(v) CPU_TARGET__(v)
+#define CPU_TARGET__(v) CPU_TARGET_##v
+#define CPU_NAME(f) CPU_NAME_(f,CPU_VARIANT)
+#define CPU_NAME_(f,v) CPU_NAME__(f,v)
+#define CPU_NAME__(f,v) f##_cpu##v
+
+#define CPU_CALL(isa,f,args) ((isa)==CPU_AVX512 ? f##_cpu3 args : (isa)==CPU_AVX2 ? f##_cpu2 args : \
+                              (isa)==CPU_SSE4 ? f##_cpu1 args : f##_cpu0 args)
+
+// Best instruction set supported by the processor and the OS
+static int cpuSupported() {
+    int isa=CPU_GENERIC;
+#ifdef CPU_DISPATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+        isa=CPU_SSE4;
+    if (isa==CPU_SSE4 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        isa=CPU_AVX2;
+    if (isa==CPU_AVX2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+        isa=CPU_AVX512;
+#endif
+    return isa;
+}
+
+// Instruction set of the variants called by CPU_CALL
+static int cpuIsa() {
+    int isa=cpuSupported();
+    const char* s=getenv("GLOBALBIOIM_CPU");
+    if (s!=NULL) {
+        for (int k=0;k<isa;k++) {
+            if (!strcmp(s,cpuIsaNames[k])) {
+                isa=k;
+                break;
+            }
+        }
+    }
+    return isa;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include <mex.h>
+#include "matrix.h"
+#include "cpuDispatch.h"
+
+/***************************************************************************
+  [isa,supported] = cpuInfo()
+
+  Instruction set of the variants run by the kernels compiled with
+  cpuDispatch.h (svd2D/3D_decomp/recomp, richLucyUpdate and ewChain), i.e.
+  the best one supported by the processor lowered to the environment
+  variable GLOBALBIOIM_CPU, and the best one supported by the processor.
+  Both are given as one of 'generic', 'sse4', 'avx2' or 'avx512'.
+
+  Compilation:
+     -linux: mex cpuInfo.cpp -largeArrayDims
+     (see buildCpuInfo.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs!=0)
+        mexErrMsgTxt("Usage: [isa,supported] = cpuInfo().\n");
+    plhs[0]=mxCreateString(cpuIsaNames[cpuIsa()]);
+    if (nlhs>1)
+        plhs[1]=mxCreateString(cpuIsaNames[cpuSupported()]);
+}
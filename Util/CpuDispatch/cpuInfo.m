@@ -0,0 +1,25 @@
+% function [isa,supported]=cpuInfo()
+%
+%  Instruction set ('generic', 'sse4', 'avx2' or 'avx512') of the variants
+%  run by the mex kernels compiled for several instruction sets (Schatten
+%  norm decompositions, richLucyUpdate and ewChain), and the best one
+%  supported by the processor. The variants are chosen at each call of
+%  the kernels; to force a lower instruction set (e.g. for testing):
+%       setenv('GLOBALBIOIM_CPU','sse4');
+%  and setenv('GLOBALBIOIM_CPU','') to restore the default. Mex
+%  implementation (see cpuDispatch.h).
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
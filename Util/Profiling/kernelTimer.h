@@ -0,0 +1,63 @@
+/***************************************************************************
+  KernelTimer timer(name[,cmd])
+
+  Timer of a mex kernel for mapProfiler. A KernelTimer declared at the
+  beginning of mexFunction measures the time spent in the kernel
+  (validation, allocation of the outputs and computations). When the
+  profiler is enabled (global variable isProfiling), this time is reported
+  on destruction with mapProfiler('kernel',label,seconds), which attributes
+  it to the Map (or Cost) being evaluated. When it is disabled, the only
+  cost is the lookup of the global variable.
+
+  Usage:
+       KernelTimer timer("sumDims");          // label sumDims
+       KernelTimer timer("sparseMV",cmd);     // label sparseMV.<cmd>
+
+  The kernels including this header are compiled with the option
+  -I<folder of mapProfiler> (see their build functions).
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+#ifndef KERNELTIMER_H
+#define KERNELTIMER_H
+
+#include "mex.h"
+#include <chrono>
+#include <string>
+
+class KernelTimer {
+public:
+    explicit KernelTimer(const char* name, const char* cmd=0) : enabled(false) {
+        const mxArray* flag=mexGetVariablePtr("global","isProfiling");
+        if (flag==0 || mxIsEmpty(flag) || mxGetScalar(flag)==0)
+            return;
+        enabled=true;
+        label=name;
+        if (cmd!=0 && cmd[0]!=0) {
+            label+='.';
+            label+=cmd;
+        }
+        t0=std::chrono::steady_clock::now();
+    }
+    ~KernelTimer() {
+        if (!enabled)
+            return;
+        double t=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+        mxArray* args[3]={mxCreateString("kernel"),mxCreateString(label.c_str()),mxCreateDoubleScalar(t)};
+        // Trapped such that a failure of the report never breaks the kernel
+        mxArray* err=mexCallMATLABWithTrap(0,0,3,args,"mapProfiler");
+        if (err!=0)
+            mxDestroyArray(err);
+        for (int k=0;k<3;k++)
+            mxDestroyArray(args[k]);
+    }
+private:
+    KernelTimer(const KernelTimer&);
+    KernelTimer& operator=(const KernelTimer&);
+    bool enabled;
+    std::string label;
+    std::chrono::steady_clock::time_point t0;
+};
+
+#endif
@@ -0,0 +1,256 @@
+function varargout = mapProfiler(cmd, varargin)
+%--------------------------------------------------------------
+% function varargout = mapProfiler(cmd, ...)
+%
+% Opt-in profiler of the evaluations of Maps and Costs. When it is
+% enabled, the entry points apply, applyJacobianT, applyInverse,
+% applyElementWise (Map), applyAdjoint, applyHtH, applyHHt,
+% applyAdjointInverse (LinOp), applyGrad, applyProx, applyProxFench and
+% applyAndGrad (Cost) record their wall time, the number of calls, the
+% size in bytes of their inputs and outputs and the memoize hits, both
+% per class and per node of the (composed) operator tree. The node of a
+% call is given by the stack of the evaluations it is nested in, e.g.
+%     MapComposition#1.apply;LinOpConv#2.apply
+% where #k numbers the instances of a class (in the order of their first
+% profiled call since the last 'clear'; the profiler keeps an identifier
+% per Map, in its hidden property profileId, and no reference to the
+% Maps). An evaluation which throws an error is not recorded and its
+% frame is removed from the stack. The mex kernels report the
+% time they spend (see kernelTimer.h) as leaves of the node which calls
+% them.
+%
+%   mapProfiler('on')          enables the profiler (global isProfiling)
+%   mapProfiler('off')         disables it (the statistics are kept)
+%   mapProfiler('clear')       resets the statistics
+%   rep = mapProfiler('report') structure with the fields
+%       - classes: one element per class and method (or kernel) with
+%         the fields name, calls, time, selfTime, bytesIn, bytesOut and
+%         memoHits (sorted by decreasing time)
+%       - nodes: one element per node (field stack) with the same
+%         fields plus sizeIn and sizeOut (sizes of the last call)
+%     Without output argument, the statistics per class are displayed.
+%   lines = mapProfiler('folded')  folded stacks ('stack selfTime' with
+%     the self time in microseconds), the input format of flamegraph.pl
+%     and speedscope
+%   mapProfiler('folded',file)     writes the folded stacks to file
+%
+% The time of a node includes the time of its children, its self time
+% does not. The time of a class counts nested calls of the same class
+% and method only once. Evaluations on parallel workers are not
+% recorded.
+%
+% Example:
+%   mapProfiler('on');
+%   opt.run(x0);
+%   mapProfiler('off');
+%   mapProfiler('report');
+%   mapProfiler('folded','admm.folded');
+%
+% Internal commands (entry points and kernels):
+%   tok = mapProfiler('enter',obj,method,in), mapProfiler('exit',tok,out),
+%   mapProfiler('abort',tok) (evaluation which threw an error),
+%   mapProfiler('memoHit'), mapProfiler('kernel',name,seconds)
+%
+% See also: Map, Cost, benchSuite
+%
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%--------------------------------------------------------------
+
+global isProfiling
+persistent P lastId
+if isempty(P)
+    P = newProfile();
+    lastId = 0;
+end
+
+switch cmd
+    case 'enter'
+        obj = varargin{1};
+        cls = class(obj);
+        % Instance number of obj among the profiled objects of its class
+        if obj.profileId == 0
+            lastId = lastId + 1;
+            obj.profileId = lastId;
+        end
+        if isKey(P.objs, obj.profileId)
+            k = P.objs(obj.profileId);
+        else
+            if isKey(P.instances, cls)
+                k = P.instances(cls) + 1;
+            else
+                k = 1;
+            end
+            P.instances(cls) = k;
+            P.objs(obj.profileId) = k;
+        end
+        label = sprintf('%s#%d.%s', cls, k, varargin{2});
+        if isempty(P.stack)
+            key = label;
+        else
+            key = [P.nodes(P.stack(end).node).stack, ';', label];
+        end
+        [P, n] = getEntry(P, 'nodes', key);
+        [P, c] = getEntry(P, 'classes', [cls, '.', varargin{2}]);
+        P.classes(c).active = P.classes(c).active + 1;
+        in = varargin{3};
+        P.nodes(n).sizeIn = size(in);
+        if iscell(in), P.nodes(n).sizeIn = size(in{1}); end
+        P.stack(end+1) = struct('node', n, 'cls', c, 'child', 0, 'bytesIn', byteSize(in), 't0', tic);
+        varargout{1} = numel(P.stack);
+    case 'exit'
+        tok = varargin{1};
+        if tok > numel(P.stack) % profiler reset during the call
+            return;
+        end
+        t = toc(P.stack(tok).t0);
+        % Frames above tok were left by nested calls which did not exit
+        for s = numel(P.stack):-1:tok+1
+            P.classes(P.stack(s).cls).active = P.classes(P.stack(s).cls).active - 1;
+        end
+        f = P.stack(tok);
+        P.stack(tok:end) = [];
+        out = varargin{2};
+        bytesOut = byteSize(out);
+        n = f.node;
+        P.nodes(n).calls = P.nodes(n).calls + 1;
+        P.nodes(n).time = P.nodes(n).time + t;
+        P.nodes(n).selfTime = P.nodes(n).selfTime + t - f.child;
+        P.nodes(n).bytesIn = P.nodes(n).bytesIn + f.bytesIn;
+        P.nodes(n).bytesOut = P.nodes(n).bytesOut + bytesOut;
+        P.nodes(n).sizeOut = size(out);
+        c = f.cls;
+        P.classes(c).active = P.classes(c).active - 1;
+        P.classes(c).calls = P.classes(c).calls + 1;
+        if P.classes(c).active == 0
+            P.classes(c).time = P.classes(c).time + t;
+        end
+        P.classes(c).selfTime = P.classes(c).selfTime + t - f.child;
+        P.classes(c).bytesIn = P.classes(c).bytesIn + f.bytesIn;
+        P.classes(c).bytesOut = P.classes(c).bytesOut + bytesOut;
+        if ~isempty(P.stack)
+            P.stack(end).child = P.stack(end).child + t;
+        end
+    case 'abort'
+        tok = varargin{1};
+        % Frames of the evaluation which threw an error and of its nested calls
+        for s = numel(P.stack):-1:tok
+            P.classes(P.stack(s).cls).active = P.classes(P.stack(s).cls).active - 1;
+        end
+        P.stack(tok:end) = [];
+    case 'memoHit'
+        if ~isempty(P.stack)
+            n = P.stack(end).node; c = P.stack(end).cls;
+            P.nodes(n).memoHits = P.nodes(n).memoHits + 1;
+            P.classes(c).memoHits = P.classes(c).memoHits + 1;
+        end
+    case 'kernel'
+        name = varargin{1}; t = varargin{2};
+        if isempty(P.stack)
+            key = name;
+        else
+            key = [P.nodes(P.stack(end).node).stack, ';', name];
+            P.stack(end).child = P.stack(end).child + t;
+        end
+        [P, n] = getEntry(P, 'nodes', key);
+        [P, c] = getEntry(P, 'classes', name);
+        P.nodes(n).calls = P.nodes(n).calls + 1;
+        P.nodes(n).time = P.nodes(n).time + t;
+        P.nodes(n).selfTime = P.nodes(n).selfTime + t;
+        P.classes(c).calls = P.classes(c).calls + 1;
+        P.classes(c).time = P.classes(c).time + t;
+        P.classes(c).selfTime = P.classes(c).selfTime + t;
+    case 'on'
+        isProfiling = true;
+        P.stack = P.stack([]);
+    case 'off'
+        isProfiling = false;
+        P.stack = P.stack([]);
+    case 'clear'
+        P = newProfile();
+    case 'report'
+        rep.classes = sortByTime(rmfield(P.classes, 'active'));
+        rep.nodes = sortByTime(P.nodes);
+        if nargout == 0
+            fprintf('%-48s %8s %11s %11s %11s %8s\n', 'Class.method', 'calls', 'time (s)', 'self (s)', 'out (MB)', 'memo');
+            for c = 1:numel(rep.classes)
+                e = rep.classes(c);
+                fprintf('%-48s %8d %11.4f %11.4f %11.2f %8d\n', e.name, e.calls, e.time, e.selfTime, e.bytesOut/2^20, e.memoHits);
+            end
+        else
+            varargout{1} = rep;
+        end
+    case 'folded'
+        lines = cell(numel(P.nodes), 1);
+        for n = 1:numel(P.nodes)
+            lines{n} = sprintf('%s %d', P.nodes(n).stack, round(1e6*max(P.nodes(n).selfTime, 0)));
+        end
+        if isempty(varargin)
+            varargout{1} = lines;
+        else
+            fid = fopen(varargin{1}, 'w');
+            assert(fid > 0, ['Cannot open the file ''', varargin{1}, '''']);
+            fprintf(fid, '%s\n', lines{:});
+            fclose(fid);
+        end
+    otherwise
+        error('mapProfiler: unknown command %s', cmd);
+end
+end
+
+function P = newProfile()
+% Empty statistics
+P.classes = struct('name', {}, 'calls', {}, 'time', {}, 'selfTime', {}, 'bytesIn', {}, 'bytesOut', {}, 'memoHits', {}, 'active', {});
+P.nodes = struct('stack', {}, 'calls', {}, 'time', {}, 'selfTime', {}, 'bytesIn', {}, 'bytesOut', {}, 'memoHits', {}, 'sizeIn', {}, 'sizeOut', {});
+P.index = struct('classes', containers.Map(), 'nodes', containers.Map());
+P.objs = containers.Map('KeyType', 'double', 'ValueType', 'double');      % profileId -> instance number
+P.instances = containers.Map('KeyType', 'char', 'ValueType', 'double');  % class -> number of instances
+P.stack = struct('node', {}, 'cls', {}, 'child', {}, 'bytesIn', {}, 't0', {});
+end
+
+function [P, k] = getEntry(P, field, key)
+% Index of the entry key of P.(field), created if needed
+idx = P.index.(field);
+if isKey(idx, key)
+    k = idx(key);
+else
+    k = numel(P.(field)) + 1;
+    idx(key) = k;
+    if strcmp(field, 'classes')
+        P.classes(k) = struct('name', key, 'calls', 0, 'time', 0, 'selfTime', 0, 'bytesIn', 0, 'bytesOut', 0, 'memoHits', 0, 'active', 0);
+    else
+        P.nodes(k) = struct('stack', key, 'calls', 0, 'time', 0, 'selfTime', 0, 'bytesIn', 0, 'bytesOut', 0, 'memoHits', 0, 'sizeIn', [], 'sizeOut', []);
+    end
+end
+end
+
+function b = byteSize(x)
+% Size in bytes of the array x (or of the arrays in the cell x)
+if iscell(x)
+    b = 0;
+    for k = 1:numel(x)
+        b = b + byteSize(x{k});
+    end
+else
+    w = whos('x');
+    b = w.bytes;
+end
+end
+
+function s = sortByTime(s)
+% Sorts the entries by decreasing time
+[~, order] = sort([s.time], 'descend');
+s = s(order);
+end
@@ -0,0 +1,568 @@
+#include <mex.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+
+/***************************************************************************
+  Memory-mapped reader and writer of multi-page TIFF and BigTIFF stacks
+  (used by loadtiff and saveastiff):
+
+     info = tiffStack('info',path)
+           walks the image file directories (IFDs) and returns a struct
+           with the fields width, height, spp (samples per pixel), bps
+           (bits per sample), format (SampleFormat), compression,
+           predictor, planar, tiled, nframes, bigtiff, uniform (all the
+           pages have the same size and sample type) and supported (all
+           the pages can be read by this file).
+     img = tiffStack('read',path,frames,rows,cols)
+           reads the pages listed in frames (1-based, all if empty),
+           restricted to the rows [rows(1),rows(2)] and the columns
+           [cols(1),cols(2)] (1-based, inclusive, all if empty). img is of
+           size [nrows ncols spp nframes] and of the class given by bps
+           and format. Only the strips intersecting the requested rows are
+           touched, such that a slice range or a sub-volume of a large
+           file is read without loading the rest of the file.
+     tiffStack('write',path,data,big,extra)
+           writes the [height width spp nframes] array data as an
+           uncompressed stack (one strip per page), BigTIFF if big is
+           true or if the whole classic layout (header, IFDs, tag values
+           and pixels) exceeds 4 GiB. extra lists the ExtraSamples values (the samples which
+           are not part of the gray/RGB color model). The file is
+           preallocated and the pages are written in parallel.
+
+  The file is mapped in memory (mmap, POSIX systems) and the pages are
+  decoded in parallel (one page per thread), directly from the mapping
+  for uncompressed pages. Supported encodings: no compression, PackBits and
+  LZW (with or without horizontal predictor), 8, 16, 32 or 64 bits per
+  sample, unsigned, signed or floating point samples, chunky or planar
+  configuration, little or big endian files. Tiled files are not
+  supported (supported=false in info). The errors found once the file is
+  mapped are raised after the mapping is released (mexErrMsgTxt does not
+  return, such that the destructors would not be called).
+
+  Compilation:
+     -linux: mex tiffStack.cpp CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" -largeArrayDims
+     (see buildTiff.m)
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+
+enum { TAG_WIDTH=256, TAG_HEIGHT=257, TAG_BPS=258, TAG_COMPRESSION=259, TAG_PHOTOMETRIC=262,
+       TAG_STRIPOFFSETS=273, TAG_SPP=277, TAG_ROWSPERSTRIP=278, TAG_STRIPBYTECOUNTS=279,
+       TAG_PLANAR=284, TAG_PREDICTOR=317, TAG_TILEWIDTH=322, TAG_EXTRASAMPLES=338, TAG_SAMPLEFORMAT=339 };
+enum { COMP_NONE=1, COMP_LZW=5, COMP_PACKBITS=32773 };
+
+struct Page {
+    uint64_t width=0, height=0, rowsPerStrip=0;
+    int spp=1, bps=0, format=1, compression=COMP_NONE, predictor=1, planar=1;
+    bool tiled=false;
+    std::vector<uint64_t> offsets, counts;
+};
+
+// Read-only memory mapping of a file
+struct MappedFile {
+    const uint8_t* p=NULL;
+    uint64_t size=0;
+    int fd=-1;
+    bool open(const char* path) {
+        fd=::open(path,O_RDONLY);
+        if (fd<0) return false;
+        struct stat st;
+        if (fstat(fd,&st)!=0 || st.st_size<8) { close(); return false; }
+        size=(uint64_t)st.st_size;
+        void* m=mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+        if (m==MAP_FAILED) { close(); return false; }
+        p=(const uint8_t*)m;
+        return true;
+    }
+    void close() {
+        if (p) munmap((void*)p,size);
+        if (fd>=0) ::close(fd);
+        p=NULL; fd=-1;
+    }
+    ~MappedFile() { close(); }
+};
+
+// Message of the error found while the file is mapped (raised by mexFunction
+// once the mapping is released)
+static char errMsg[4200];
+static const char* fail(const char* fmt, ...) {
+    va_list args;
+    va_start(args,fmt);
+    vsnprintf(errMsg,sizeof(errMsg),fmt,args);
+    va_end(args);
+    return errMsg;
+}
+
+// Parser of the IFDs (byte order and classic/BigTIFF offsets)
+struct Parser {
+    const MappedFile& f;
+    bool swap=false, big=false;
+    Parser(const MappedFile& file) : f(file) {}
+    uint64_t get(uint64_t o, int nb) const {
+        uint64_t v=0;
+        for (int k=0;k<nb;k++) {
+            uint64_t b=f.p[o+k];
+            v|=swap ? (b<<(8*(nb-1-k))) : (b<<(8*k));
+        }
+        return v;
+    }
+    static int typeSize(int type) {
+        switch (type) {
+            case 1: case 2: case 6: case 7: return 1;
+            case 3: case 8: return 2;
+            case 4: case 9: case 11: case 13: return 4;
+            case 16: case 17: case 18: return 8;
+            default: return 0;
+        }
+    }
+    // Values of an integer tag of the entry at e
+    bool values(uint64_t e, std::vector<uint64_t>& v) const {
+        int type=(int)get(e+2,2), ts=typeSize(type);
+        uint64_t count=big ? get(e+4,8) : get(e+4,4);
+        uint64_t field=big ? e+12 : e+8, fieldSize=big ? 8 : 4;
+        if (ts==0 || count>f.size) return false;
+        uint64_t o=(count*ts<=fieldSize) ? field : (big ? get(field,8) : get(field,4));
+        if (o+count*ts>f.size) return false;
+        v.resize(count);
+        for (uint64_t k=0;k<count;k++) v[k]=get(o+k*ts,ts);
+        return true;
+    }
+    // Header and all the IFDs; returns an error message or NULL
+    const char* parse(std::vector<Page>& pages) {
+        if (f.p[0]=='I' && f.p[1]=='I') swap=false;
+        else if (f.p[0]=='M' && f.p[1]=='M') swap=true;
+        else return "Not a TIFF file.\n";
+        // Multi-byte reads assume a little-endian host for 'II' files
+        uint64_t magic=get(2,2), ifd;
+        if (magic==42) ifd=get(4,4);
+        else if (magic==43) { big=true; if (f.size<16) return "Truncated BigTIFF header.\n"; ifd=get(8,8); }
+        else return "Not a TIFF file.\n";
+        uint64_t entrySize=big ? 20 : 12, countSize=big ? 8 : 2, nextSize=big ? 8 : 4;
+        while (ifd!=0) {
+            if (ifd+countSize>f.size || pages.size()>f.size/entrySize) return "Corrupted IFD.\n";
+            uint64_t n=get(ifd,(int)countSize);
+            if (ifd+countSize+n*entrySize+nextSize>f.size) return "Corrupted IFD.\n";
+            Page pg;
+            std::vector<uint64_t> v;
+            for (uint64_t k=0;k<n;k++) {
+                uint64_t e=ifd+countSize+k*entrySize;
+                int tag=(int)get(e,2);
+                if (tag==TAG_TILEWIDTH) { pg.tiled=true; continue; }
+                if (tag!=TAG_WIDTH && tag!=TAG_HEIGHT && tag!=TAG_BPS && tag!=TAG_COMPRESSION && tag!=TAG_STRIPOFFSETS &&
+                    tag!=TAG_SPP && tag!=TAG_ROWSPERSTRIP && tag!=TAG_STRIPBYTECOUNTS && tag!=TAG_PLANAR &&
+                    tag!=TAG_PREDICTOR && tag!=TAG_SAMPLEFORMAT) continue;
+                if (!values(e,v) || v.empty()) return "Corrupted tag.\n";
+                switch (tag) {
+                    case TAG_WIDTH: pg.width=v[0]; break;
+                    case TAG_HEIGHT: pg.height=v[0]; break;
+                    case TAG_BPS: pg.bps=(int)v[0]; break;
+                    case TAG_COMPRESSION: pg.compression=(int)v[0]; break;
+                    case TAG_STRIPOFFSETS: pg.offsets=v; break;
+                    case TAG_SPP: pg.spp=(int)v[0]; break;
+                    case TAG_ROWSPERSTRIP: pg.rowsPerStrip=v[0]; break;
+                    case TAG_STRIPBYTECOUNTS: pg.counts=v; break;
+                    case TAG_PLANAR: pg.planar=(int)v[0]; break;
+                    case TAG_PREDICTOR: pg.predictor=(int)v[0]; break;
+                    case TAG_SAMPLEFORMAT: pg.format=(int)v[0]; break;
+                }
+            }
+            if (pg.bps==0) pg.bps=1;
+            if (pg.rowsPerStrip==0 || pg.rowsPerStrip>pg.height) pg.rowsPerStrip=pg.height;
+            pages.push_back(pg);
+            ifd=get(ifd+countSize+n*entrySize,(int)nextSize);
+        }
+        return NULL;
+    }
+};
+
+static bool pageSupported(const Page& pg) {
+    if (pg.tiled || pg.width==0 || pg.height==0 || pg.spp<1) return false;
+    if (pg.bps!=8 && pg.bps!=16 && pg.bps!=32 && pg.bps!=64) return false;
+    if (pg.format<1 || pg.format>3 || (pg.format==3 && pg.bps<32)) return false;
+    if (pg.compression!=COMP_NONE && pg.compression!=COMP_LZW && pg.compression!=COMP_PACKBITS) return false;
+    if (pg.predictor!=1 && (pg.predictor!=2 || pg.format==3)) return false;
+    if (pg.planar!=1 && pg.planar!=2) return false;
+    uint64_t nStrips=(pg.height+pg.rowsPerStrip-1)/pg.rowsPerStrip*(pg.planar==2 ? pg.spp : 1);
+    return pg.offsets.size()==nStrips && pg.counts.size()==nStrips;
+}
+
+static bool sameLayout(const Page& a, const Page& b) {
+    return a.width==b.width && a.height==b.height && a.spp==b.spp && a.bps==b.bps && a.format==b.format;
+}
+
+static mxClassID classOf(const Page& pg) {
+    if (pg.format==3) return pg.bps==32 ? mxSINGLE_CLASS : mxDOUBLE_CLASS;
+    switch (pg.bps) {
+        case 8: return pg.format==2 ? mxINT8_CLASS : mxUINT8_CLASS;
+        case 16: return pg.format==2 ? mxINT16_CLASS : mxUINT16_CLASS;
+        case 32: return pg.format==2 ? mxINT32_CLASS : mxUINT32_CLASS;
+        default: return pg.format==2 ? mxINT64_CLASS : mxUINT64_CLASS;
+    }
+}
+
+// PackBits decoding; returns the number of bytes written
+static uint64_t unpackBits(const uint8_t* s, uint64_t n, uint8_t* d, uint64_t dn) {
+    uint64_t i=0, o=0;
+    while (i<n && o<dn) {
+        int8_t c=(int8_t)s[i++];
+        if (c>=0) {
+            uint64_t l=(uint64_t)c+1;
+            if (i+l>n || o+l>dn) break;
+            memcpy(d+o,s+i,l); i+=l; o+=l;
+        } else if (c!=-128) {
+            uint64_t l=(uint64_t)(1-c);
+            if (i>=n || o+l>dn) break;
+            memset(d+o,s[i++],l); o+=l;
+        }
+    }
+    return o;
+}
+
+// LZW decoding (TIFF variant: MSB-first codes of 9 to 12 bits, early change)
+static uint64_t unLZW(const uint8_t* s, uint64_t n, uint8_t* d, uint64_t dn) {
+    std::vector<uint16_t> prefix(4096), len(4096);
+    std::vector<uint8_t> suffix(4096), first(4096);
+    for (int k=0;k<256;k++) { prefix[k]=0; len[k]=1; suffix[k]=(uint8_t)k; first[k]=(uint8_t)k; }
+    uint64_t bit=0, nbits=n*8, o=0;
+    int width=9, next=258, old=-1;
+    while (bit+width<=nbits) {
+        int code=0;
+        for (int k=0;k<width;k++,bit++)
+            code=(code<<1) | ((s[bit>>3]>>(7-(bit&7)))&1);
+        if (code==257) break;
+        if (code==256) { width=9; next=258; old=-1; continue; }
+        int out;
+        if (old<0) {
+            if (code>255) break;
+            out=code;
+        } else if (code<next) {
+            out=code;
+            if (next<4096) {
+                prefix[next]=(uint16_t)old; suffix[next]=first[code]; first[next]=first[old];
+                len[next]=(uint16_t)(len[old]+1); next++;
+            }
+        } else if (code==next && next<4096) {
+            prefix[next]=(uint16_t)old; suffix[next]=first[old]; first[next]=first[old];
+            len[next]=(uint16_t)(len[old]+1); next++;
+            out=code;
+        } else break;
+        uint64_t l=len[out];
+        if (o+l>dn) break;
+        for (int c=out,k=(int)l-1;k>=0;k--,c=prefix[c]) d[o+k]=suffix[c];
+        o+=l;
+        old=out;
+        if (next+1>=(1<<width) && width<12) width++;
+    }
+    return o;
+}
+
+static inline void swapBytes(uint8_t* p, int nb) {
+    for (int k=0;k<nb/2;k++) { uint8_t t=p[k]; p[k]=p[nb-1-k]; p[nb-1-k]=t; }
+}
+
+// Undoes the horizontal predictor on a decoded strip (native byte order)
+template <typename T>
+static void undoPredictor(T* v, uint64_t nRows, uint64_t width, int stride) {
+    for (uint64_t r=0;r<nRows;r++) {
+        T* row=v+r*width*stride;
+        for (uint64_t c=stride;c<width*stride;c++) row[c]=(T)(row[c]+row[c-stride]);
+    }
+}
+
+// Decodes the rows [r0,r1) x columns [c0,c1) of a page into out (column major,
+// [nr nc spp]); returns false on a corrupted page
+static bool readPage(const MappedFile& f, const Parser& ps, const Page& pg, uint64_t r0, uint64_t r1,
+                     uint64_t c0, uint64_t c1, uint8_t* out, std::vector<uint8_t>& buf) {
+    int nb=pg.bps/8, spp=pg.spp;
+    uint64_t nr=r1-r0, nc=c1-c0, rps=pg.rowsPerStrip, w=pg.width;
+    uint64_t stripsPerPlane=(pg.height+rps-1)/rps;
+    int nPlanes=(pg.planar==2) ? spp : 1, sppStrip=(pg.planar==2) ? 1 : spp;
+    bool swap=ps.swap && nb>1;
+    for (int pl=0;pl<nPlanes;pl++)
+        for (uint64_t s=r0/rps;s<stripsPerPlane && s*rps<r1;s++) {
+            uint64_t sIdx=pl*stripsPerPlane+s, off=pg.offsets[sIdx], cnt=pg.counts[sIdx];
+            uint64_t rowsIn=(s+1)*rps<=pg.height ? rps : pg.height-s*rps;
+            uint64_t need=rowsIn*w*sppStrip*nb;
+            if (off+cnt>f.size) return false;
+            const uint8_t* src;
+            bool srcSwap=swap;
+            if (pg.compression==COMP_NONE) {
+                if (cnt<need) return false;
+                src=f.p+off;
+            } else {
+                if (buf.size()<need) buf.resize(need);
+                uint64_t got=(pg.compression==COMP_LZW) ? unLZW(f.p+off,cnt,buf.data(),need)
+                                                         : unpackBits(f.p+off,cnt,buf.data(),need);
+                if (got<need) return false;
+                if (swap)
+                    for (uint64_t k=0;k<need;k+=nb) swapBytes(buf.data()+k,nb);
+                if (pg.predictor==2) {
+                    switch (nb) {
+                        case 1: undoPredictor((uint8_t*)buf.data(),rowsIn,w,sppStrip); break;
+                        case 2: undoPredictor((uint16_t*)buf.data(),rowsIn,w,sppStrip); break;
+                        case 4: undoPredictor((uint32_t*)buf.data(),rowsIn,w,sppStrip); break;
+                        default: undoPredictor((uint64_t*)buf.data(),rowsIn,w,sppStrip); break;
+                    }
+                }
+                src=buf.data();
+                srcSwap=false;
+            }
+            uint64_t ra=(s*rps>r0) ? s*rps : r0, rb=(s*rps+rowsIn<r1) ? s*rps+rowsIn : r1;
+            for (uint64_t r=ra;r<rb;r++)
+                for (int k=0;k<sppStrip;k++) {
+                    int sample=(pg.planar==2) ? pl : k;
+                    const uint8_t* in=src+(((r-s*rps)*w+c0)*sppStrip+k)*nb;
+                    uint8_t* o=out+((uint64_t)sample*nr*nc+(r-r0))*nb;
+                    for (uint64_t c=0;c<nc;c++,in+=sppStrip*nb,o+=nr*nb) {
+                        memcpy(o,in,nb);
+                        if (srcSwap) swapBytes(o,nb);
+                    }
+                }
+        }
+    return true;
+}
+
+// Range [a,b) from an optional 1-based inclusive [first last] pair (its
+// class and size being checked before the mapping); returns an error
+// message or NULL
+static const char* range(const mxArray* m, uint64_t n, uint64_t& a, uint64_t& b, const char* what) {
+    a=0; b=n;
+    if (m && !mxIsEmpty(m)) {
+        double* v=mxGetPr(m);
+        if (v[0]<1 || v[1]<v[0] || v[1]>(double)n) return fail("%s out of range.\n",what);
+        a=(uint64_t)v[0]-1; b=(uint64_t)v[1];
+    }
+    return NULL;
+}
+
+// Reads the requested pages of the mapped file; returns an error message or NULL
+static const char* readStack(int nrhs, const mxArray* prhs[], mxArray* plhs[], const MappedFile& f, Parser& ps,
+                             const std::vector<Page>& pages) {
+    std::vector<uint64_t> frames;
+    if (nrhs>2 && !mxIsEmpty(prhs[2])) {
+        double* v=mxGetPr(prhs[2]);
+        for (size_t k=0;k<mxGetNumberOfElements(prhs[2]);k++) {
+            if (v[k]<1 || v[k]>(double)pages.size()) return fail("Frame index out of range.\n");
+            frames.push_back((uint64_t)v[k]-1);
+        }
+    } else
+        for (uint64_t k=0;k<pages.size();k++) frames.push_back(k);
+    if (frames.empty()) return fail("No frame to read.\n");
+    const Page& p0=pages[frames[0]];
+    for (uint64_t k : frames)
+        if (!pageSupported(pages[k]) || !sameLayout(pages[k],p0))
+            return fail("The requested pages are not supported or do not have the same size and type (see tiffStack('info',path)).\n");
+    uint64_t r0,r1,c0,c1;
+    const char* err=range(nrhs>3 ? prhs[3] : NULL,p0.height,r0,r1,"rows");
+    if (!err) err=range(nrhs>4 ? prhs[4] : NULL,p0.width,c0,c1,"cols");
+    if (err) return err;
+    mwSize dims[4]={(mwSize)(r1-r0),(mwSize)(c1-c0),(mwSize)p0.spp,(mwSize)frames.size()};
+    plhs[0]=mxCreateNumericArray(4,dims,classOf(p0),mxREAL);
+    if (plhs[0] == NULL)
+        return fail("Could not create mxArray.\n");
+    uint8_t* out=(uint8_t*)mxGetData(plhs[0]);
+    uint64_t frameBytes=dims[0]*dims[1]*dims[2]*(p0.bps/8);
+    long nf=(long)frames.size(), nbad=0;
+    #pragma omp parallel reduction(+:nbad)
+    {
+        std::vector<uint8_t> buf;
+        #pragma omp for schedule(dynamic)
+        for (long k=0;k<nf;k++)
+            if (!readPage(f,ps,pages[frames[k]],r0,r1,c0,c1,out+k*frameBytes,buf)) nbad++;
+    }
+    if (nbad>0) return fail("%ld corrupted page(s).\n",nbad);
+    return NULL;
+}
+
+// Appends the IFD entry of a SHORT/LONG/LONG8 tag; values that do not fit
+// in the entry are stored at ext (advanced)
+static void putEntry(uint8_t* e, bool big, int tag, int type, const std::vector<uint64_t>& v, uint8_t* base,
+                     uint64_t baseOffset, uint64_t& ext) {
+    int ts=Parser::typeSize(type);
+    uint64_t fieldSize=big ? 8 : 4;
+    uint16_t t16=(uint16_t)tag, ty16=(uint16_t)type;
+    memcpy(e,&t16,2); memcpy(e+2,&ty16,2);
+    if (big) { uint64_t c=v.size(); memcpy(e+4,&c,8); }
+    else { uint32_t c=(uint32_t)v.size(); memcpy(e+4,&c,4); }
+    uint8_t* field=e+(big ? 12 : 8);
+    memset(field,0,fieldSize);
+    uint8_t* dst=field;
+    if (v.size()*ts>fieldSize) {
+        dst=base+ext;
+        uint64_t o=baseOffset+ext;
+        memcpy(field,&o,fieldSize);
+        ext+=(v.size()*ts+7)&~(uint64_t)7;
+    }
+    for (size_t k=0;k<v.size();k++) memcpy(dst+k*ts,&v[k],ts);   // little-endian host
+}
+
+static void writeStack(int nrhs, const mxArray* prhs[]) {
+    if (nrhs<3) mexErrMsgTxt("Usage: tiffStack('write',path,data,big,extra).\n");
+    const mxArray* data=prhs[2];
+    if (!mxIsNumeric(data) || mxIsComplex(data) || mxIsSparse(data) || mxIsEmpty(data))
+        mexErrMsgTxt("data should be a non-empty real numeric array.\n");
+    bool big=(nrhs>3) && mxGetScalar(prhs[3])!=0;
+    std::vector<uint64_t> extra;
+    if (nrhs>4)
+        for (size_t k=0;k<mxGetNumberOfElements(prhs[4]);k++) extra.push_back((uint64_t)mxGetPr(prhs[4])[k]);
+    mwSize nd=mxGetNumberOfDimensions(data);
+    const mwSize* d=mxGetDimensions(data);
+    if (nd>4) mexErrMsgTxt("data should be of size [height width spp nframes].\n");
+    uint64_t h=d[0], w=d[1], spp=nd>2 ? d[2] : 1, nf=nd>3 ? d[3] : 1;
+    if (extra.size()>=spp) mexErrMsgTxt("Too many extra samples.\n");
+    int nb, format;
+    switch (mxGetClassID(data)) {
+        case mxUINT8_CLASS: nb=1; format=1; break;
+        case mxINT8_CLASS: nb=1; format=2; break;
+        case mxUINT16_CLASS: nb=2; format=1; break;
+        case mxINT16_CLASS: nb=2; format=2; break;
+        case mxUINT32_CLASS: nb=4; format=1; break;
+        case mxINT32_CLASS: nb=4; format=2; break;
+        case mxUINT64_CLASS: nb=8; format=1; break;
+        case mxINT64_CLASS: nb=8; format=2; break;
+        case mxSINGLE_CLASS: nb=4; format=3; break;
+        case mxDOUBLE_CLASS: nb=8; format=3; break;
+        default: mexErrMsgTxt("Unsupported class.\n"); return;
+    }
+    uint64_t pageBytes=h*w*spp*nb;
+    // Page block: IFD, external tag values, pixels
+    const int nTags=extra.empty() ? 11 : 12;
+    uint64_t extSize=2*(((spp*2+7)&~(uint64_t)7)+((extra.size()*2+7)&~(uint64_t)7));
+    uint64_t ifdSize, header, blockMeta, block, total;
+    for (;;) {
+        ifdSize=big ? 8+nTags*20+8 : 2+nTags*12+4;
+        header=big ? 16 : 8; blockMeta=(ifdSize+extSize+7)&~(uint64_t)7; block=blockMeta+pageBytes;
+        total=header+nf*block;
+        if (big || total<=((uint64_t)1<<32)) break;
+        big=true;   // the offsets of the whole layout do not fit in a classic TIFF
+    }
+
+    char path[4096];
+    if (mxGetString(prhs[1],path,sizeof(path))!=0) mexErrMsgTxt("Invalid path.\n");
+    int fd=::open(path,O_RDWR|O_CREAT|O_TRUNC,0644);
+    if (fd<0) mexErrMsgIdAndTxt("GlobalBioIm:tiffStack","Failed to open the file '%s'.\n",path);
+    if (ftruncate(fd,(off_t)total)!=0) { ::close(fd); mexErrMsgTxt("Could not allocate the file.\n"); }
+    void* m=mmap(NULL,total,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    if (m==MAP_FAILED) { ::close(fd); mexErrMsgTxt("Could not map the file.\n"); }
+    uint8_t* p=(uint8_t*)m;
+    // Header
+    p[0]='I'; p[1]='I';
+    uint64_t first=header;
+    if (big) { uint16_t v[3]={43,8,0}; memcpy(p+2,v,6); memcpy(p+8,&first,8); }
+    else { uint16_t v=42; uint32_t f32=(uint32_t)first; memcpy(p+2,&v,2); memcpy(p+4,&f32,4); }
+    const uint8_t* src=(const uint8_t*)mxGetData(data);
+    uint64_t nColor=spp-extra.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (long k=0;k<(long)nf;k++) {
+        uint64_t base=header+k*block;
+        uint8_t* b=p+base;
+        uint64_t ext=ifdSize, pix=base+blockMeta;
+        if (big) { uint64_t n=nTags; memcpy(b,&n,8); } else { uint16_t n=(uint16_t)nTags; memcpy(b,&n,2); }
+        uint8_t* e=b+(big ? 8 : 2);
+        uint64_t es=big ? 20 : 12;
+        int longType=big ? 16 : 4;
+        int t=0;
+        putEntry(e+es*t++,big,TAG_WIDTH,longType,{w},b,base,ext);
+        putEntry(e+es*t++,big,TAG_HEIGHT,longType,{h},b,base,ext);
+        putEntry(e+es*t++,big,TAG_BPS,3,std::vector<uint64_t>(spp,8*nb),b,base,ext);
+        putEntry(e+es*t++,big,TAG_COMPRESSION,3,{COMP_NONE},b,base,ext);
+        putEntry(e+es*t++,big,TAG_PHOTOMETRIC,3,{nColor>=3 ? 2u : 1u},b,base,ext);
+        putEntry(e+es*t++,big,TAG_STRIPOFFSETS,longType,{pix},b,base,ext);
+        putEntry(e+es*t++,big,TAG_SPP,3,{spp},b,base,ext);
+        putEntry(e+es*t++,big,TAG_ROWSPERSTRIP,longType,{h},b,base,ext);
+        putEntry(e+es*t++,big,TAG_STRIPBYTECOUNTS,longType,{pageBytes},b,base,ext);
+        putEntry(e+es*t++,big,TAG_PLANAR,3,{1},b,base,ext);
+        if (!extra.empty()) putEntry(e+es*t++,big,TAG_EXTRASAMPLES,3,extra,b,base,ext);
+        putEntry(e+es*t++,big,TAG_SAMPLEFORMAT,3,std::vector<uint64_t>(spp,format),b,base,ext);
+        uint64_t next=(k+1<(long)nf) ? base+block : 0;
+        if (big) memcpy(e+es*nTags,&next,8); else { uint32_t n32=(uint32_t)next; memcpy(e+es*nTags,&n32,4); }
+        // Pixels: column major [h w spp] to row major chunky
+        uint8_t* o=p+pix;
+        const uint8_t* in=src+k*pageBytes;
+        for (uint64_t r=0;r<h;r++)
+            for (uint64_t c=0;c<w;c++)
+                for (uint64_t s=0;s<spp;s++,o+=nb)
+                    memcpy(o,in+((s*w+c)*h+r)*nb,nb);
+    }
+    munmap(m,total);
+    ::close(fd);
+}
+
+// 'info' and 'read' commands on the mapped file; returns an error message
+// or NULL, the mapping being released when returning
+static const char* mapAndRun(const char* cmd, const char* path, int nrhs, const mxArray* prhs[], mxArray* plhs[]) {
+    MappedFile f;
+    if (!f.open(path)) return fail("Failed to open the file '%s'.\n",path);
+    Parser ps(f);
+    std::vector<Page> pages;
+    const char* err=ps.parse(pages);
+    if (err) return err;
+    if (pages.empty()) return fail("No image in the file.\n");
+
+    if (!strcmp(cmd,"info")) {
+        const Page& p0=pages[0];
+        bool uniform=true, supported=true, tiled=false;
+        for (const Page& pg : pages) {
+            uniform=uniform && sameLayout(pg,p0);
+            supported=supported && pageSupported(pg);
+            tiled=tiled || pg.tiled;
+        }
+        const char* fields[]={"width","height","spp","bps","format","compression","predictor","planar",
+                              "tiled","nframes","bigtiff","uniform","supported"};
+        plhs[0]=mxCreateStructMatrix(1,1,13,fields);
+        mxSetField(plhs[0],0,"width",mxCreateDoubleScalar((double)p0.width));
+        mxSetField(plhs[0],0,"height",mxCreateDoubleScalar((double)p0.height));
+        mxSetField(plhs[0],0,"spp",mxCreateDoubleScalar(p0.spp));
+        mxSetField(plhs[0],0,"bps",mxCreateDoubleScalar(p0.bps));
+        mxSetField(plhs[0],0,"format",mxCreateDoubleScalar(p0.format));
+        mxSetField(plhs[0],0,"compression",mxCreateDoubleScalar(p0.compression));
+        mxSetField(plhs[0],0,"predictor",mxCreateDoubleScalar(p0.predictor));
+        mxSetField(plhs[0],0,"planar",mxCreateDoubleScalar(p0.planar));
+        mxSetField(plhs[0],0,"tiled",mxCreateLogicalScalar(tiled));
+        mxSetField(plhs[0],0,"nframes",mxCreateDoubleScalar((double)pages.size()));
+        mxSetField(plhs[0],0,"bigtiff",mxCreateLogicalScalar(ps.big));
+        mxSetField(plhs[0],0,"uniform",mxCreateLogicalScalar(uniform));
+        mxSetField(plhs[0],0,"supported",mxCreateLogicalScalar(supported));
+    } else {
+        return readStack(nrhs,prhs,plhs,f,ps,pages);
+    }
+    return NULL;
+}
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+
+    if (nrhs<2 || !mxIsChar(prhs[0]) || !mxIsChar(prhs[1]))
+        mexErrMsgTxt("Usage: tiffStack(command,path,...).\n");
+    char cmd[8];
+    mxGetString(prhs[0],cmd,sizeof(cmd));
+    if (!strcmp(cmd,"write")) {
+        writeStack(nrhs,prhs);
+        return;
+    }
+    if (strcmp(cmd,"info") && strcmp(cmd,"read"))
+        mexErrMsgTxt("Unknown command.\n");
+
+    // Arguments of 'read' checked before the mapping
+    if (!strcmp(cmd,"read")) {
+        if (nrhs>2 && !mxIsEmpty(prhs[2]) && !mxIsDouble(prhs[2])) mexErrMsgTxt("frames should be a vector of double.\n");
+        for (int k=3;k<nrhs && k<5;k++)
+            if (!mxIsEmpty(prhs[k]) && (mxGetNumberOfElements(prhs[k])!=2 || !mxIsDouble(prhs[k])))
+                mexErrMsgIdAndTxt("GlobalBioIm:tiffStack","%s should be [first last].\n",k==3 ? "rows" : "cols");
+    }
+    char path[4096];
+    if (mxGetString(prhs[1],path,sizeof(path))!=0) mexErrMsgTxt("Invalid path.\n");
+    const char* err=mapAndRun(cmd,path,nrhs,prhs,plhs);
+    if (err) mexErrMsgIdAndTxt("GlobalBioIm:tiffStack","%s",err);
+}
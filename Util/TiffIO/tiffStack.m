@@ -0,0 +1,35 @@
+% function varargout=tiffStack(cmd,path,varargin)
+%
+%  Memory-mapped reader and writer of multi-page TIFF and BigTIFF stacks:
+%     info = tiffStack('info',path)             geometry and encoding of the
+%                                               pages (fields width, height,
+%                                               spp, bps, format, nframes,
+%                                               uniform, supported, ...)
+%     img = tiffStack('read',path,frames,rows,cols)
+%                                               pages frames (all if empty),
+%                                               rows [first last] and columns
+%                                               [first last] (all if empty),
+%                                               img of size [nrows ncols spp nframes]
+%     tiffStack('write',path,data,big,extra)    uncompressed stack from the
+%                                               [height width spp nframes]
+%                                               array data (BigTIFF if big),
+%                                               extra: ExtraSamples values
+%  The pages are decoded/encoded in parallel. Supported encodings: none,
+%  PackBits and LZW (with predictor), 8 to 64 bits integer or floating
+%  point samples, striped (not tiled) files. Mex implementation used by
+%  loadtiff and saveastiff.
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
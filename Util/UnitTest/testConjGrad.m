@@ -0,0 +1,76 @@
+rng(1);
+n = 301;
+B = randn(n);
+d = logspace(0, 1.5, n)';
+Amat = diag(d)*(B'*B/n + eye(n))*diag(d);   % symmetric definite positive, badly scaled
+Amat = (Amat + Amat')/2;
+A = LinOpMatrix(Amat);
+b = randn(n, 1);
+xref = Amat\b;
+wJ = 1./diag(Amat);   % Jacobi preconditioner
+precs = {[], wJ, LinOpDiag(A.sizein, wJ)};   % none, Jacobi (fused kernels), LinOp
+
+%% Fused kernels against the MATLAB operations (double and single)
+if exist('cgFused')==3
+    for cl = {'double', 'single'}
+        tol = 1e-12; if strcmp(cl{1}, 'single'), tol = 1e-5; end
+        x = cast(randn(1003, 1), cl{1}); r = cast(randn(1003, 1), cl{1});
+        p = cast(randn(1003, 1), cl{1}); q = cast(randn(1003, 1), cl{1});
+        w = cast(rand(1003, 1), cl{1});
+        dr = @(u, v) double(u)'*double(v);   % inner products accumulated in double
+        for wk = {[], w}
+            ww = wk{1}; if isempty(ww), ww = ones(1003, 1, cl{1}); end
+            dd = cgFused('dots', p, q, r, wk{1});
+            de = [dr(p, q) dr(p, r) dr(q, double(ww).*double(r)) dr(q, double(ww).*double(q))];
+            assert(isa(dd, 'double') && norm(dd - de) <= 1e-12*norm(de));
+            [x2, r2, p2, rho] = cgFused('update', x, r, p, q, 0.3, 0.7, wk{1});
+            assert(isa(x2, cl{1}) && isa(r2, cl{1}) && isa(p2, cl{1}));
+            assert(norm(x2 - (x + 0.3*p)) <= tol*norm(x));
+            assert(norm(r2 - (r - 0.3*q)) <= tol*norm(r));
+            assert(norm(p2 - (ww.*r2 + 0.7*p)) <= tol*norm(p));
+            assert(abs(rho - dr(r2, ww.*r2)) <= 1e-12*abs(rho));
+        end
+        [x2, r2] = cgFused('step', x, r, p, q, 0.3);
+        assert(norm(x2 - (x + 0.3*p)) <= tol*norm(x) && norm(r2 - (r - 0.3*q)) <= tol*norm(r));
+        [p2, rho] = cgFused('direction', w.*r, p, r, 2.5);
+        assert(abs(rho - dr(r, w.*r)) <= 1e-12*abs(rho));
+        assert(norm(p2 - (w.*r + rho/2.5*p)) <= tol*norm(p));
+    end
+end
+
+%% Iterates against the MATLAB preconditioned conjugate gradient
+for k = 1:length(precs)
+    if isempty(precs{k}), P = @(r) r;
+    elseif isnumeric(precs{k}), P = @(r) precs{k}.*r;
+    else, P = @(r) precs{k}*r;
+    end
+    x = zeros(n, 1); r = b; z = P(r); p = z; rho = r'*z;
+    for it = 1:20
+        q = Amat*p; alpha = rho/(p'*q);
+        x = x + alpha*p; r = r - alpha*q;
+        z = P(r); rhoNew = r'*z; p = z + rhoNew/rho*p; rho = rhoNew;
+    end
+    CG = OptiConjGrad(A, b); CG.precond = precs{k};
+    CG.verbose = false; CG.maxiter = 20;
+    CG.run(zeros(n, 1));
+    assert(norm(CG.xopt - x) <= 1e-8*norm(x));
+end
+
+%% Solution against A\b up to convergence (predicted then exact residual norm)
+for k = 1:length(precs)
+    CG = OptiConjGrad(A, b); CG.precond = precs{k};
+    CG.verbose = false; CG.maxiter = 1000;
+    CG.CvOp = TestCvgStepRelative(1e-15);
+    CG.run(zeros(n, 1));
+    assert(norm(CG.xopt - xref) <= 1e-9*norm(xref));
+end
+
+%% Single precision storage
+for k = 1:length(precs)
+    CG = OptiConjGrad(A, b); CG.precond = precs{k}; CG.storageClass = 'single';
+    CG.verbose = false; CG.maxiter = 500;
+    CG.CvOp = TestCvgStepRelative(1e-7);
+    CG.run(zeros(n, 1));
+    assert(isa(CG.xopt, 'single'));
+    assert(norm(double(CG.xopt) - xref) <= 5e-3*norm(xref));
+end
@@ -0,0 +1,63 @@
+isaNames = {'generic', 'sse4', 'avx2', 'avx512'};
+envOld = getenv('GLOBALBIOIM_CPU');
+
+%% Instruction set override (GLOBALBIOIM_CPU)
+if exist('cpuInfo')==3
+    [isa, best] = cpuInfo();
+    assert(any(strcmp(best, isaNames)));
+    if isempty(envOld)
+        assert(strcmp(isa, best));
+    end
+    ib = find(strcmp(best, isaNames));
+    for k = 1:ib
+        setenv('GLOBALBIOIM_CPU', isaNames{k});
+        assert(strcmp(cpuInfo(), isaNames{k}));
+    end
+    setenv('GLOBALBIOIM_CPU', 'avx512');   % can only lower the instruction set
+    assert(strcmp(cpuInfo(), best));
+    setenv('GLOBALBIOIM_CPU', envOld);
+end
+
+%% Variants of the kernels against the generic one
+if exist('cpuInfo')==3
+    [~, best] = cpuInfo();
+    ib = find(strcmp(best, isaNames));
+    X2 = randn(33, 17, 3); X3 = randn(9, 11, 4, 6);
+    x = rand(40, 30, 5); c = rand(40, 30, 5); He1 = 1 + rand(40, 30, 5);
+    xs = single(x); xc = x + 1i*randn(40, 30, 5);
+    codes = [5 1 2 3]; coefs = {rand(40, 30, 5), [], [], []};
+    out = cell(1, ib);
+    for k = 1:ib
+        setenv('GLOBALBIOIM_CPU', isaNames{k});
+        o = {};
+        if exist('svd2D_decomp')==3
+            [E, V] = svd2D_decomp(X2);
+            o = [o, {E, V, svd2D_recomp(E, V)}];
+        end
+        if exist('svd3D_decomp')==3
+            [E, V] = svd3D_decomp(X3);
+            o = [o, {E, V, svd3D_recomp(E, V)}];
+        end
+        if exist('richLucyUpdate')==3
+            [xn, nneg] = richLucyUpdate(x, c, He1, 0.01, 1e-6);
+            o = [o, {xn, nneg, double(richLucyUpdate(xs, single(c), single(2), single(0.01), single(1e-6)))}];
+        end
+        if exist('ewChain')==3
+            [y, d] = ewChain(x, codes, coefs);
+            [yc, dc] = ewChain(xc, [4 5 2], {[], 2i, []});
+            o = [o, {y, d, yc, dc}];
+        end
+        out{k} = o;
+    end
+    setenv('GLOBALBIOIM_CPU', envOld);
+    for k = 2:ib
+        for m = 1:numel(out{1})
+            a = out{1}{m}; b = out{k}{m};
+            assert(isequal(size(a), size(b)));
+            % Up to the rounding (fused multiply-add) and the tolerance of the
+            % iterative 3x3 eigen-decomposition
+            assert(norm(a(:) - b(:)) <= 1e-5*max(1, norm(a(:))), ...
+                'Output %d differs between the %s and %s variants', m, isaNames{1}, isaNames{k});
+        end
+    end
+end
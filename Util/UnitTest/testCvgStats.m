@@ -0,0 +1,20 @@
+%% Step statistics (single pass) against the direct expressions
+x = rand(64, 48); xold = x + 1e-3*randn(64, 48);
+s = TestCvg.computeStepStats(x, xold);
+d = x(:) - xold(:);
+assert(norm(s - [norm(d) norm(xold(:)) norm(x(:)) max(abs(d))]) < 1e-10);
+
+%% Complex and single
+xc = single(x + 1i*rand(64, 48)); xoldc = single(xold);
+s = TestCvg.computeStepStats(xc, xoldc);
+d = double(xc(:) - xoldc(:));
+assert(norm(s - [norm(d) norm(double(xoldc(:))) norm(double(xc(:))) max(abs(d))]) < 1e-3);
+
+%% Statistics shared within TestCvgCombine
+H = LinOpConv(fft2(rand(64)));
+y = H*rand(64);
+CG = OptiConjGrad(H'*H, H'*y);
+CG.maxiter = 200; CG.verbose = false;
+CG.CvOp = TestCvgCombine(TestCvgStepRelative(1e-6), TestCvgStepMaxAbs(1e-8));
+CG.run(zeros(64));
+assert(CG.niter < CG.maxiter);
@@ -21,4 +21,29 @@ H=LinOpConv(hHat);
 [normEst, v] = estimateNorm(H, 10000, 300, rand(H.sizein) + 1i * rand(H.sizein)); % very accurate, slow
 
 
-assert(abs(H.norm - normEst) < 1e-6); % this one is hard to make accurate
\ No newline at end of file
+assert(abs(H.norm - normEst) < 1e-6); % this one is hard to make accurate
+
+%% Block of vectors and size of the basis
+[im,psf,y]=GenerateData('Gaussian',20);
+H = LinOpConv(fft2(psf));
+normEst = estimateNorm(H, 999, 300, [], false, 3);
+assert(abs(H.norm - normEst) < 1e-12);
+normEst = estimateNorm(H, 999, 300, [], false, 1, 0, 4);
+assert(abs(H.norm - normEst) < 1e-12);
+
+%% Norm cache: estimated once and propagated to the Maps built from it
+G = LinOpHess([64 64]);
+assert(G.norm == -1);
+nrm = G.getNorm();
+assert(G.norm == nrm && abs(nrm - 1.01*estimateNorm(G, 999, 300)) < 1e-3*nrm);   % with the margin
+H = LinOpDiag(G.sizeout, 2) * G;
+assert(abs(H.getNorm() - 2*nrm) < 1e-3*nrm);
+A = G';
+assert(A.getNorm() == nrm);
+
+%% Bounds of nested Maps are not stored as norms
+G = LinOpHess([64 64]);
+H = LinOpDiag(G.sizeout, 2) * (LinOpDiag(G.sizeout, 3) * G + G);
+nrm = G.getNorm();   % known after the construction of H
+assert(abs(H.getNorm() - 8*nrm) < 1e-12*nrm);   % bound from the parts
+assert(H.norm == -1 && H.getNormBound() == H.getNorm());
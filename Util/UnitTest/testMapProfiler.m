@@ -0,0 +1,121 @@
+mapProfiler('off');
+mapProfiler('clear');
+H = LinOpConv(fft2(rand(64)));
+x = rand(64);
+
+%% Disabled by default: nothing is recorded
+H*x;
+rep = mapProfiler('report');
+assert(isempty(rep.classes) && isempty(rep.nodes));
+
+%% Calls, bytes and memoize hits per class
+mapProfiler('on');
+H.memoizeOpts.apply = true;
+for k = 1:3
+    H*x;
+end
+H.applyAdjoint(x);
+mapProfiler('off');
+rep = mapProfiler('report');
+e = rep.classes(strcmp({rep.classes.name}, 'LinOpConv.apply'));
+assert(e.calls==3 && e.memoHits==2);
+assert(e.bytesIn==3*64^2*8 && e.bytesOut==3*64^2*8);
+e = rep.classes(strcmp({rep.classes.name}, 'LinOpConv.applyAdjoint'));
+assert(e.calls==1 && e.memoHits==0);
+H.memoizeOpts.apply = false;
+
+%% Nodes of a composed operator
+mapProfiler('clear');
+mapProfiler('on');
+G = LinOpGrad([64 64]);
+L = G*H;
+y = L*x;
+mapProfiler('off');
+rep = mapProfiler('report');
+stacks = {rep.nodes.stack};
+root = rep.nodes(strcmp(stacks, 'LinOpComposition#1.apply'));
+conv = rep.nodes(strcmp(stacks, 'LinOpComposition#1.apply;LinOpConv#1.apply'));
+grad = rep.nodes(strcmp(stacks, 'LinOpComposition#1.apply;LinOpGrad#1.apply'));
+assert(numel(root)==1 && numel(conv)==1 && numel(grad)==1);
+assert(isequal(root.sizeIn, [64 64]) && isequal(root.sizeOut, size(y)));
+assert(root.time >= conv.time + grad.time);
+assert(abs(root.selfTime - (root.time - conv.time - grad.time)) < 1e-9);
+
+%% Instances of the same class are distinct nodes
+mapProfiler('clear');
+mapProfiler('on');
+H2 = LinOpConv(fft2(rand(64)));
+H2*(H*x);
+mapProfiler('off');
+rep = mapProfiler('report');
+assert(all(ismember({'LinOpConv#1.apply', 'LinOpConv#2.apply'}, {rep.nodes.stack})));
+e = rep.classes(strcmp({rep.classes.name}, 'LinOpConv.apply'));
+assert(e.calls==2);
+mapProfiler('on');
+H3 = copy(H);
+H3*x;
+H*x;
+mapProfiler('off');
+rep = mapProfiler('report');
+e = rep.nodes(strcmp({rep.nodes.stack}, 'LinOpConv#3.apply'));
+assert(numel(e)==1 && e.calls==1);
+e = rep.nodes(strcmp({rep.nodes.stack}, 'LinOpConv#1.apply'));
+assert(e.calls==2);
+
+%% An evaluation which throws an error is not recorded and leaves no frame
+mapProfiler('clear');
+mapProfiler('on');
+F = CostMixNorm21([64 64 2], 3);   % no gradient
+failed = false;
+try
+    F.applyGrad(rand(64, 64, 2));
+catch
+    failed = true;
+end
+H*x;
+mapProfiler('off');
+rep = mapProfiler('report');
+assert(failed);
+e = rep.nodes(strcmp({rep.nodes.stack}, 'LinOpConv#1.apply'));
+assert(numel(e)==1 && e.calls==1);
+e = rep.classes(strcmp({rep.classes.name}, 'CostMixNorm21.applyGrad'));
+assert(e.calls==0);
+assert(all(cellfun(@isempty, strfind({rep.nodes.stack}, ';'))));
+
+%% Costs and kernels (reported by the mex files, or directly)
+mapProfiler('clear');
+mapProfiler('on');
+F = CostL2([64 64], rand(64));
+F.applyGrad(x);
+F.applyProx(x, 0.5);
+tok = mapProfiler('enter', F, 'apply', x);
+mapProfiler('kernel', 'sumDims', 0.25);
+mapProfiler('exit', tok, 0);
+mapProfiler('off');
+rep = mapProfiler('report');
+names = {rep.classes.name};
+assert(all(ismember({'CostL2.applyGrad', 'CostL2.applyProx', 'sumDims'}, names)));
+k = rep.nodes(strcmp({rep.nodes.stack}, 'CostL2#1.apply;sumDims'));
+assert(k.calls==1 && k.time==0.25);
+e = rep.nodes(strcmp({rep.nodes.stack}, 'CostL2#1.apply'));
+assert(abs(e.selfTime - (e.time - 0.25)) < 1e-9);
+
+%% Folded stacks (flame graph)
+mapProfiler('clear');
+mapProfiler('on');
+F = CostL2([64 64], rand(64));
+F.applyGrad(x);
+tok = mapProfiler('enter', F, 'apply', x);
+mapProfiler('kernel', 'sumDims', 0.25);
+mapProfiler('exit', tok, 0);
+mapProfiler('off');
+rep = mapProfiler('report');
+lines = mapProfiler('folded');
+assert(numel(lines) == numel(rep.nodes));
+assert(all(~cellfun(@isempty, regexp(lines, '^\S+ \d+$', 'once'))));
+assert(any(strcmp(lines, 'CostL2#1.apply;sumDims 250000')));
+file = [tempname, '.folded'];
+mapProfiler('folded', file);
+assert(isequal(strsplit(strtrim(fileread(file)), newline)', lines));
+delete(file);
+mapProfiler('clear');
@@ -0,0 +1,40 @@
+%% Single entry (default budget): same behaviour as before
+H = LinOpConv(fft2(rand(64)));
+H.memoizeOpts.apply = true;
+x1 = rand(64); x2 = rand(64);
+y1 = H*x1;
+assert(isequal(H*x1, y1));
+y2 = H*x2;
+assert(isequal(H*x1, y1));          % x1 has been evicted
+st = H.getMemoizeStats();
+assert(st.apply.hits==1 && st.apply.misses==3 && st.apply.entries==1);
+
+%% Multiple LRU entries within the memory budget
+H.clearMemoize();
+H.memoizeBudget = 10*(2*64^2*8);    % room for ~10 (input,output) pairs
+y1 = H*x1; y2 = H*x2;
+assert(isequal(H*x1, y1) && isequal(H*x2, y2));
+st = H.getMemoizeStats();
+assert(st.apply.hits==2 && st.apply.misses==2 && st.apply.entries==2);
+
+%% A modified input (even in place) is not matched
+x1(1) = x1(1)+1;
+assert(max(abs(reshape(H*x1 - y1, [], 1))) > 0);
+
+%% Identical content in a different buffer is matched with memoizeCheck='hash'
+x3 = x2 + 0;
+H.clearMemoize();
+H*x2;
+H*x3;
+st = H.getMemoizeStats();
+assert(st.apply.hits==1);
+
+%% Multiple inputs (applyJacobianT)
+F = OpEWSqrt([64 64]);
+F.memoizeOpts.applyJacobianT = true;
+F.memoizeBudget = Inf;
+g1 = F.applyJacobianT(x1, x2);
+g2 = F.applyJacobianT(x2, x1);
+assert(isequal(F.applyJacobianT(x1, x2), g1) && isequal(F.applyJacobianT(x2, x1), g2));
+st = F.getMemoizeStats();
+assert(st.applyJacobianT.hits==2 && st.applyJacobianT.misses==2);
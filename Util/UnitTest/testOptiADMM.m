@@ -0,0 +1,51 @@
+rng(1);
+psf = fftshift(exp(-((-16:15)'.^2 + (-16:15).^2)/8));
+H = LinOpConv(fft2(psf/sum(psf(:))));
+x = zeros(32); x(8:20, 10:24) = 1;
+y = H*x + 0.01*randn(32);
+F0 = CostL2(H.sizeout, y)*H;
+G = LinOpGrad([32 32]);
+Fn = {1e-2*CostMixNorm21([32 32 2], 3), CostNonNeg([32 32])};
+Hn = {G, LinOpIdentity([32 32])};
+b = randn(32);
+% Solution of the linear step from the spectrum of the Fourier solver
+fourierSolve = @(ADMM, b) ifftn(fftn(b).*ADMM.fourierInv, 'symmetric');
+
+%% Detection of the Fourier-diagonal linear step
+ADMM = OptiADMM(F0, Fn, Hn, [1 1]);
+assert(~isempty(ADMM.fourierInv) && isempty(ADMM.CG));
+warnStruct = warning('off', 'all');
+Gm = LinOpGrad([32 32], [], 'mirror');
+ADMMm = OptiADMM(F0, Fn, {Gm, LinOpIdentity([32 32])}, [1 1]);   % not diagonalized by the DFT
+warning(warnStruct);
+assert(isempty(ADMMm.fourierInv) && ~isempty(ADMMm.CG));
+
+%% Solution of the linear step against A (rho_n given at construction)
+ADMM = OptiADMM(F0, Fn, Hn, [1 1]);
+xs = fourierSolve(ADMM, b);
+assert(norm(ADMM.A*xs - b, 'fro') <= 1e-10*norm(b, 'fro'));
+
+%% Solution of the linear step after a change of rho_n
+ADMM = OptiADMM(F0, Fn, Hn, [1 1]);
+ADMM.verbose = false; ADMM.maxiter = 1;
+A0 = ADMM.A;
+ADMM.rho_n = [3 0.5];
+ADMM.run(zeros(32));   % the denominator is updated at the first linear step
+assert(isequal(ADMM.fourierRho, [3 0.5]));
+xs = fourierSolve(ADMM, b);
+r = A0*xs + 2*(G'*(G*xs)) - 0.5*xs - b;   % A with the new rho_n
+assert(norm(r, 'fro') <= 1e-10*norm(b, 'fro'));
+
+%% Iterates against an ADMM with a conjugate gradient solver
+Aop = @(rho, v) H'*(H*v) + rho(1)*(G'*(G*v)) + rho(2)*v;   % linear step for rho_n
+solver = @(zn, rho, x0) reshape(pcg(@(v) reshape(Aop(rho, reshape(v, 32, 32)), [], 1), ...
+    reshape(H'*y + rho(1)*(G'*zn{1}) + rho(2)*zn{2}, [], 1), 1e-13, 1000, [], [], x0(:)), 32, 32);
+ADMM = OptiADMM(F0, Fn, Hn, [1 1]);
+ADMM.verbose = false; ADMM.maxiter = 5;
+ADMMc = OptiADMM(F0, Fn, Hn, [1 1], solver);
+ADMMc.verbose = false; ADMMc.maxiter = 5;
+ADMM.run(zeros(32)); ADMMc.run(zeros(32));
+assert(norm(ADMM.xopt - ADMMc.xopt, 'fro') <= 1e-8*norm(ADMMc.xopt, 'fro'));
+ADMM.rho_n = [3 0.5]; ADMMc.rho_n = [3 0.5];
+ADMM.run(); ADMMc.run();   % continued with the new rho_n
+assert(norm(ADMM.xopt - ADMMc.xopt, 'fro') <= 1e-8*norm(ADMMc.xopt, 'fro'));
@@ -0,0 +1,52 @@
+rng(1);
+K = 3;
+psf = fftshift(exp(-((-16:15)'.^2 + (-16:15).^2)/8));
+psf = psf/sum(psf(:));
+x = zeros(32, 32, K);
+x(8:20, 10:24, 1) = 1; x(4:28, 14:18, 2) = 2; x(16, 16, 3) = 10;
+H = LinOpConv(repmat(fft2(psf), [1 1 K]), true, [1 2]);
+y = H*x + 0.01*randn(32, 32, K);
+FBS = OptiFBS(CostL2(H.sizeout, y)*H, CostNonNeg(H.sizein));
+FBS.fista = true; FBS.gam = 1; FBS.verbose = false; FBS.maxiter = 400;
+FBS.CvOp = TestCvgStepRelative(1e-4);
+FBS.batchDim = 3;
+% Independent solves of the K problems
+xk = cell(1, K); nit = zeros(1, K);
+for k = 1:K
+    Hk = LinOpConv(fft2(psf), true);
+    FBSk = OptiFBS(CostL2(Hk.sizeout, y(:, :, k))*Hk, CostNonNeg(Hk.sizein));
+    FBSk.fista = true; FBSk.gam = 1; FBSk.verbose = false; FBSk.maxiter = 400;
+    FBSk.CvOp = TestCvgStepRelative(1e-4);
+    FBSk.run(zeros(32));
+    assert(FBSk.niter < FBSk.maxiter);
+    xk{k} = FBSk.xopt; nit(k) = FBSk.niter;
+end
+
+%% Batched FISTA against the independent solves
+FBS.run(zeros(32, 32, K));
+assert(~any(FBS.batchActive));
+assert(FBS.niter == max(nit));
+for k = 1:K
+    assert(norm(FBS.xopt(:, :, k) - xk{k}, 'fro') <= 1e-8*norm(xk{k}, 'fro'));
+end
+
+%% Retired problems stay frozen when the run stops by maxiter
+FBS.maxiter = max(nit) - 1;
+FBS.run(zeros(32, 32, K));
+assert(isequal(~FBS.batchActive, nit <= FBS.maxiter));
+for k = find(nit <= FBS.maxiter)
+    assert(norm(FBS.xopt(:, :, k) - xk{k}, 'fro') <= 1e-8*norm(xk{k}, 'fro'));
+end
+
+%% Algorithms with global steps refuse the batched mode
+CG = OptiConjGrad(H'*H, H'*y);
+CG.verbose = false; CG.batchDim = 3;
+failed = false;
+try
+    CG.run(zeros(32, 32, K));
+catch
+    failed = true;
+end
+assert(failed);
+FBS.updateGam = 'backtracking';
+assert(~FBS.batchSupported());
@@ -0,0 +1,137 @@
+rng(1);
+psf = fftshift(exp(-((-16:15)'.^2 + (-16:15).^2)/8));
+H = LinOpConv(fft2(psf/sum(psf(:))));
+x = zeros(32); x(8:20, 10:24) = 1;
+y = H*x + 0.01*randn(32);
+F0 = CostL2(H.sizeout, y)*H;
+Fn = {1e-2*CostMixNorm21([32 32 2], 3)};
+Hn = {LinOpGrad([32 32])};
+file = tempname;
+% Uninterrupted run
+A = OptiPrimalDualCondat(F0, CostNonNeg(H.sizein), Fn, Hn);
+A.tau = 1; A.verbose = false; A.maxiter = 60;
+A.CvOp = TestCvgStepRelative(1e-14);
+A.run(zeros(32));
+
+%% Resumed run against the uninterrupted one
+B = OptiPrimalDualCondat(F0, CostNonNeg(H.sizein), Fn, Hn);
+B.tau = 1; B.verbose = false; B.maxiter = 45;
+B.CvOp = TestCvgStepRelative(1e-14);
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiPrimalDualCondat(F0, CostNonNeg(H.sizein), Fn, Hn);   % fresh object
+C.tau = 1; C.verbose = false; C.maxiter = 60;
+C.CvOp = TestCvgStepRelative(1e-14);
+C.checkpointInterval = 10;
+C.resume(file);
+assert(C.niter == 40);
+C.run();
+assert(C.niter == A.niter);
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+% The checkpoints written after the resume continue the count
+D = OptiPrimalDualCondat(F0, CostNonNeg(H.sizein), Fn, Hn);
+D.tau = 1;
+D.resume(file);
+assert(D.niter == 60);
+assert(norm(D.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% Conjugate gradient (residual, direction and Jacobi preconditioner)
+lam = 0.1;
+AtA = H'*H + lam*LinOpIdentity([32 32]);
+precond = ones(32)/(sum(psf(:).^2)/sum(psf(:))^2 + lam);
+A = OptiConjGrad(AtA, H'*y); A.precond = precond;
+A.verbose = false; A.maxiter = 30;
+A.run(zeros(32));
+B = OptiConjGrad(AtA, H'*y); B.precond = precond;
+B.verbose = false; B.maxiter = 25;
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiConjGrad(AtA, H'*y); C.precond = precond;
+C.verbose = false; C.maxiter = 30;
+C.resume(file);
+assert(C.niter == 20);
+C.run();
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% Accelerated Chambolle-Pock (tau, sig and theta updated at each iteration)
+A = OptiChambPock(Fn{1}, Hn{1}, F0); A.gam = 0.5;
+A.verbose = false; A.maxiter = 30;
+A.run(zeros(32));
+B = OptiChambPock(Fn{1}, Hn{1}, F0); B.gam = 0.5;
+B.verbose = false; B.maxiter = 25;
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiChambPock(Fn{1}, Hn{1}, F0); C.gam = 0.5;
+C.verbose = false; C.maxiter = 30;
+C.resume(file);
+assert(C.niter == 20);
+C.run();
+assert(C.tau == A.tau && C.sig == A.sig);
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% FISTA with backtracking (y, tk and the step gam)
+A = OptiFBS(F0, CostNonNeg(H.sizein)); A.fista = true;
+A.updateGam = 'backtracking'; A.gam = 10;
+A.verbose = false; A.maxiter = 30;
+A.run(zeros(32));
+B = OptiFBS(F0, CostNonNeg(H.sizein)); B.fista = true;
+B.updateGam = 'backtracking'; B.gam = 10;
+B.verbose = false; B.maxiter = 25;
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiFBS(F0, CostNonNeg(H.sizein)); C.fista = true;
+C.updateGam = 'backtracking'; C.gam = 10;
+C.verbose = false; C.maxiter = 30;
+C.resume(file);
+assert(C.niter == 20);
+C.run();
+assert(C.gam == A.gam);
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% Nesterov accelerated gradient descent (y)
+A = OptiGradDsct(F0); A.nagd = true;
+A.verbose = false; A.maxiter = 30;
+A.run(zeros(32));
+B = OptiGradDsct(F0); B.nagd = true;
+B.verbose = false; B.maxiter = 25;
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiGradDsct(F0); C.nagd = true;
+C.verbose = false; C.maxiter = 30;
+C.resume(file);
+assert(C.niter == 20);
+C.run();
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% Douglas-Rachford (y)
+A = OptiDouglasRachford(F0, CostNonNeg(H.sizein), [], 10, 1.5);
+A.verbose = false; A.maxiter = 30;
+A.run(zeros(32));
+B = OptiDouglasRachford(F0, CostNonNeg(H.sizein), [], 10, 1.5);
+B.verbose = false; B.maxiter = 25;
+B.checkpointFile = file; B.checkpointInterval = 10;
+B.run(zeros(32));
+C = OptiDouglasRachford(F0, CostNonNeg(H.sizein), [], 10, 1.5);
+C.verbose = false; C.maxiter = 30;
+C.resume(file);
+assert(C.niter == 20);
+C.run();
+assert(norm(C.xopt - A.xopt, 'fro') <= 1e-12*norm(A.xopt, 'fro'));
+delete([file, '_*']);
+
+%% Algorithms which do not save their state refuse the checkpoints
+FGP = OptiFGP(CostL2([32 32], y), CostTV([32 32]));
+FGP.verbose = false; FGP.maxiter = 5;
+FGP.checkpointFile = file; FGP.checkpointInterval = 2;
+failed = false;
+try
+    FGP.run(y);
+catch
+    failed = true;
+end
+assert(failed);
@@ -0,0 +1,55 @@
+rng(1);
+psf = fftshift(exp(-((-16:15)'.^2 + (-16:15).^2)/8));
+H = LinOpConv(fft2(psf/sum(psf(:))));
+x = zeros(32); x(8:20, 10:24) = 1; x(24:28, 4:30) = 0.5;
+y = H*x + 0.01*randn(32);
+mu = 1e-3;
+C = CostL2(H.sizeout, y)*H + mu*CostL2(H.sizein);
+% Projected gradient of C at u for the bounds [lo,up]
+pgrad = @(u, lo, up) C.applyGrad(u).*~((u <= lo & C.applyGrad(u) > 0) | (u >= up & C.applyGrad(u) < 0));
+
+%% Native engine without bounds against the closed-form solution
+if exist('vmlmbEngine')==3
+    mtf = fft2(psf/sum(psf(:)));
+    xsol = real(ifft2(conj(mtf).*fft2(y)./(abs(mtf).^2 + mu)));
+    for hc = {'double', 'single'}
+        V = OptiVMLMB(C, [], []);
+        V.impl = 'native'; V.historyClass = hc{1};
+        V.verbose = false; V.maxiter = 500;
+        V.run(zeros(32));
+        assert(V.niter < V.maxiter);
+        assert(norm(V.xopt - xsol, 'fro') <= 1e-4*norm(xsol, 'fro'));
+    end
+end
+
+%% Native engine with bounds: feasibility and optimality
+if exist('vmlmbEngine')==3
+    for hc = {'double', 'single'}
+        x0 = 2*rand(32) - 0.5;   % infeasible x0, not modified
+        x0c = x0;
+        V = OptiVMLMB(C, 0, 0.8);
+        V.impl = 'native'; V.historyClass = hc{1};
+        V.verbose = false; V.maxiter = 500;
+        V.run(x0);
+        assert(isequal(x0, x0c));
+        assert(V.niter < V.maxiter);
+        assert(all(V.xopt(:) >= 0 & V.xopt(:) <= 0.8));
+        assert(any(V.xopt(:) == 0) && any(V.xopt(:) == 0.8));   % active bounds
+        assert(norm(pgrad(V.xopt, 0, 0.8), 'fro') <= 1e-4*norm(C.applyGrad(min(max(x0, 0), 0.8)), 'fro'));
+    end
+end
+
+%% Native engine against the Matlab implementation
+if exist('vmlmbEngine')==3 && exist('optm_new_line_search.m')==2
+    for bnd = {{[], []}, {zeros(32), 0.8*ones(32)}}
+        Vm = OptiVMLMB(C, bnd{1}{:});
+        Vm.verbose = false; Vm.maxiter = 500;
+        Vm.run(zeros(32));
+        Vn = OptiVMLMB(C, bnd{1}{:});
+        Vn.impl = 'native';
+        Vn.verbose = false; Vn.maxiter = 500;
+        Vn.run(zeros(32));
+        assert(abs(C*Vn.xopt - C*Vm.xopt) <= 1e-6*abs(C*Vm.xopt));
+        assert(norm(Vn.xopt - Vm.xopt, 'fro') <= 1e-3*norm(Vm.xopt, 'fro'));
+    end
+end
@@ -0,0 +1,46 @@
+rng(1);
+epsl = 1e-6;
+% MATLAB multiplicative update (with TV when lamb>0), as in OptiRichLucy
+rlUpdate = @(x, c, He1, lamb, gradReg) x./(He1 + lamb*gradReg).*c;
+tvGrad = @(G, x) G.applyAdjoint(G*x./repmat(sqrt(sum((G*x).^2, ndims(x)+1) + epsl), [ones(1, ndims(x)) ndims(x)]));
+
+%% Fused update against the MATLAB one (2D and 3D, with and without TV)
+if exist('richLucyUpdate')==3
+    for sz = {[40 33], [20 17 9]}
+        G = LinOpGrad(sz{1});
+        x = 0.5 + rand(sz{1}); c = 0.5 + rand(sz{1}); He1 = 1 + rand(sz{1});
+        gradReg = tvGrad(G, x);
+        for lamb = [0 1e-2 5]   % 5: negative elements
+            xe = rlUpdate(x, c, He1, lamb, gradReg);
+            [xn, nneg] = richLucyUpdate(x, c, He1, lamb, epsl);
+            assert(norm(xn(:) - xe(:)) <= 1e-12*norm(xe(:)));
+            assert(nneg == nnz(xe < 0));
+            if lamb < 1   % denominators away from 0
+                [xs, nneg] = richLucyUpdate(single(x), single(c), single(He1), lamb, epsl);
+                assert(isa(xs, 'single') && norm(double(xs(:)) - xe(:)) <= 1e-5*norm(xe(:)));
+                assert(nneg == 0);
+            end
+        end
+    end
+end
+
+%% Iterations of OptiRichLucy against the MATLAB ones (with and without TV)
+psf = fftshift(exp(-((-16:15)'.^2 + (-16:15).^2)/8));
+H = LinOpConv(fft2(psf/sum(psf(:))));
+x = zeros(32); x(8:20, 10:24) = 100; x(24:28, 4:30) = 50;
+y = max(H*x + 10 + 2*randn(32), 0);
+F = CostKullLeib(H.sizeout, y, 1e-3)*H;
+G = LinOpGrad([32 32]);
+for lamb = [0 1e-2]
+    RL = OptiRichLucy(F, lamb > 0, lamb);
+    RL.verbose = false; RL.maxiter = 10;
+    RL.run(ones(32));
+    xr = ones(32);
+    He1 = max(H.applyAdjoint(ones(32)), 1e-3);
+    for it = 1:10
+        c = H.applyAdjoint(y./(H*xr + 1e-3));
+        if lamb > 0, gradReg = tvGrad(G, xr); else, gradReg = 0; end
+        xr = rlUpdate(xr, c, He1, lamb, gradReg);
+    end
+    assert(norm(RL.xopt - xr, 'fro') <= 1e-10*norm(xr, 'fro'));
+end
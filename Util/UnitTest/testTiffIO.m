@@ -0,0 +1,46 @@
+%% Round trip of a grayscale stack (native writer/reader when tiffStack is compiled)
+fname = [tempname, '.tif'];
+x = single(rand(37, 29, 11));
+saveastiff(x, fname);
+y = loadtiff(fname);
+assert(isequal(size(y), size(x)) && isequal(y, x));
+
+%% Frame range and sub-volume
+y = loadtiff(fname, 4:7, [5 20], [3 29]);
+assert(isequal(y, x(5:20, 3:29, 4:7)));
+
+%% Complex and color stacks, integer classes
+z = single(rand(16, 12, 3) + 1i*rand(16, 12, 3));
+saveastiff(z, fname);
+assert(isequal(loadtiff(fname), z));
+c = uint16(65535*rand(16, 12, 3, 5));
+opts.color = true;
+saveastiff(c, fname, opts);
+assert(isequal(loadtiff(fname), c));
+assert(isequal(loadtiff(fname, 2, [3 9]), c(3:9, :, :, 2)));
+
+%% File information and BigTIFF
+if exist('tiffStack')==3
+    opts = struct('big', true);
+    saveastiff(uint8(255*rand(8, 8, 4)), fname, opts);
+    info = tiffStack('info', fname);
+    assert(info.bigtiff && info.nframes==4 && info.uniform && info.supported);
+end
+delete(fname);
+
+%% Pages of different sizes: one cell per size, no frame or sub-volume selection
+fname = [tempname, '.tif'];
+a = uint8(255*rand(8, 8, 2)); b = uint8(255*rand(6, 10));
+saveastiff(a, fname);
+opts = struct('append', true);
+saveastiff(b, fname, opts);
+y = loadtiff(fname);
+assert(iscell(y) && isequal(y{1}, a) && isequal(y{2}, b));
+failed = false;
+try
+    loadtiff(fname, 1);
+catch
+    failed = true;
+end
+assert(failed);
+delete(fname);
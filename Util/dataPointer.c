@@ -0,0 +1,28 @@
+/***************************************************************************
+  p = dataPointer(x)
+
+  Returns, as a uint64, the address of the data buffer of the full real
+  numeric array x (0 for empty, sparse, complex or non-numeric inputs).
+  Used by the memoize cache of Map to match inputs by buffer identity.
+
+  Compilation:
+     mex dataPointer.c   (or mexCheckNCompile('dataPointer'))
+
+  Copyright (C) 2026 GlobalBioIm developers
+
+****************************************************************************/
+#include "mex.h"
+#include <stdint.h>
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    uint64_t *p;
+    if (nrhs!=1)
+        mexErrMsgTxt("Usage: p = dataPointer(x).\n");
+    plhs[0]=mxCreateNumericMatrix(1,1,mxUINT64_CLASS,mxREAL);
+    p=(uint64_t*)mxGetData(plhs[0]);
+    if (mxIsNumeric(prhs[0]) && !mxIsSparse(prhs[0]) && !mxIsComplex(prhs[0]) && mxGetNumberOfElements(prhs[0])>0)
+        *p=(uint64_t)(uintptr_t)mxGetData(prhs[0]);
+    else
+        *p=0;
+}
@@ -0,0 +1,21 @@
+% function p=dataPointer(x)
+%
+%  Returns, as a uint64, the address of the data buffer of the full real
+%  numeric array x (0 for empty, sparse, complex or non-numeric inputs).
+%  Mex implementation used by the memoize cache of Map to match inputs by
+%  buffer identity. Compile it with mexCheckNCompile('dataPointer').
+%  
+%  Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.%
@@ -0,0 +1,305 @@
+function xhat = deconvTiled(y, psf, solver, tileSize, opts)
+% Deconvolves a volume which is too large for a single problem (or for
+% the memory) block by block: the volume is partitioned into tiles, each
+% tile extended by a halo is deconvolved independently, and the results
+% are blended across the seams.
+%
+% Usage: xhat = deconvTiled(y, psf, solver, tileSize, opts)
+%
+% y - data, either an array or the path of a (multi-page) tiff file of
+% size [height width frames]. In the latter case, the blocks are read from
+% the file by the workers with loadtiff (only the frames, rows and columns
+% of the block, see tiffStack).
+%
+% psf - centered PSF with a compact support (center at floor(size(psf)/2)+1).
+%
+% solver - function handle @(H,yb) called for each block with the
+% convolution H (:class:`LinOpConv` of the PSF on the grid of the block)
+% and the data yb of the block. It returns either an :class:`Opti`, which
+% is then run from yb, or directly the deconvolved block. For example,
+%     function opt = rlSolver(H, y)
+%        opt = OptiRichLucy(CostKullLeib(H.sizeout, y, 0)*H);
+%        opt.maxiter = 100; opt.verbose = false;
+%     end
+%
+% tileSize - size of the tiles (scalar or one value per dimension).
+% Default: 128.
+%
+% opts - structure with the optional fields
+%   - halo: width of the margin added on each side of the tiles (scalar
+%     or one value per dimension). The circular boundary artifacts of the
+%     block problems are confined in the halo. Default: size(psf).
+%   - numWorkers: maximum number of blocks solved in parallel (parfeval on
+%     the current parallel pool). Default: 0 (sequential).
+%   - output: path of a tiff file receiving the result (3D volumes only).
+%     The frames are written as soon as all the blocks covering them are
+%     solved, such that only a slab of the volume is kept in memory, and
+%     xhat is empty.
+%
+% The weights of neighbouring blocks ramp linearly over the central part
+% of their overlap (width min(halo,tileSize)) and sum to one. The blocks
+% are submitted in the order of the last dimension, with at most twice
+% numWorkers blocks in flight: a worker starts a new block as soon as it
+% has finished one (no synchronization between batches). The weighted
+% blocks are accumulated in the class of the data (single for integer
+% data) by cells of the tile grid in the first dimensions, each cell
+% holding only the frames which are not complete: the frames of a cell
+% are released (to xhat, or to the frames waiting to be written) as soon
+% as all the blocks covering them are solved.
+%
+% See also :class:`LinOpConvTiled`, loadtiff, saveastiff
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+if nargin < 4 || isempty(tileSize), tileSize = 128; end
+if nargin < 5, opts = struct(); end
+if ~isfield(opts, 'halo'), opts.halo = size(psf); end
+if ~isfield(opts, 'numWorkers'), opts.numWorkers = 0; end
+if ~isfield(opts, 'output'), opts.output = ''; end
+
+%% Size of the data
+fromFile = ischar(y);
+if fromFile
+    if exist('tiffStack')==3
+        info = tiffStack('info', y);
+        sz = [info.height info.width info.nframes];
+    else
+        info = imfinfo(y);
+        sz = [info(1).Height info(1).Width numel(info)];
+    end
+    if sz(3) == 1, sz = sz(1:2); end
+else
+    sz = size(y);
+end
+nd = length(sz);
+toFile = ~isempty(opts.output);
+assert(~toFile || nd == 3, 'The output can only be written to a file for 3D volumes');
+
+%% Tiles, blocks and ramps
+T = min(tileSize.*ones(1, nd), sz);
+halo = opts.halo;
+if isscalar(halo), halo = halo*ones(1, nd); end
+halo(end+1:nd) = 1;
+halo = min(halo(1:nd), sz);
+ramp = min(halo, T);
+tileStart = cell(1, nd);
+for d = 1:nd
+    tileStart{d} = 1:T(d):sz(d);
+end
+nTiles = cellfun(@numel, tileStart);
+nb = prod(nTiles);
+
+%% Accumulation cells (tile grid of the first dimensions)
+if fromFile
+    cl = 'single';
+    if exist('tiffStack')==3 && info.format == 3 && info.bps == 64, cl = 'double'; end
+elseif isfloat(y)
+    cl = class(y);
+else
+    cl = 'single';
+end
+nc = prod(nTiles(1:nd-1));
+cellRg = cell(nc, 1);          % index ranges of the cells
+needed = zeros(nc, 1);         % number of blocks of a slab covering each cell
+for i = 1:nc
+    subc = cell(1, nd-1);
+    [subc{:}] = ind2sub([nTiles(1:nd-1) 1], i);
+    needed(i) = 1;
+    for d = 1:nd-1
+        st = tileStart{d}(subc{d});
+        cellRg{i}{d} = st:min(sz(d), st + T(d) - 1);
+        bs = max(1, tileStart{d} - halo(d)); be = min(sz(d), tileStart{d} + T(d) - 1 + halo(d));
+        needed(i) = needed(i) * sum(bs <= cellRg{i}{d}(end) & be >= cellRg{i}{d}(1));
+    end
+end
+acc = cell(nc, 1);             % accumulated frames [zlo(c), zlo(c)+size(acc{c},nd)-1] of the cells
+for i = 1:nc
+    acc{i} = zeros([cellfun(@numel, cellRg{i}) 0], cl);
+end
+zlo = ones(nc, 1);
+nDone = zeros(nc, nTiles(nd)); % number of solved blocks per cell and slab of tiles (last dimension)
+kFlush = ones(nc, 1);          % first slab of tiles whose frames are not released, per cell
+
+%% Solving the blocks
+xhat = [];
+if toFile
+    pend = zeros([sz(1:nd-1) 0], 'single');   % released frames [zOut, ...] waiting to be written
+    zOut = 1;
+else
+    xhat = zeros(sz, cl);
+end
+if opts.numWorkers > 0
+    pool = gcp();
+    nInFlight = 2*min(opts.numWorkers, pool.NumWorkers);
+    futures = parallel.FevalFuture.empty;
+    tags = [];
+    next = 1;
+    while next <= nb || ~isempty(futures)
+        while next <= nb && numel(futures) < nInFlight
+            [src, rg] = blockSource(next);
+            futures(end+1) = parfeval(pool, @solveBlock, 1, src, rg, psf, solver); %#ok<AGROW>
+            tags(end+1) = next; %#ok<AGROW>
+            next = next + 1;
+        end
+        [i, xb] = fetchNext(futures);
+        accumulate(tags(i), xb);
+        futures(i) = []; tags(i) = [];
+    end
+else
+    for b = 1:nb
+        [src, rg] = blockSource(b);
+        accumulate(b, solveBlock(src, rg, psf, solver));
+    end
+end
+
+    function [src, rg] = blockSource(b)
+        % Data (or path of the file) and ranges of the block b
+        [~, rg] = blockRanges(b);
+        if fromFile
+            src = y;
+        else
+            src = y(rg{:});
+        end
+    end
+
+    function [sub, rg] = blockRanges(b)
+        % Tile subscripts and index ranges of the block b (tile and halo)
+        sub = cell(1, nd);
+        [sub{:}] = ind2sub([nTiles 1], b);
+        rg = cell(1, nd);
+        for dd = 1:nd
+            s = tileStart{dd}(sub{dd});
+            rg{dd} = max(1, s - halo(dd)):min(sz(dd), s + T(dd) - 1 + halo(dd));
+        end
+    end
+
+    function accumulate(b, xb)
+        % Adds the weighted block b to the accumulated frames of the
+        % cells it covers and releases the completed ones
+        [sub, rgb] = blockRanges(b);
+        w = 1;
+        for dd = 1:nd
+            wd = ones(numel(rgb{dd}), 1);
+            if sub{dd} > 1          % ramp across the seam before the tile
+                wd = wd .* seam(rgb{dd}', tileStart{dd}(sub{dd}), ramp(dd));
+            end
+            if sub{dd} < nTiles(dd) % ramp across the seam after the tile
+                wd = wd .* (1 - seam(rgb{dd}', tileStart{dd}(sub{dd}+1), ramp(dd)));
+            end
+            shp = ones(1, max(nd, 2)); shp(dd) = numel(wd);
+            w = bsxfun(@times, w, reshape(wd, shp));
+        end
+        xb = w.*xb;
+        % Cells covered by the block
+        cr = cell(1, nd-1);
+        for dd = 1:nd-1
+            cr{dd} = find(tileStart{dd} <= rgb{dd}(end) & tileStart{dd} + T(dd) - 1 >= rgb{dd}(1));
+        end
+        cc = cell(1, nd-1);
+        [cc{:}] = ndgrid(cr{:});
+        for c = reshape(sub2ind([nTiles(1:nd-1) 1], cc{:}), 1, [])
+            % Part of the block in the cell c
+            sel = cell(1, nd); rgAcc = cell(1, nd);
+            for dd = 1:nd-1
+                [~, sel{dd}, rgAcc{dd}] = intersect(rgb{dd}, cellRg{c}{dd});
+            end
+            sel{nd} = ':';
+            zNeeded = rgb{nd}(end) - zlo(c) + 1;
+            if size(acc{c}, nd) < zNeeded
+                szAcc = cellfun(@numel, cellRg{c}); szAcc(nd) = zNeeded - size(acc{c}, nd);
+                acc{c} = cat(nd, acc{c}, zeros(szAcc, cl));
+            end
+            rgAcc{nd} = rgb{nd} - zlo(c) + 1;
+            acc{c}(rgAcc{:}) = acc{c}(rgAcc{:}) + cast(xb(sel{:}), cl);
+            nDone(c, sub{nd}) = nDone(c, sub{nd}) + 1;
+            release(c);
+        end
+    end
+
+    function release(c)
+        % Releases the frames of the cell c which are not covered by
+        % unsolved blocks
+        while kFlush(c) <= nTiles(nd) && nDone(c, kFlush(c)) == needed(c)
+            if kFlush(c) < nTiles(nd)
+                zEnd = tileStart{nd}(kFlush(c)+1) - halo(nd) - 1;
+            else
+                zEnd = sz(nd);
+            end
+            if zEnd >= zlo(c)
+                idx = repmat({':'}, 1, nd);
+                idx{nd} = 1:(zEnd - zlo(c) + 1);
+                out = cellRg{c}; out{nd} = zlo(c):zEnd;
+                if toFile
+                    out{nd} = out{nd} - zOut + 1;
+                    if size(pend, nd) < out{nd}(end)
+                        szp = sz; szp(nd) = out{nd}(end) - size(pend, nd);
+                        pend = cat(nd, pend, zeros(szp, 'single'));
+                    end
+                    pend(out{:}) = acc{c}(idx{:});
+                else
+                    xhat(out{:}) = acc{c}(idx{:});
+                end
+                acc{c}(idx{:}) = [];
+                zlo(c) = zEnd + 1;
+            end
+            kFlush(c) = kFlush(c) + 1;
+        end
+        if toFile && min(zlo) > zOut
+            % Frames released by all the cells
+            idx = repmat({':'}, 1, nd);
+            idx{nd} = 1:(min(zlo) - zOut);
+            res = saveastiff(pend(idx{:}), opts.output, struct('append', zOut > 1, 'overwrite', true));
+            assert(res == 0, ['Failed to write the file ''', opts.output, '''']);
+            pend(idx{:}) = [];
+            zOut = min(zlo);
+        end
+    end
+end
+
+function w = seam(i, s, r)
+% Weight of the block after the seam between the samples s-1 and s, for
+% the samples i (linear ramp of width r centered on the seam)
+if r == 0
+    w = double(i >= s);
+else
+    w = min(max((i - s + 0.5)/r + 0.5, 0), 1);
+end
+end
+
+function xb = solveBlock(src, rg, psf, solver)
+% Deconvolution of one block (src: data of the block or path of the file)
+if ischar(src)
+    frames = 1;
+    if length(rg) > 2, frames = rg{3}; end
+    yb = double(loadtiff(src, frames, rg{1}([1 end]), rg{2}([1 end])));
+else
+    yb = double(src);
+end
+bsz = size(yb); bsz(end+1:length(rg)) = 1;
+psz = size(psf); psz(end+1:length(bsz)) = 1;
+assert(all(psz <= bsz), 'The blocks must be larger than the PSF (increase tileSize)');
+k = zeros(bsz);
+idx = arrayfun(@(n) 1:n, psz, 'UniformOutput', false);
+k(idx{:}) = psf;
+H = LinOpConv(fftn(circshift(k, -floor(psz/2))));
+opt = solver(H, yb);
+if isa(opt, 'Opti')
+    opt.run(yb);
+    xb = opt.xopt;
+else
+    xb = opt;
+end
+end
@@ -1,10 +1,15 @@
-function [normA, v] = estimateNorm(A, maxNumApply, targetSNR, v0, verboseFlag)
-% Estimates the operator norm of a map, A, using the power iteration
-% method, which involves computing (A'*A)*...*(A'*A)*v.
+function [normA, v] = estimateNorm(A, maxNumApply, targetSNR, v0, verboseFlag, blockSize, numWorkers, maxBasis)
+% Estimates the operator norm of a map, A, using a randomized block Lanczos
+% method on A'*A (with full reorthogonalization and thick restarts), which
+% converges much faster than the power iteration (A'*A)*...*(A'*A)*v.
 %
 % Simple usage: A.norm = estimateNorm(A)
 % 
-% Complicated usage: [Anorm, v] = estimateNorm(A, maxNumApply, targetSNR, v0, verboseFlag)
+% Complicated usage: [Anorm, v] = estimateNorm(A, maxNumApply, targetSNR, v0, verboseFlag, blockSize, numWorkers, maxBasis)
+%
+% See also the method getNorm of Map, which calls this function only when
+% the norm is not known (nor bounded from the norms of the parts of A) and
+% caches the result increased by 1%.
 %
 % Details:
 % Anorm - lower bound on the operator norm of A.
@@ -12,21 +17,36 @@ function [normA, v] = estimateNorm(A, maxNumApply, targetSNR, v0, verboseFlag)
 % v - the unit vector that maximizes \| Av \|. Should be close to the first
 % eigenvector of A.
 %
-% maxNumApply - maximum number of times to apply A. Higher is more
+% maxNumApply - maximum number of times to apply A'*A. Higher is more
 % accurate, but takes longer. Default: 200.
 %
-% targetSNR - stopping criterion. If snr(A*v, A*v - lambda*v) > targetSNR,
-% we assume we have found the largest eigenvector and stop iterating.
-% Higher is more accurate, but takes longer. Default 50.
+% targetSNR - stopping criterion. If snr(A'*A*v, A'*A*v - lambda*v) > targetSNR
+% for the current Ritz pair (lambda,v), we assume we have found the largest
+% eigenvector and stop iterating. Higher is more accurate, but takes
+% longer. Default 50.
 %
-% v0 - initial value for c. If you can approximate the largest eigenvector
-% of A, using it for v0 will speed up the process, but leaving it out is
-% fine. Default: uniform random vector on [-1, 1].
+% v0 - initial value for v (first vector of the block). If you can
+% approximate the largest eigenvector of A, using it for v0 will speed up
+% the process, but leaving it out is fine. Default: uniform random vector
+% on [-1, 1].
 %
 % WARNING: if you want expect complex inputs, you should provide a complex
 % v0: v0 = 2*(rand(A.sizein)-.5) + 2i*(rand(A.sizein)-.5);
 %
 % verboseFlag - set to true for more output
+%
+% blockSize - number of vectors to which A'*A is applied at each step
+% (batched application). The other vectors of the initial block are random.
+% Default: max(1,numWorkers).
+%
+% numWorkers - maximum number of workers applying A'*A to the vectors of a
+% block in parallel (parfor, 0: sequential). Default: 0.
+%
+% maxBasis - number of vectors of the Krylov basis before a restart, which
+% keeps its leading half of Ritz vectors (thick restart). It bounds the
+% memory to about maxBasis+2*blockSize copies of the input of A; a larger
+% basis needs fewer applications of A'*A. Default: max(6,3*blockSize)
+% (at least 2*blockSize).
 
 % set defaults
 if nargin < 2 || isempty(maxNumApply)
@@ -35,52 +55,97 @@ end
 if nargin < 3 || isempty(targetSNR)
 	targetSNR = 50;
 end
+if nargin < 5 || isempty(verboseFlag)
+	verboseFlag = false;
+end
+if nargin < 7 || isempty(numWorkers)
+	numWorkers = 0;
+end
+if nargin < 6 || isempty(blockSize)
+	blockSize = max(1, numWorkers);
+end
+if nargin < 8 || isempty(maxBasis)
+	maxBasis = max(6, 3*blockSize);
+end
+n = prod(A.sizein);
+b = min(blockSize, n);
+s = rng;
+rng(42); % make initialization deterministic 
 if nargin < 4 || isempty(v0)
-	s = rng;
-	rng(42); % make initialization deterministic 
 	v0 = 2*(rand(A.sizein)-.5);
-	rng(s); % restore RNG state
 end
-if nargin < 5 || isempty(verboseFlag)
-	verboseFlag = false;
+X = 2*(rand(n, b)-.5);
+if ~isreal(v0)
+	X = X + 2i*(rand(n, b)-.5);
 end
+rng(s); % restore RNG state
+X = cast(X, 'like', v0);
+X(:,1) = v0(:);
 
-Av = v0;
-
-A = A' * A;
-
-
-for iter = 1:maxNumApply
-	% the old Av is the new v
-	v = Av;	
-	
-	%% normalize v
-	vNorm = sqrt(sum(abs(v(:)).^2));
-	v = v / vNorm;
+M = A' * A;
+maxCols = min(n, max(maxBasis, 2*b)); % size of the Krylov basis before a restart
 
-	% compute next power
-	Av = A*v;
+% V: basis on which T = V'*M*V is known, Q: next block (orthogonal to V),
+% C = Q'*M*V
+[Q, ~] = qr(X, 0);
+V = zeros(n, 0, 'like', Q);
+T = zeros(0, 0, 'like', Q);
+C = zeros(size(Q, 2), 0, 'like', Q);
+numApply = 0;
+while true
+	% batched application of A'*A to the current block
+	W = applyBlock(M, Q, A.sizein, numWorkers);
+	numApply = numApply + size(Q, 2);
 	
-	% check accuracy 
-	lambda = v(:)' * Av(:); % order matters if v is complex
-	curSNR = snr(Av, Av - lambda*v); 
+	% Rayleigh-Ritz on [V Q] with full reorthogonalization of the residual
+	Va = [V, Q];
+	H = Va' * W;
+	k = size(V, 2); q = size(Q, 2);
+	Aq = H(k+1:end, :);
+	T = [T, C'; C, (Aq + Aq')/2];
+	W = W - Va*H;
+	W = W - Va*(Va'*W);
+	[Q, B] = qr(W, 0);
+	[S, D] = eig(gather((T + T')/2));
+	[theta, idx] = sort(real(diag(D)), 'descend');
+	S = S(:, idx);
+	res = norm(B * S(end-q+1:end, 1));
+	curSNR = 20*log10(abs(theta(1))/res);
 	
 	if verboseFlag
 		fprintf('%g, ', curSNR);
 	end
-	if curSNR >= targetSNR
+	if curSNR >= targetSNR || numApply >= maxNumApply || size(Va, 2) >= n
 		break
 	end
-	
-
+	if size(Va, 2) + size(Q, 2) > maxCols
+		% thick restart from the leading Ritz vectors
+		p = max(b, floor(maxCols/2));
+		V = Va * S(:, 1:p);
+		T = diag(theta(1:p));
+		C = B * S(end-q+1:end, 1:p);
+	else
+		V = Va;
+		C = [zeros(size(Q, 2), k, 'like', B), B];
+	end
 end
 
-if iter == maxNumApply
-	warning('I did not find an eigenvector at the %g dB level after %d iterations', targetSNR, maxNumApply);
+if curSNR < targetSNR && size(Va, 2) < n
+	warning('I did not find an eigenvector at the %g dB level after %d iterations', targetSNR, numApply);
 end
 
+v = reshape(Va * S(:, 1), A.sizein);
+v = v / sqrt(sum(abs(v(:)).^2));
+normA = sqrt(abs(theta(1)));
 
-normA = sqrt(abs(lambda));
 
+end
 
+function W = applyBlock(M, Q, sz, numWorkers)
+% Applies M to each column of Q (in parallel with numWorkers workers)
+W = cell(1, size(Q, 2));
+parfor (k = 1:size(Q, 2), numWorkers)
+	W{k} = reshape(M * reshape(Q(:, k), sz), [], 1);
+end
+W = [W{:}];
 end
@@ -0,0 +1,41 @@
+function out = isMexCompatible(varargin)
+%% ISMEXCOMPATIBLE function
+% Determine whether the inputs can be processed by the mex kernels of the
+% library, i.e. they are all real, dense, double or single arrays of the
+% same class stored on the CPU. If the last argument is the keyword
+% 'complex', complex inputs are also accepted.
+%
+% Example: if isMexCompatible(x,y), z=myKernel(x,y); else ... end
+%
+% Example: if isMexCompatible(x,'complex'), z=myKernel(x); else ... end
+%
+% See also useGPU, zeros_
+
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+global isGPU
+
+allowComplex = nargin>0 && ischar(varargin{end}) && strcmp(varargin{end},'complex');
+if allowComplex
+    varargin=varargin(1:end-1);
+end
+out = isempty(isGPU) || isGPU==0;
+for n=1:length(varargin)
+    if ~out, return; end
+    x=varargin{n};
+    out = (isa(x,'double') || isa(x,'single')) && (allowComplex || isreal(x)) && ~issparse(x) ...
+        && strcmp(class(x),class(varargin{1}));
+end
+end
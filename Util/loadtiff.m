@@ -1,4 +1,18 @@
-function oimg = loadtiff(path)
+function oimg = loadtiff(path, frames, rows, cols)
+% oimg = loadtiff(path) loads all the frames of the tiff file path.
+% oimg = loadtiff(path, frames, rows, cols) loads only the frames listed in
+% frames, and the rows [first last] and the columns [first last] of them
+% (empty: all), e.g. a slice range or a sub-volume of a large stack.
+%
+% When the mex file tiffStack is compiled (see buildTiff), stacks of
+% uncompressed, PackBits or LZW pages of the same size are read by
+% mapping the file in memory and decoding the pages in parallel, only
+% the requested frames and strips being read from the file. Otherwise
+% (or if tiffStack rejects the file) the Tiff class reads only the
+% requested frames of a stack of pages of the same size. Files whose pages
+% have different sizes are loaded in a cell (one per size), without
+% selection of frames, rows or columns.
+%
 % Copyright (c) 2012, YoonOh Tak
 % All rights reserved.
 % 
@@ -28,6 +42,29 @@ function oimg = loadtiff(path)
 % POSSIBILITY OF SUCH DAMAGE.
 
 tStart = tic;
+if nargin < 2, frames = []; end
+if nargin < 3, rows = []; end
+if nargin < 4, cols = []; end
+
+%% Native reader
+if exist('tiffStack')==3
+    try
+        tinfo = tiffStack('info', path);
+    catch
+        tinfo = struct('uniform', false, 'supported', false); % rejected file: Tiff class below
+    end
+    if tinfo.uniform && tinfo.supported
+        oimg = tiffStack('read', path, double(frames), double(rows), double(cols));
+        if any(tinfo.spp == [2 6 8]) % complex numbers
+            oimg = oimg(:,:,1:2:end-1,:) + oimg(:,:,2:2:end,:)*1i;
+        end
+        if tinfo.spp <= 2 % grayscale image: [height, width, frame]
+            oimg = reshape(oimg, size(oimg,1), size(oimg,2), size(oimg,4));
+        end
+        return;
+    end
+end
+
 warn_old = warning('off', 'all'); % To ignore unknown TIFF tag.
 
 %% Change directory
@@ -91,20 +128,30 @@ while true
 end
 
 %% Load image data
-if tcl == 1 % simple image (no cell)
-    for tfl = 1:tfl
-        tiff.setDirectory(tfl);
+if tcl == 1 % simple image (no cell): requested frames, rows and columns only
+    if isempty(frames), frames = 1:tfl; end
+    if isempty(rows), rows = [1 iinfo(1).h]; end
+    if isempty(cols), cols = [1 iinfo(1).w]; end
+    for k = 1:numel(frames)
+        tiff.setDirectory(frames(k));
         temp = tiff.read();
-        if iinfo(tfl).complex
+        temp = temp(rows(1):rows(2), cols(1):cols(2), :);
+        if iinfo(1).complex
             temp = temp(:,:,1:2:end-1,:) + temp(:,:,2:2:end,:)*1i;
         end
-        if ~iinfo(tfl).color
-            oimg(:,:,iinfo(tfl).fid) = temp; % Grayscale image
+        if ~iinfo(1).color
+            oimg(:,:,k) = temp; % Grayscale image
         else
-            oimg(:,:,:,iinfo(tfl).fid) = temp; % Color image
+            oimg(:,:,:,k) = temp; % Color image
         end
     end
 else % multiple image (multiple cell)
+    if ~isempty(frames) || ~isempty(rows) || ~isempty(cols)
+        tiff.close();
+        cd(path_parent);
+        warning(warn_old);
+        error(['The pages of ''' path ''' have different sizes: frames, rows and cols are not supported.']);
+    end
     oimg = cell(tcl, 1);
     for tfl = 1:tfl
         tiff.setDirectory(tfl);
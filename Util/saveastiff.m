@@ -32,6 +32,10 @@ function res = saveastiff(data, path, options)
 %     options.overwrite = false;
 %     options.big       = false;
 % 
+% When the mex file tiffStack is compiled (see buildTiff), uncompressed
+% files are written by mapping the file in memory and filling the pages
+% in parallel.
+%
 % res : Return value. It is 0 when the function is finished with no error.
 %       If an error is occured in the function, it will have a positive
 %       number (error code).
@@ -217,56 +221,63 @@ if ~isempty(pathstr)
 end
 
 %% Write image data to a file
-file_opening_error_count = 0;
-while ~exist('tfile', 'var')
-    try
-        if ~options.append % Make a new file
-            s=whos('data');
-            if s.bytes > 2^32-1 || options.big
-                tfile = Tiff([fname, fext], 'w8'); % Big Tiff file
-            else
-                tfile = Tiff([fname, fext], 'w');
-            end
-        else
-            if ~exist([fname, fext], 'file') % Make a new file
+if strcmpi(options.compress, 'no') && (~options.append || ~exist([fname, fext], 'file')) && exist('tiffStack')==3
+    % Native writer
+    s=whos('data');
+    if isfield(tagstruct, 'ExtraSamples'), extra = double(tagstruct.ExtraSamples); else, extra = []; end
+    tiffStack('write', [fname, fext], data, s.bytes > 2^32-1 || options.big, extra);
+else
+    file_opening_error_count = 0;
+    while ~exist('tfile', 'var')
+        try
+            if ~options.append % Make a new file
                 s=whos('data');
                 if s.bytes > 2^32-1 || options.big
                     tfile = Tiff([fname, fext], 'w8'); % Big Tiff file
                 else
                     tfile = Tiff([fname, fext], 'w');
                 end
-            else % Append to an existing file
-                tfile = Tiff([fname, fext], 'r+');
-                while ~tfile.lastDirectory(); % Append a new image to the last directory of an exiting file
-                    tfile.nextDirectory();
+            else
+                if ~exist([fname, fext], 'file') % Make a new file
+                    s=whos('data');
+                    if s.bytes > 2^32-1 || options.big
+                        tfile = Tiff([fname, fext], 'w8'); % Big Tiff file
+                    else
+                        tfile = Tiff([fname, fext], 'w');
+                    end
+                else % Append to an existing file
+                    tfile = Tiff([fname, fext], 'r+');
+                    while ~tfile.lastDirectory(); % Append a new image to the last directory of an exiting file
+                        tfile.nextDirectory();
+                    end
+                    tfile.writeDirectory();
                 end
-                tfile.writeDirectory();
             end
-        end
-    catch
-        file_opening_error_count = file_opening_error_count + 1;
-        pause(0.1);
-        if file_opening_error_count > 5 % automatically retry to open for 5 times.
-            reply = input('Failed to open the file. Do you wish to retry? Y/n: ', 's');
-            if isempty(reply) || any(upper(reply) == 'Y')
-                file_opening_error_count = 0;
-            else
-                errcode = 7;
-                assert(false);
+        catch
+            file_opening_error_count = file_opening_error_count + 1;
+            pause(0.1);
+            if file_opening_error_count > 5 % automatically retry to open for 5 times.
+                reply = input('Failed to open the file. Do you wish to retry? Y/n: ', 's');
+                if isempty(reply) || any(upper(reply) == 'Y')
+                    file_opening_error_count = 0;
+                else
+                    errcode = 7;
+                    assert(false);
+                end
             end
         end
     end
-end
 
-for d = 1:depth
-    tfile.setTag(tagstruct);
-    tfile.write(data(:, :, :, d));
-    if d ~= depth
-       tfile.writeDirectory();
+    for d = 1:depth
+        tfile.setTag(tagstruct);
+        tfile.write(data(:, :, :, d));
+        if d ~= depth
+           tfile.writeDirectory();
+        end
     end
-end
 
-tfile.close();
+    tfile.close();
+end
 if exist('path_parent', 'var'), cd(path_parent); end
 
 tElapsed = toc(tStart);
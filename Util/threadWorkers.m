@@ -0,0 +1,40 @@
+function nw = threadWorkers(numWorkers)
+%--------------------------------------------------------------
+% function nw = threadWorkers(numWorkers)
+%
+% Number of workers to give to the parfor loops over Maps (the numWorkers
+% property of OptiADMM, OptiPrimalDualCondat, StackLinOp and OneToMany):
+% numWorkers if the current parallel pool is thread-based
+% (parpool('threads')), 0 otherwise, i.e. the loop runs on the client.
+%
+% The Maps are handle objects: on a process-based pool they would be
+% serialized to the workers at every call, and the memoize and
+% precomputation caches updated on the workers would be lost, which is
+% usually slower than the sequential loop.
+%
+% See also: OptiADMM, StackLinOp
+%
+%     Copyright (C) 2026 GlobalBioIm developers
+%
+%     This program is free software: you can redistribute it and/or modify
+%     it under the terms of the GNU General Public License as published by
+%     the Free Software Foundation, either version 3 of the License, or
+%     (at your option) any later version.
+%
+%     This program is distributed in the hope that it will be useful,
+%     but WITHOUT ANY WARRANTY; without even the implied warranty of
+%     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+%     GNU General Public License for more details.
+%
+%     You should have received a copy of the GNU General Public License
+%     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+%--------------------------------------------------------------
+
+nw = 0;
+if numWorkers > 0 && exist('gcp') == 2
+    pool = gcp('nocreate');
+    if isa(pool, 'parallel.ThreadPool')
+        nw = numWorkers;
+    end
+end
+end